@@ -0,0 +1,106 @@
+#include <iostream>
+#include <vector>
+#include <base/Time.hpp>
+#include <controllers/CartesianForcePIDController.hpp>
+#include <controllers/JointTorquePIDController.hpp>
+#include <controllers/PIDControllerBank.hpp>
+
+using namespace std;
+using namespace ctrl_lib;
+
+double mean(const vector<double>& v){
+    double sum = 0;
+    for(auto d : v) sum += d;
+    return sum / v.size();
+}
+
+PIDCtrlParams randomParams(int n){
+    PIDCtrlParams params(n);
+    params.p_gain = base::VectorXd::Random(n).cwiseAbs();
+    params.i_gain = base::VectorXd::Random(n).cwiseAbs();
+    params.d_gain = base::VectorXd::Random(n).cwiseAbs() * 0.01;
+    params.windup.setConstant(n, 1);
+    return params;
+}
+
+void evaluateCartesianForcePID(int n_samples){
+    PIDCtrlParams params = randomParams(6);
+    CartesianForcePIDController ctrl;
+    ctrl.setPID(params);
+    ctrl.setMaxCtrlOutput(base::VectorXd::Constant(6, 1));
+    PIDControllerBank6 bank;
+    bank.setPID(params);
+    bank.setMaxCtrlOutput(base::VectorXd::Constant(6, 1));
+
+    vector<double> time_ctrl, time_bank;
+    base::samples::Wrench setpoint, feedback;
+    base::Vector6d ref, act;
+    for(int i = 0; i < n_samples; i++){
+        ref.setRandom();
+        act.setRandom();
+        setpoint.force = ref.segment(0,3);
+        setpoint.torque = ref.segment(3,3);
+        feedback.force = act.segment(0,3);
+        feedback.torque = act.segment(3,3);
+
+        base::Time start = base::Time::now();
+        ctrl.update(setpoint, feedback, 0.001);
+        time_ctrl.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        start = base::Time::now();
+        bank.update(ref, act, 0.001);
+        time_bank.push_back((double)(base::Time::now()-start).toMicroseconds());
+    }
+
+    cout << " ----------- Cartesian force PID (6 channels) -----------" << endl;
+    cout << "CartesianForcePIDController  " << mean(time_ctrl) << " us" << endl;
+    cout << "PIDControllerBank6           " << mean(time_bank) << " us" << endl;
+}
+
+void evaluateJointTorquePID(int n_joints, int n_samples){
+    vector<string> names;
+    base::samples::Joints feedback;
+    base::commands::Joints setpoint;
+    for(int i = 0; i < n_joints; i++)
+        names.push_back("joint_" + to_string(i));
+    feedback.resize(n_joints);
+    setpoint.resize(n_joints);
+    feedback.names = setpoint.names = names;
+
+    PIDCtrlParams params = randomParams(n_joints);
+    JointTorquePIDController ctrl(names);
+    ctrl.setPID(params);
+    PIDControllerBankX bank(n_joints);
+    bank.setPID(params);
+
+    vector<double> time_ctrl, time_bank;
+    base::VectorXd ref(n_joints), act(n_joints);
+    for(int i = 0; i < n_samples; i++){
+        ref.setRandom();
+        act.setRandom();
+        for(int j = 0; j < n_joints; j++){
+            setpoint[j].effort = ref(j);
+            feedback[j].effort = act(j);
+        }
+
+        base::Time start = base::Time::now();
+        ctrl.update(setpoint, feedback, 0.001);
+        time_ctrl.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        start = base::Time::now();
+        bank.update(ref, act, 0.001);
+        time_bank.push_back((double)(base::Time::now()-start).toMicroseconds());
+    }
+
+    cout << " ----------- Joint torque PID (" << n_joints << " channels) -----------" << endl;
+    cout << "JointTorquePIDController     " << mean(time_ctrl) << " us" << endl;
+    cout << "PIDControllerBankX           " << mean(time_bank) << " us" << endl;
+}
+
+int main(){
+    srand(time(NULL));
+    int n_samples = 10000;
+
+    evaluateCartesianForcePID(n_samples);
+    evaluateJointTorquePID(40, n_samples);
+}
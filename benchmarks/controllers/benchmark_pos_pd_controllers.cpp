@@ -0,0 +1,63 @@
+#include <iostream>
+#include <vector>
+#include <base/Time.hpp>
+#include <controllers/CartesianPosPDController.hpp>
+
+using namespace std;
+using namespace ctrl_lib;
+
+// Offline evaluation of a recorded Cartesian trajectory: Update per sample vs. rollout of the whole trajectory
+void evaluateCartesianRollout(int n_samples, int n_gain_sets){
+    PosPDTrajectory traj;
+    traj.ref_pos.resize(7, n_samples);
+    traj.pos.resize(7, n_samples);
+    traj.ref_vel = base::MatrixXd::Random(6, n_samples);
+    traj.vel = base::MatrixXd::Random(6, n_samples);
+    traj.ref_acc = base::MatrixXd::Random(6, n_samples);
+    vector<base::samples::RigidBodyStateSE3> setpoints(n_samples), feedbacks(n_samples);
+    for(int j = 0; j < n_samples; j++){
+        setpoints[j].pose.position = traj.ref_pos.col(j).head<3>() = base::Vector3d::Random();
+        feedbacks[j].pose.position = traj.pos.col(j).head<3>() = base::Vector3d::Random();
+        setpoints[j].pose.orientation = Eigen::Quaterniond(Eigen::Vector4d::Random()).normalized();
+        feedbacks[j].pose.orientation = Eigen::Quaterniond(Eigen::Vector4d::Random()).normalized();
+        traj.ref_pos.col(j).tail<4>() = setpoints[j].pose.orientation.coeffs();
+        traj.pos.col(j).tail<4>() = feedbacks[j].pose.orientation.coeffs();
+        setpoints[j].twist.linear = traj.ref_vel.col(j).head<3>();
+        setpoints[j].twist.angular = traj.ref_vel.col(j).tail<3>();
+        feedbacks[j].twist.linear = traj.vel.col(j).head<3>();
+        feedbacks[j].twist.angular = traj.vel.col(j).tail<3>();
+        setpoints[j].acceleration.linear = traj.ref_acc.col(j).head<3>();
+        setpoints[j].acceleration.angular = traj.ref_acc.col(j).tail<3>();
+    }
+    base::MatrixXd p_gains = base::MatrixXd::Random(6, n_gain_sets).cwiseAbs();
+    base::MatrixXd d_gains = base::MatrixXd::Random(6, n_gain_sets).cwiseAbs();
+    base::MatrixXd ff_gains = base::MatrixXd::Random(6, n_gain_sets).cwiseAbs();
+
+    CartesianPosPDController ctrl;
+    base::Time start = base::Time::now();
+    for(int g = 0; g < n_gain_sets; g++){
+        ctrl.setPGain(p_gains.col(g));
+        ctrl.setDGain(d_gains.col(g));
+        ctrl.setFFGain(ff_gains.col(g));
+        for(int j = 0; j < n_samples; j++)
+            ctrl.update(setpoints[j], feedbacks[j]);
+    }
+    double time_update = (double)(base::Time::now()-start).toMicroseconds();
+
+    vector<base::MatrixXd> out_vel, out_acc;
+    start = base::Time::now();
+    ctrl.rollout(traj, p_gains, d_gains, ff_gains, out_vel, out_acc);
+    double time_rollout = (double)(base::Time::now()-start).toMicroseconds();
+
+    cout << " ----------- " << n_samples << " samples, " << n_gain_sets << " gain sets -----------" << endl;
+    cout << "Update per sample   " << time_update << " us" << endl;
+    cout << "Rollout             " << time_rollout << " us" << endl;
+}
+
+int main(){
+    srand(time(NULL));
+
+    evaluateCartesianRollout(10000, 1);
+    evaluateCartesianRollout(10000, 10);
+    evaluateCartesianRollout(100000, 10);
+}
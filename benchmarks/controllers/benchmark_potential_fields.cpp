@@ -0,0 +1,141 @@
+#include <iostream>
+#include <vector>
+#include <base/Time.hpp>
+#include <controllers/CartesianPotentialFieldsController.hpp>
+#include <controllers/RadialPotentialField.hpp>
+#include <controllers/JointLimitAvoidanceController.hpp>
+
+using namespace std;
+using namespace ctrl_lib;
+
+double mean(const vector<double>& v){
+    double sum = 0;
+    for(auto d : v) sum += d;
+    return sum / v.size();
+}
+
+// Obstacle point cloud: Radial fields with random centers in a cube with the given edge length
+vector<PotentialFieldPtr> randomFields(int n_fields, double edge_length, double influence_distance){
+    vector<PotentialFieldPtr> fields;
+    for(int i = 0; i < n_fields; i++){
+        PotentialFieldPtr field = make_shared<RadialPotentialField>(3, "field_" + to_string(i));
+        field->influence_distance = influence_distance;
+        field->pot_field_center = base::Vector3d::Random() * edge_length / 2;
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+void evaluatePotentialFields(int n_fields, double edge_length, double influence_distance, int n_moving, int n_samples){
+    vector<PotentialFieldPtr> fields = randomFields(n_fields, edge_length, influence_distance);
+    CartesianPotentialFieldsController ctrl, ctrl_indexed;
+    ctrl.setPGain(base::Vector3d(1,1,1));
+    ctrl.setFields(fields);
+    ctrl_indexed.setPGain(base::Vector3d(1,1,1));
+    ctrl_indexed.setSpatialIndex(true);
+
+    base::Time start = base::Time::now();
+    ctrl_indexed.setFields(fields);
+    double time_build = (double)(base::Time::now()-start).toMicroseconds();
+
+    vector<double> time_single, time_all, time_indexed, time_move;
+    base::samples::RigidBodyStateSE3 feedback;
+    feedback.pose.position.setZero();
+    for(int i = 0; i < n_samples; i++){
+        feedback.pose.position += base::Vector3d::Random() * 0.01;
+
+        // Reference: Call update() of each field
+        start = base::Time::now();
+        base::Vector3d gradient;
+        gradient.setZero();
+        for(const PotentialFieldPtr& f : fields)
+            gradient += f->update(feedback.pose.position);
+        time_single.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        start = base::Time::now();
+        ctrl.update(feedback);
+        time_all.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        start = base::Time::now();
+        ctrl_indexed.update(feedback);
+        time_indexed.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        // Some fields move, e.g., due to a dynamic obstacle
+        start = base::Time::now();
+        for(int j = 0; j < n_moving; j++){
+            int idx = rand() % n_fields;
+            fields[idx]->pot_field_center += base::Vector3d::Random() * 0.01;
+            ctrl_indexed.updateField(idx);
+        }
+        time_move.push_back((double)(base::Time::now()-start).toMicroseconds());
+    }
+
+    cout << " ----------- " << n_fields << " fields, influence distance " << influence_distance << ", " << n_moving << " moving fields per cycle -----------" << endl;
+    cout << "Build spatial index          " << time_build << " us" << endl;
+    cout << "Update, field by field       " << mean(time_single) << " us" << endl;
+    cout << "Update, all fields           " << mean(time_all) << " us" << endl;
+    cout << "Update, spatial index        " << mean(time_indexed) << " us" << endl;
+    cout << "Update index (moving fields) " << mean(time_move) << " us" << endl;
+}
+
+void evaluateJointLimitAvoidance(int n_joints, int n_samples){
+    base::JointLimits limits;
+    base::samples::Joints feedback;
+    for(int i = 0; i < n_joints; i++){
+        base::JointLimitRange range;
+        range.min.position = -1;
+        range.max.position = 1;
+        limits.names.push_back("joint_" + to_string(i));
+        limits.elements.push_back(range);
+        feedback.names.push_back("joint_" + to_string(i));
+        feedback.elements.push_back(base::JointState());
+    }
+    base::VectorXd influence_distance = base::VectorXd::Constant(n_joints, 0.2);
+    JointLimitAvoidanceController ctrl(limits, influence_distance);
+    ctrl.setPGain(base::VectorXd::Ones(n_joints));
+
+    // Reference: One 1D radial field per joint, evaluated field by field
+    vector<PotentialFieldPtr> fields;
+    for(int i = 0; i < n_joints; i++){
+        fields.push_back(make_shared<RadialPotentialField>(1, limits.names[i]));
+        fields[i]->influence_distance = influence_distance(i);
+    }
+
+    vector<double> time_single, time_ctrl;
+    for(int n = 0; n < n_samples; n++){
+        for(int i = 0; i < n_joints; i++)
+            feedback[i].position = base::Vector2d::Random()(0);
+
+        base::Time start = base::Time::now();
+        for(int i = 0; i < n_joints; i++){
+            double pos = feedback[limits.names[i]].position;
+            fields[i]->pot_field_center.setConstant(1, fabs(1 - pos) < fabs(pos + 1) ? 1 : -1);
+            base::VectorXd pos_vect(1);
+            pos_vect << pos;
+            fields[i]->update(pos_vect);
+        }
+        time_single.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        start = base::Time::now();
+        ctrl.update(feedback);
+        time_ctrl.push_back((double)(base::Time::now()-start).toMicroseconds());
+    }
+
+    cout << " ----------- Joint limit avoidance, " << n_joints << " joints -----------" << endl;
+    cout << "Update, field by field       " << mean(time_single) << " us" << endl;
+    cout << "Update, controller           " << mean(time_ctrl) << " us" << endl;
+}
+
+int main(){
+    srand(time(NULL));
+    int n_samples = 1000;
+
+    // Sparse: Only few fields close to the current position
+    evaluatePotentialFields(100, 10, 0.2, 10, n_samples);
+    evaluatePotentialFields(1000, 10, 0.2, 10, n_samples);
+    evaluatePotentialFields(10000, 10, 0.2, 100, n_samples);
+    // Dense: All fields influence the current position
+    evaluatePotentialFields(10000, 1, 2, 100, n_samples);
+
+    evaluateJointLimitAvoidance(40, n_samples);
+}
@@ -1,6 +1,7 @@
 #include <scenes/VelocityScene.hpp>
 #include <scenes/VelocitySceneQuadraticCost.hpp>
 #include <scenes/AccelerationSceneTSID.hpp>
+#include <scenes/AccelerationSceneReduced.hpp>
 #include <solvers/qpoases/QPOasesSolver.hpp>
 #include <boost/filesystem.hpp>
 #include "../benchmarks_common.hpp"
@@ -34,6 +35,16 @@ map<string,base::VectorXd> evaluateAccelerationSceneTSID(RobotModelPtr robot_mod
     return evaluateWBCSceneRandom(scene, n_samples);
 }
 
+map<string,base::VectorXd> evaluateAccelerationSceneReduced(RobotModelPtr robot_model, const std::string &root, const std::string &tip, int n_samples){
+    QPSolverPtr solver = std::make_shared<QPOASESSolver>();
+
+    ConstraintConfig cart_constraint("cart_pos_ctrl",0,root,tip,root,1);
+    WbcScenePtr scene = std::make_shared<AccelerationSceneReduced>(robot_model, solver);
+    if(!scene->configure({cart_constraint}))
+        throw std::runtime_error("Failed to configure evaluateAccelerationSceneReduced");
+    return evaluateWBCSceneRandom(scene, n_samples);
+}
+
 void runKUKAIiwaBenchmarks(int n_samples){
     cout << " ----------- Evaluating KUKA iiwa model -----------" << endl;
     RobotModelPtr robot_model_kdl = makeRobotModelKUKAIiwa("kdl");
@@ -43,12 +54,16 @@ void runKUKAIiwaBenchmarks(int n_samples){
     map<string,base::VectorXd> results_kdl_vel = evaluateVelocitySceneQuadraticCost(robot_model_kdl, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_vel = evaluateVelocitySceneQuadraticCost(robot_model_hyrodyn, root, tip, n_samples);
     map<string,base::VectorXd> results_kdl_acc = evaluateAccelerationSceneTSID(robot_model_kdl, root, tip, n_samples);
+    map<string,base::VectorXd> results_kdl_acc_red = evaluateAccelerationSceneReduced(robot_model_kdl, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_acc = evaluateAccelerationSceneTSID(robot_model_hyrodyn, root, tip, n_samples);
+    map<string,base::VectorXd> results_hyrodyn_acc_red = evaluateAccelerationSceneReduced(robot_model_hyrodyn, root, tip, n_samples);
 
     toCSV(results_kdl_vel, "results/kuka_iiwa_vel_kdl.csv");
     toCSV(results_hyrodyn_vel, "results/kuka_iiwa_vel_hyrodyn.csv");
     toCSV(results_kdl_acc, "results/kuka_iiwa_acc_kdl.csv");
+    toCSV(results_kdl_acc_red, "results/kuka_iiwa_acc_red_kdl.csv");
     toCSV(results_hyrodyn_acc, "results/kuka_iiwa_acc_hyrodyn.csv");
+    toCSV(results_hyrodyn_acc_red, "results/kuka_iiwa_acc_red_hyrodyn.csv");
 
     cout << " ----------- Results VelocitySceneQuadraticCost (RobotModelKDL) -----------" << endl;
     printResults(results_kdl_vel);
@@ -56,8 +71,12 @@ void runKUKAIiwaBenchmarks(int n_samples){
     printResults(results_hyrodyn_vel);
     cout << " ----------- Results AccelerationSceneTSID (RobotModelKDL) -----------" << endl;
     printResults(results_kdl_acc);
+    cout << " ----------- Results AccelerationSceneReduced (RobotModelKDL) -----------" << endl;
+    printResults(results_kdl_acc_red);
     cout << " ----------- Results AccelerationSceneTSID (RobotModelHyrodyn) -----------" << endl;
     printResults(results_hyrodyn_acc);
+    cout << " ----------- Results AccelerationSceneReduced (RobotModelHyrodyn) -----------" << endl;
+    printResults(results_hyrodyn_acc_red);
 }
 
 void runRH5SingleLegBenchmarks(int n_samples){
@@ -71,15 +90,21 @@ void runRH5SingleLegBenchmarks(int n_samples){
     map<string,base::VectorXd> results_hyrodyn_vel = evaluateVelocitySceneQuadraticCost(robot_model_hyrodyn, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_hybrid_vel = evaluateVelocitySceneQuadraticCost(robot_model_hyrodyn_hybrid, root, tip, n_samples);
     map<string,base::VectorXd> results_kdl_acc = evaluateAccelerationSceneTSID(robot_model_kdl, root, tip, n_samples);
+    map<string,base::VectorXd> results_kdl_acc_red = evaluateAccelerationSceneReduced(robot_model_kdl, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_acc = evaluateAccelerationSceneTSID(robot_model_hyrodyn, root, tip, n_samples);
+    map<string,base::VectorXd> results_hyrodyn_acc_red = evaluateAccelerationSceneReduced(robot_model_hyrodyn, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_hybrid_acc = evaluateAccelerationSceneTSID(robot_model_hyrodyn_hybrid, root, tip, n_samples);
+    map<string,base::VectorXd> results_hyrodyn_hybrid_acc_red = evaluateAccelerationSceneReduced(robot_model_hyrodyn_hybrid, root, tip, n_samples);
 
     toCSV(results_kdl_vel, "results/rh5_single_leg_vel_kdl.csv");
     toCSV(results_hyrodyn_vel, "results/rh5_single_leg_vel_hyrodyn.csv");
     toCSV(results_hyrodyn_hybrid_vel, "results/rh5_single_leg_vel_hyrodyn_hybrid.csv");
     toCSV(results_kdl_acc, "results/rh5_single_leg_acc_kdl.csv");
+    toCSV(results_kdl_acc_red, "results/rh5_single_leg_acc_red_kdl.csv");
     toCSV(results_hyrodyn_acc, "results/rh5_single_leg_acc_hyrodyn.csv");
+    toCSV(results_hyrodyn_acc_red, "results/rh5_single_leg_acc_red_hyrodyn.csv");
     toCSV(results_hyrodyn_hybrid_acc, "results/rh5_single_leg_acc_hyrodyn_hybrid.csv");
+    toCSV(results_hyrodyn_hybrid_acc_red, "results/rh5_single_leg_acc_red_hyrodyn_hybrid.csv");
 
     cout << " ----------- Results VelocitySceneQuadraticCost (RobotModelKDL) -----------" << endl;
     printResults(results_kdl_vel);
@@ -89,10 +114,16 @@ void runRH5SingleLegBenchmarks(int n_samples){
     printResults(results_hyrodyn_hybrid_vel);
     cout << " ----------- Results AccelerationSceneTSID (RobotModelKDL) -----------" << endl;
     printResults(results_kdl_acc);
+    cout << " ----------- Results AccelerationSceneReduced (RobotModelKDL) -----------" << endl;
+    printResults(results_kdl_acc_red);
     cout << " ----------- Results AccelerationSceneTSID (RobotModelHyrodyn) -----------" << endl;
     printResults(results_hyrodyn_acc);
+    cout << " ----------- Results AccelerationSceneReduced (RobotModelHyrodyn) -----------" << endl;
+    printResults(results_hyrodyn_acc_red);
     cout << " ----------- Results AccelerationSceneTSID Hybrid (RobotModelHyrodyn Hybrid) -----------" << endl;
     printResults(results_hyrodyn_hybrid_acc);
+    cout << " ----------- Results AccelerationSceneReduced Hybrid (RobotModelHyrodyn Hybrid) -----------" << endl;
+    printResults(results_hyrodyn_hybrid_acc_red);
 }
 
 void runRH5LegsBenchmarks(int n_samples){
@@ -106,15 +137,21 @@ void runRH5LegsBenchmarks(int n_samples){
     map<string,base::VectorXd> results_hyrodyn_vel = evaluateVelocitySceneQuadraticCost(robot_model_hyrodyn, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_hybrid_vel = evaluateVelocitySceneQuadraticCost(robot_model_hyrodyn_hybrid, root, tip, n_samples);
     map<string,base::VectorXd> results_kdl_acc = evaluateAccelerationSceneTSID(robot_model_kdl, root, tip, n_samples);
+    map<string,base::VectorXd> results_kdl_acc_red = evaluateAccelerationSceneReduced(robot_model_kdl, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_acc = evaluateAccelerationSceneTSID(robot_model_hyrodyn, root, tip, n_samples);
+    map<string,base::VectorXd> results_hyrodyn_acc_red = evaluateAccelerationSceneReduced(robot_model_hyrodyn, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_hybrid_acc = evaluateAccelerationSceneTSID(robot_model_hyrodyn_hybrid, root, tip, n_samples);
+    map<string,base::VectorXd> results_hyrodyn_hybrid_acc_red = evaluateAccelerationSceneReduced(robot_model_hyrodyn_hybrid, root, tip, n_samples);
 
     toCSV(results_kdl_vel, "results/rh5_legs_vel_kdl.csv");
     toCSV(results_hyrodyn_vel, "results/rh5_legs_vel_hyrodyn.csv");
     toCSV(results_hyrodyn_hybrid_vel, "results/rh5_legs_vel_hyrodyn_hybrid.csv");
     toCSV(results_kdl_acc, "results/rh5_legs_acc_kdl.csv");
+    toCSV(results_kdl_acc_red, "results/rh5_legs_acc_red_kdl.csv");
     toCSV(results_hyrodyn_acc, "results/rh5_legs_acc_hyrodyn.csv");
+    toCSV(results_hyrodyn_acc_red, "results/rh5_legs_acc_red_hyrodyn.csv");
     toCSV(results_hyrodyn_hybrid_acc, "results/rh5_legs_acc_hyrodyn_hybrid.csv");
+    toCSV(results_hyrodyn_hybrid_acc_red, "results/rh5_legs_acc_red_hyrodyn_hybrid.csv");
 
     cout << " ----------- Results VelocitySceneQuadraticCost (RobotModelKDL) -----------" << endl;
     printResults(results_kdl_vel);
@@ -124,10 +161,16 @@ void runRH5LegsBenchmarks(int n_samples){
     printResults(results_hyrodyn_hybrid_vel);
     cout << " ----------- Results AccelerationSceneTSID (RobotModelKDL) -----------" << endl;
     printResults(results_kdl_acc);
+    cout << " ----------- Results AccelerationSceneReduced (RobotModelKDL) -----------" << endl;
+    printResults(results_kdl_acc_red);
     cout << " ----------- Results AccelerationSceneTSID (RobotModelHyrodyn) -----------" << endl;
     printResults(results_hyrodyn_acc);
+    cout << " ----------- Results AccelerationSceneReduced (RobotModelHyrodyn) -----------" << endl;
+    printResults(results_hyrodyn_acc_red);
     cout << " ----------- Results AccelerationSceneTSID Hybrid (RobotModelHyrodyn Hybrid) -----------" << endl;
     printResults(results_hyrodyn_hybrid_acc);
+    cout << " ----------- Results AccelerationSceneReduced Hybrid (RobotModelHyrodyn Hybrid) -----------" << endl;
+    printResults(results_hyrodyn_hybrid_acc_red);
 }
 
 void runRH5Benchmarks(int n_samples){
@@ -141,15 +184,21 @@ void runRH5Benchmarks(int n_samples){
     map<string,base::VectorXd> results_hyrodyn_vel = evaluateVelocitySceneQuadraticCost(robot_model_hyrodyn, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_hybrid_vel = evaluateVelocitySceneQuadraticCost(robot_model_hyrodyn_hybrid, root, tip, n_samples);
     map<string,base::VectorXd> results_kdl_acc = evaluateAccelerationSceneTSID(robot_model_kdl, root, tip, n_samples);
+    map<string,base::VectorXd> results_kdl_acc_red = evaluateAccelerationSceneReduced(robot_model_kdl, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_acc = evaluateAccelerationSceneTSID(robot_model_hyrodyn, root, tip, n_samples);
+    map<string,base::VectorXd> results_hyrodyn_acc_red = evaluateAccelerationSceneReduced(robot_model_hyrodyn, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_hybrid_acc = evaluateAccelerationSceneTSID(robot_model_hyrodyn_hybrid, root, tip, n_samples);
+    map<string,base::VectorXd> results_hyrodyn_hybrid_acc_red = evaluateAccelerationSceneReduced(robot_model_hyrodyn_hybrid, root, tip, n_samples);
 
     toCSV(results_kdl_vel, "results/rh5_vel_kdl.csv");
     toCSV(results_hyrodyn_vel, "results/rh5_vel_hyrodyn.csv");
     toCSV(results_hyrodyn_hybrid_vel, "results/rh5_vel_hyrodyn_hybrid.csv");
     toCSV(results_kdl_acc, "results/rh5_acc_kdl.csv");
+    toCSV(results_kdl_acc_red, "results/rh5_acc_red_kdl.csv");
     toCSV(results_hyrodyn_acc, "results/rh5_acc_hyrodyn.csv");
+    toCSV(results_hyrodyn_acc_red, "results/rh5_acc_red_hyrodyn.csv");
     toCSV(results_hyrodyn_hybrid_acc, "results/rh5_acc_hyrodyn_hybrid.csv");
+    toCSV(results_hyrodyn_hybrid_acc_red, "results/rh5_acc_red_hyrodyn_hybrid.csv");
 
     cout << " ----------- Results VelocitySceneQuadraticCost (RobotModelKDL) -----------" << endl;
     printResults(results_kdl_vel);
@@ -159,10 +208,16 @@ void runRH5Benchmarks(int n_samples){
     printResults(results_hyrodyn_hybrid_vel);
     cout << " ----------- Results AccelerationSceneTSID (RobotModelKDL) -----------" << endl;
     printResults(results_kdl_acc);
+    cout << " ----------- Results AccelerationSceneReduced (RobotModelKDL) -----------" << endl;
+    printResults(results_kdl_acc_red);
     cout << " ----------- Results AccelerationSceneTSID (RobotModelHyrodyn) -----------" << endl;
     printResults(results_hyrodyn_acc);
+    cout << " ----------- Results AccelerationSceneReduced (RobotModelHyrodyn) -----------" << endl;
+    printResults(results_hyrodyn_acc_red);
     cout << " ----------- Results AccelerationSceneTSID Hybrid (RobotModelHyrodyn Hybrid) -----------" << endl;
     printResults(results_hyrodyn_hybrid_acc);
+    cout << " ----------- Results AccelerationSceneReduced Hybrid (RobotModelHyrodyn Hybrid) -----------" << endl;
+    printResults(results_hyrodyn_hybrid_acc_red);
 }
 
 void runRH5v2Benchmarks(int n_samples){
@@ -176,15 +231,21 @@ void runRH5v2Benchmarks(int n_samples){
     map<string,base::VectorXd> results_hyrodyn_vel = evaluateVelocitySceneQuadraticCost(robot_model_hyrodyn, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_hybrid_vel = evaluateVelocitySceneQuadraticCost(robot_model_hyrodyn_hybrid, root, tip, n_samples);
     map<string,base::VectorXd> results_kdl_acc = evaluateAccelerationSceneTSID(robot_model_kdl, root, tip, n_samples);
+    map<string,base::VectorXd> results_kdl_acc_red = evaluateAccelerationSceneReduced(robot_model_kdl, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_acc = evaluateAccelerationSceneTSID(robot_model_hyrodyn, root, tip, n_samples);
+    map<string,base::VectorXd> results_hyrodyn_acc_red = evaluateAccelerationSceneReduced(robot_model_hyrodyn, root, tip, n_samples);
     map<string,base::VectorXd> results_hyrodyn_hybrid_acc = evaluateAccelerationSceneTSID(robot_model_hyrodyn_hybrid, root, tip, n_samples);
+    map<string,base::VectorXd> results_hyrodyn_hybrid_acc_red = evaluateAccelerationSceneReduced(robot_model_hyrodyn_hybrid, root, tip, n_samples);
 
     toCSV(results_kdl_vel, "results/rh5v2_vel_kdl.csv");
     toCSV(results_hyrodyn_vel, "results/rh5v2_vel_hyrodyn.csv");
     toCSV(results_hyrodyn_hybrid_vel, "results/rh5v2_vel_hyrodyn_hybrid.csv");
     toCSV(results_kdl_acc, "results/rh5v2_acc_kdl.csv");
+    toCSV(results_kdl_acc_red, "results/rh5v2_acc_red_kdl.csv");
     toCSV(results_hyrodyn_acc, "results/rh5v2_acc_hyrodyn.csv");
+    toCSV(results_hyrodyn_acc_red, "results/rh5v2_acc_red_hyrodyn.csv");
     toCSV(results_hyrodyn_hybrid_acc, "results/rh5v2_acc_hyrodyn_hybrid.csv");
+    toCSV(results_hyrodyn_hybrid_acc_red, "results/rh5v2_acc_red_hyrodyn_hybrid.csv");
 
     cout << " ----------- Results VelocitySceneQuadraticCost (RobotModelKDL) -----------" << endl;
     printResults(results_kdl_vel);
@@ -194,10 +255,16 @@ void runRH5v2Benchmarks(int n_samples){
     printResults(results_hyrodyn_hybrid_vel);
     cout << " ----------- Results AccelerationSceneTSID (RobotModelKDL) -----------" << endl;
     printResults(results_kdl_acc);
+    cout << " ----------- Results AccelerationSceneReduced (RobotModelKDL) -----------" << endl;
+    printResults(results_kdl_acc_red);
     cout << " ----------- Results AccelerationSceneTSID (RobotModelHyrodyn) -----------" << endl;
     printResults(results_hyrodyn_acc);
+    cout << " ----------- Results AccelerationSceneReduced (RobotModelHyrodyn) -----------" << endl;
+    printResults(results_hyrodyn_acc_red);
     cout << " ----------- Results AccelerationSceneTSID Hybrid (RobotModelHyrodyn Hybrid) -----------" << endl;
     printResults(results_hyrodyn_hybrid_acc);
+    cout << " ----------- Results AccelerationSceneReduced Hybrid (RobotModelHyrodyn Hybrid) -----------" << endl;
+    printResults(results_hyrodyn_hybrid_acc_red);
 }
 
 void runBenchmarks(int n_samples){
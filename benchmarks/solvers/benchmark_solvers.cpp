@@ -6,6 +6,9 @@
 #include <solvers/qpoases/QPOasesSolver.hpp>
 #include <solvers/qpswift/QPSwiftSolver.hpp>
 #include <solvers/eiquadprog/EiquadprogSolver.hpp>
+#include <solvers/hls/HierarchicalLSSolver.hpp>
+#include <solvers/admm/ADMMSolver.hpp>
+#include <core/QuadraticProgram.hpp>
 #include "../benchmarks_common.hpp"
 #include "../robot_models_common.hpp"
 
@@ -50,6 +53,63 @@ map<string, base::VectorXd> evaluateEiquadprog(RobotModelPtr robot_model, string
     return evaluateWBCSceneRandom(scene, n_samples);
 }
 
+map<string, base::VectorXd> evaluateADMM(RobotModelPtr robot_model, string root, string tip, int n_samples){
+    QPSolverPtr solver = std::make_shared<ADMMSolver>();
+
+    ConstraintConfig cart_constraint("cart_pos_ctrl",0,root,tip,root,1);
+    WbcScenePtr scene = std::make_shared<AccelerationSceneTSID>(robot_model, solver);
+    if(!scene->configure({cart_constraint}))
+        throw std::runtime_error("Failed to configure evaluateAccelerationSceneTSID");
+
+    return evaluateWBCSceneRandom(scene, n_samples);
+}
+
+map<string, base::VectorXd> evaluateHLS(HLSDecomposition decomposition, uint n_joints, const vector<int>& ny_per_prio, int n_samples){
+    HierarchicalLSSolver solver;
+    solver.configure(ny_per_prio, n_joints);
+    solver.setDecomposition(decomposition);
+
+    base::VectorXd time_solve(n_samples);
+    base::VectorXd solver_output;
+    for(int i = 0; i < n_samples; i++){
+        HierarchicalQP hqp;
+        hqp.Wq.setOnes(n_joints);
+        for(auto ny : ny_per_prio){
+            QuadraticProgram qp;
+            qp.resize(ny, n_joints);
+            qp.A.setRandom();
+            qp.lower_y.setRandom();
+            qp.upper_y = qp.lower_y;
+            qp.Wy.setOnes();
+            qp.lower_x.resize(0);
+            qp.upper_x.resize(0);
+            hqp << qp;
+        }
+
+        base::Time start = base::Time::now();
+        solver.solve(hqp, solver_output);
+        time_solve[i] = (double)(base::Time::now()-start).toMicroseconds()/1000;
+    }
+
+    map<string, base::VectorXd> results;
+    results["solve"] = time_solve;
+    return results;
+}
+
+void runHLSBenchmarks(int n_samples){
+    cout << " ----------- Evaluating HierarchicalLSSolver (40 joints, 3 priorities) -----------" << endl;
+    vector<int> ny_per_prio = {6, 6, 12};
+
+    map<string,base::VectorXd> results_svd = evaluateHLS(hls_svd, 40, ny_per_prio, n_samples);
+    map<string,base::VectorXd> results_cod = evaluateHLS(hls_cod, 40, ny_per_prio, n_samples);
+
+    toCSV(results_svd, "results/hls_svd.csv");
+    toCSV(results_cod, "results/hls_cod.csv");
+
+    cout << "Solve (hls_svd)  " << results_svd["solve"].mean() << " ms +/- " << stdDev(results_svd["solve"]) << endl;
+    cout << "Solve (hls_cod)  " << results_cod["solve"].mean() << " ms +/- " << stdDev(results_cod["solve"]) << endl;
+}
+
 void runKUKAIiwaBenchmarks(int n_samples){
     cout << " ----------- Evaluating KUKA iiwa model -----------" << endl;
     RobotModelPtr robot_model = makeRobotModelKUKAIiwa("hyrodyn");
@@ -57,10 +117,12 @@ void runKUKAIiwaBenchmarks(int n_samples){
     map<string,base::VectorXd> results_qp_oases   = evaluateQPOases(robot_model, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", n_samples);
     map<string,base::VectorXd> results_qp_swift   = evaluateQPSwift(robot_model, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", n_samples);
     map<string,base::VectorXd> results_eiquadprog = evaluateEiquadprog(robot_model, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", n_samples);
+    map<string,base::VectorXd> results_admm       = evaluateADMM(robot_model, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", n_samples);
 
     toCSV(results_qp_oases, "results/kuka_iiwa_qpoases.csv");
     toCSV(results_qp_swift, "results/kuka_iiwa_qpswift.csv");
     toCSV(results_eiquadprog, "results/kuka_iiwa_eiquadprog.csv");
+    toCSV(results_admm, "results/kuka_iiwa_admm.csv");
 
     cout << " ----------- Results AccelerationSceneTSID (QPOases) -----------" << endl;
     printResults(results_qp_oases);
@@ -68,6 +130,8 @@ void runKUKAIiwaBenchmarks(int n_samples){
     printResults(results_qp_swift);
     cout << " ----------- Results AccelerationSceneTSID (Eiquadprog) -----------" << endl;
     printResults(results_eiquadprog);
+    cout << " ----------- Results AccelerationSceneTSID (ADMM) -----------" << endl;
+    printResults(results_admm);
 }
 
 void runRH5SingleLegBenchmarks(int n_samples){
@@ -77,10 +141,12 @@ void runRH5SingleLegBenchmarks(int n_samples){
     map<string,base::VectorXd> results_qp_oases = evaluateQPOases(robot_model, "RH5_Root_Link", "LLAnkle_FT", n_samples);
     map<string,base::VectorXd> results_qp_swift = evaluateQPSwift(robot_model, "RH5_Root_Link", "LLAnkle_FT", n_samples);
     map<string,base::VectorXd> results_eiquadprog = evaluateEiquadprog(robot_model, "RH5_Root_Link", "LLAnkle_FT", n_samples);
+    map<string,base::VectorXd> results_admm = evaluateADMM(robot_model, "RH5_Root_Link", "LLAnkle_FT", n_samples);
 
     toCSV(results_qp_oases, "results/rh5_single_leg_qpoases.csv");
     toCSV(results_qp_swift, "results/rh5_single_leg_qpswift.csv");
     toCSV(results_eiquadprog, "results/kuka_iiwa_eiquadprog.csv");
+    toCSV(results_admm, "results/rh5_single_leg_admm.csv");
 
     cout << " ----------- Results AccelerationSceneTSID (QPOases) -----------" << endl;
     printResults(results_qp_oases);
@@ -88,6 +154,8 @@ void runRH5SingleLegBenchmarks(int n_samples){
     printResults(results_qp_swift);
     cout << " ----------- Results AccelerationSceneTSID (Eiquadprog) -----------" << endl;
     printResults(results_eiquadprog);
+    cout << " ----------- Results AccelerationSceneTSID (ADMM) -----------" << endl;
+    printResults(results_admm);
 }
 
 void runRH5LegsBenchmarks(int n_samples){
@@ -97,10 +165,12 @@ void runRH5LegsBenchmarks(int n_samples){
     map<string,base::VectorXd> results_qp_oases = evaluateQPOases(robot_model, "world", "LLAnkle_FT", n_samples);
     map<string,base::VectorXd> results_qp_swift = evaluateQPSwift(robot_model, "world", "LLAnkle_FT", n_samples);
     map<string,base::VectorXd> results_eiquadprog = evaluateEiquadprog(robot_model, "world", "LLAnkle_FT", n_samples);
+    map<string,base::VectorXd> results_admm = evaluateADMM(robot_model, "world", "LLAnkle_FT", n_samples);
 
     toCSV(results_qp_oases, "results/rh5_legs_qpoases.csv");
     toCSV(results_qp_swift, "results/rh5_legs_qpswift.csv");
     toCSV(results_eiquadprog, "results/kuka_iiwa_eiquadprog.csv");
+    toCSV(results_admm, "results/rh5_legs_admm.csv");
 
     cout << " ----------- Results AccelerationSceneTSID (QPOases) -----------" << endl;
     printResults(results_qp_oases);
@@ -108,6 +178,8 @@ void runRH5LegsBenchmarks(int n_samples){
     printResults(results_qp_swift);
     cout << " ----------- Results AccelerationSceneTSID (Eiquadprog) -----------" << endl;
     printResults(results_eiquadprog);
+    cout << " ----------- Results AccelerationSceneTSID (ADMM) -----------" << endl;
+    printResults(results_admm);
 }
 
 void runRH5Benchmarks(int n_samples){
@@ -117,10 +189,12 @@ void runRH5Benchmarks(int n_samples){
     map<string,base::VectorXd> results_qp_oases = evaluateQPOases(robot_model, "world", "LLAnkle_FT", n_samples);
     map<string,base::VectorXd> results_qp_swift = evaluateQPSwift(robot_model, "world", "LLAnkle_FT", n_samples);
     map<string,base::VectorXd> results_eiquadprog = evaluateEiquadprog(robot_model, "world", "LLAnkle_FT", n_samples);
+    map<string,base::VectorXd> results_admm = evaluateADMM(robot_model, "world", "LLAnkle_FT", n_samples);
 
     toCSV(results_qp_oases, "results/rh5_qpoases.csv");
     toCSV(results_qp_swift, "results/rh5_qpswift.csv");
     toCSV(results_eiquadprog, "results/kuka_iiwa_eiquadprog.csv");
+    toCSV(results_admm, "results/rh5_admm.csv");
 
     cout << " ----------- Results AccelerationSceneTSID (QPOases) -----------" << endl;
     printResults(results_qp_oases);
@@ -128,6 +202,8 @@ void runRH5Benchmarks(int n_samples){
     printResults(results_qp_swift);
     cout << " ----------- Results AccelerationSceneTSID (Eiquadprog) -----------" << endl;
     printResults(results_eiquadprog);
+    cout << " ----------- Results AccelerationSceneTSID (ADMM) -----------" << endl;
+    printResults(results_admm);
 }
 
 void runRH5v2Benchmarks(int n_samples){
@@ -137,11 +213,13 @@ void runRH5v2Benchmarks(int n_samples){
     map<string,base::VectorXd> results_qp_oases = evaluateQPOases(robot_model, "RH5v2_Root_Link", "ALWristFT_Link", n_samples);
     map<string,base::VectorXd> results_qp_swift = evaluateQPSwift(robot_model, "RH5v2_Root_Link", "ALWristFT_Link", n_samples);
     map<string,base::VectorXd> results_eiquadprog = evaluateEiquadprog(robot_model, "RH5v2_Root_Link", "ALWristFT_Link", n_samples);
+    map<string,base::VectorXd> results_admm = evaluateADMM(robot_model, "RH5v2_Root_Link", "ALWristFT_Link", n_samples);
 
 
     toCSV(results_qp_oases, "results/rh5v2_qpoases.csv");
     toCSV(results_qp_swift, "results/rh5v2_qpswift.csv");
     toCSV(results_eiquadprog, "results/kuka_iiwa_eiquadprog.csv");
+    toCSV(results_admm, "results/rh5v2_admm.csv");
 
     cout << " ----------- Results AccelerationSceneTSID (QPOases) -----------" << endl;
     printResults(results_qp_oases);
@@ -149,11 +227,14 @@ void runRH5v2Benchmarks(int n_samples){
     printResults(results_qp_swift);
     cout << " ----------- Results AccelerationSceneTSID (Eiquadprog) -----------" << endl;
     printResults(results_eiquadprog);
+    cout << " ----------- Results AccelerationSceneTSID (ADMM) -----------" << endl;
+    printResults(results_admm);
 }
 
 void runBenchmarks(int n_samples){
     boost::filesystem::create_directory("results");
 
+    runHLSBenchmarks(n_samples);
     runKUKAIiwaBenchmarks(n_samples);
     runRH5SingleLegBenchmarks(n_samples);
     runRH5LegsBenchmarks(n_samples);
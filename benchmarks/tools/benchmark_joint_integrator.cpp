@@ -0,0 +1,104 @@
+#include <iostream>
+#include <vector>
+#include <base/Time.hpp>
+#include <tools/JointIntegrator.hpp>
+
+using namespace std;
+using namespace wbc;
+
+double mean(const vector<double>& v){
+    double sum = 0;
+    for(auto d : v) sum += d;
+    return sum / v.size();
+}
+
+// Joint by joint trapezoidal integration with a full copy of the previous command, for comparison
+void integrateTrapezoidalReference(base::commands::Joints& cmd, base::commands::Joints& prev_cmd, JointIntegrator& integrator, double cycle_time){
+    double h = cycle_time/2;
+    for(uint i = 0; i < cmd.size(); i++){
+        switch(integrator.cmdMode(cmd[i])){
+        case base::JointState::SPEED:
+            cmd[i].position = prev_cmd[i].position + (cmd[i].speed+prev_cmd[i].speed)*h;
+            break;
+        case base::JointState::ACCELERATION:
+            cmd[i].speed = prev_cmd[i].speed + (cmd[i].acceleration+cmd[i].acceleration)*h;
+            cmd[i].position = prev_cmd[i].position + (cmd[i].speed+prev_cmd[i].speed)*h;
+            break;
+        default:
+            throw std::runtime_error("Invalid control mode");
+        }
+    }
+    prev_cmd = cmd;
+}
+
+// Solver output with every third joint acceleration controlled and the others velocity controlled
+base::commands::Joints randomCommand(const vector<string>& names){
+    base::commands::Joints cmd;
+    cmd.resize(names.size());
+    cmd.names = names;
+    for(uint i = 0; i < names.size(); i++){
+        if(i % 3 == 0)
+            cmd[i].acceleration = (double)rand()/RAND_MAX;
+        else
+            cmd[i].speed = (double)rand()/RAND_MAX;
+    }
+    return cmd;
+}
+
+void evaluateJointIntegrator(int n_joints, int n_samples){
+    // Time per block of cycles, since a single cycle is below the resolution of the clock
+    const int n_cycles = 1000;
+    const double cycle_time = 0.001;
+
+    vector<string> names;
+    base::samples::Joints joint_state;
+    for(int i = 0; i < n_joints; i++){
+        names.push_back("joint_" + to_string(i));
+        base::JointState js;
+        js.position = js.speed = 0;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.names = names;
+    vector<base::commands::Joints> cmds;
+    for(int k = 0; k < n_cycles; k++)
+        cmds.push_back(randomCommand(names));
+
+    vector<double> time_reference, time_rectangular, time_trapezoidal;
+    vector<pair<IntegrationMethod, vector<double>*> > methods = {{RECTANGULAR, &time_rectangular}, {TRAPEZOIDAL, &time_trapezoidal}};
+    for(int i = 0; i < n_samples; i++){
+        JointIntegrator integrator;
+        base::commands::Joints cmd = cmds[0], prev_cmd;
+        integrator.integrate(joint_state, cmd, cycle_time);
+        prev_cmd = cmd;
+        base::Time start = base::Time::now();
+        for(int k = 1; k < n_cycles; k++){
+            cmd.elements = cmds[k].elements;
+            integrateTrapezoidalReference(cmd, prev_cmd, integrator, cycle_time);
+        }
+        time_reference.push_back((double)(base::Time::now()-start).toMicroseconds() / (n_cycles-1));
+
+        for(auto m : methods){
+            integrator.reinit();
+            cmd = cmds[0];
+            integrator.integrate(joint_state, cmd, cycle_time, m.first);
+            start = base::Time::now();
+            for(int k = 1; k < n_cycles; k++){
+                cmd.elements = cmds[k].elements;
+                integrator.integrate(joint_state, cmd, cycle_time, m.first);
+            }
+            m.second->push_back((double)(base::Time::now()-start).toMicroseconds() / (n_cycles-1));
+        }
+    }
+
+    cout << " ----------- " << n_joints << " joints (including copy of the command elements) -----------" << endl;
+    cout << "Joint by joint (trapezoidal) " << mean(time_reference) << " us" << endl;
+    cout << "Rectangular                  " << mean(time_rectangular) << " us" << endl;
+    cout << "Trapezoidal                  " << mean(time_trapezoidal) << " us" << endl;
+}
+
+int main(){
+    srand(time(NULL));
+    int n_samples = 100;
+    for(int n_joints : {7, 40, 100})
+        evaluateJointIntegrator(n_joints, n_samples);
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <vector>
+#include <base/Time.hpp>
+#include <base/Eigen.hpp>
+#include <tools/SE3Tools.hpp>
+
+using namespace std;
+using namespace wbc;
+
+double mean(const vector<double>& v){
+    double sum = 0;
+    for(auto d : v) sum += d;
+    return sum / v.size();
+}
+
+// Pose error via rotation matrices and angle-axis, as previously done in operator-(Pose,Pose)
+base::Vector6d poseErrorReference(const base::Vector3d& pos_a, const base::Quaterniond& rot_a, const base::Vector3d& pos_b, const base::Quaterniond& rot_b){
+    base::Matrix3d rot_mat = rot_b.toRotationMatrix().inverse() * rot_a.toRotationMatrix();
+    Eigen::AngleAxisd angle_axis;
+    angle_axis.fromRotationMatrix(rot_mat);
+    base::Vector6d err;
+    err.segment(0,3) = pos_a - pos_b;
+    err.segment(3,3) = rot_b.toRotationMatrix() * (angle_axis.axis() * angle_axis.angle());
+    return err;
+}
+
+base::MatrixXd randomPoses(int n){
+    base::MatrixXd poses(7, n);
+    for(int j = 0; j < n; j++){
+        poses.col(j).segment(0,3).setRandom();
+        poses.col(j).segment(3,4) = base::Vector4d::Random().normalized();
+    }
+    return poses;
+}
+
+void evaluatePoseError(int n_poses, int n_samples){
+    vector<double> time_reference, time_single, time_batch;
+    base::MatrixXd err(6, n_poses);
+    double max_diff = 0;
+
+    for(int i = 0; i < n_samples; i++){
+        base::MatrixXd a = randomPoses(n_poses), b = randomPoses(n_poses);
+
+        base::Time start = base::Time::now();
+        for(int j = 0; j < n_poses; j++)
+            err.col(j) = poseErrorReference(a.col(j).segment(0,3), Eigen::Map<const base::Quaterniond>(a.col(j).data()+3),
+                                            b.col(j).segment(0,3), Eigen::Map<const base::Quaterniond>(b.col(j).data()+3));
+        time_reference.push_back((double)(base::Time::now()-start).toMicroseconds());
+        base::MatrixXd err_reference = err;
+
+        start = base::Time::now();
+        for(int j = 0; j < n_poses; j++)
+            err.col(j) = poseError(a.col(j).segment(0,3), Eigen::Map<const base::Quaterniond>(a.col(j).data()+3),
+                                   b.col(j).segment(0,3), Eigen::Map<const base::Quaterniond>(b.col(j).data()+3));
+        time_single.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        start = base::Time::now();
+        poseErrors(a, b, err);
+        time_batch.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        max_diff = max(max_diff, (err - err_reference).cwiseAbs().maxCoeff());
+    }
+
+    cout << " ----------- Pose error, " << n_poses << " poses -----------" << endl;
+    cout << "Rotation matrix + angle axis   " << mean(time_reference) << " us" << endl;
+    cout << "poseError                      " << mean(time_single) << " us" << endl;
+    cout << "poseErrors (batch)             " << mean(time_batch) << " us" << endl;
+    cout << "Max. deviation                 " << max_diff << endl;
+}
+
+void evaluateFrameTransform(int n_constraints, int n_samples){
+    vector<double> time_reference, time_rotate;
+    vector<base::Quaterniond> rot(n_constraints);
+    vector<base::VectorXd> y_ref(n_constraints), weights(n_constraints), y_ref_root(n_constraints), weights_root(n_constraints);
+    for(int j = 0; j < n_constraints; j++){
+        y_ref[j] = weights[j] = y_ref_root[j] = weights_root[j] = base::VectorXd::Random(6);
+        rot[j] = base::Quaterniond(base::Vector4d::Random().normalized());
+    }
+
+    for(int i = 0; i < n_samples; i++){
+        // As previously done in the scenes: One conversion to rotation matrix per 3D vector
+        base::Time start = base::Time::now();
+        for(int j = 0; j < n_constraints; j++){
+            y_ref_root[j].segment(0,3) = rot[j].toRotationMatrix() * y_ref[j].segment(0,3);
+            y_ref_root[j].segment(3,3) = rot[j].toRotationMatrix() * y_ref[j].segment(3,3);
+            weights_root[j].segment(0,3) = rot[j].toRotationMatrix() * weights[j].segment(0,3);
+            weights_root[j].segment(3,3) = rot[j].toRotationMatrix() * weights[j].segment(3,3);
+            weights_root[j] = weights_root[j].cwiseAbs();
+        }
+        time_reference.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        start = base::Time::now();
+        for(int j = 0; j < n_constraints; j++){
+            const base::Matrix3d rot_mat = rot[j].toRotationMatrix();
+            rotateVector6(rot_mat, y_ref[j], y_ref_root[j]);
+            rotateWeights6(rot_mat, weights[j], weights_root[j]);
+        }
+        time_rotate.push_back((double)(base::Time::now()-start).toMicroseconds());
+    }
+
+    cout << " ----------- Frame transform of reference and weights, " << n_constraints << " constraints -----------" << endl;
+    cout << "toRotationMatrix per segment   " << mean(time_reference) << " us" << endl;
+    cout << "rotateVector6/rotateWeights6   " << mean(time_rotate) << " us" << endl;
+}
+
+int main(){
+    srand(time(NULL));
+    int n_samples = 1000;
+    for(int n : {1, 100, 1000})
+        evaluatePoseError(n, n_samples);
+    for(int n : {10, 100})
+        evaluateFrameTransform(n, n_samples);
+}
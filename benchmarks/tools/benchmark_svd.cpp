@@ -0,0 +1,57 @@
+#include <iostream>
+#include <vector>
+#include <Eigen/SVD>
+#include <base/Time.hpp>
+#include <tools/SVD.hpp>
+
+using namespace std;
+using namespace wbc;
+
+double mean(const vector<double>& v){
+    double sum = 0;
+    for(auto d : v) sum += d;
+    return sum / v.size();
+}
+
+void evaluateSVD(int rows, int cols, int n_samples){
+    vector<double> time_nr, time_jacobi, time_eigen_jacobi, time_eigen_bdc;
+    base::MatrixXd U(rows, cols), V(cols, cols);
+    base::VectorXd S(cols), tmp(cols);
+
+    for(int i = 0; i < n_samples; i++){
+        base::MatrixXd A = base::MatrixXd::Random(rows, cols);
+
+        base::Time start = base::Time::now();
+        svd_eigen_decomposition(A, U, S, V, tmp);
+        time_nr.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        start = base::Time::now();
+        svd_jacobi_decomposition(A, U, S, V, tmp);
+        time_jacobi.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        start = base::Time::now();
+        Eigen::JacobiSVD<base::MatrixXd> jacobi_svd(A, Eigen::ComputeFullU | Eigen::ComputeFullV);
+        time_eigen_jacobi.push_back((double)(base::Time::now()-start).toMicroseconds());
+
+        start = base::Time::now();
+        Eigen::BDCSVD<base::MatrixXd> bdc_svd(A, Eigen::ComputeFullU | Eigen::ComputeFullV);
+        time_eigen_bdc.push_back((double)(base::Time::now()-start).toMicroseconds());
+    }
+
+    cout << " ----------- Matrix size " << rows << " x " << cols << " -----------" << endl;
+    cout << "svd_eigen_decomposition  " << mean(time_nr) << " us" << endl;
+    cout << "svd_jacobi_decomposition " << mean(time_jacobi) << " us" << endl;
+    cout << "Eigen::JacobiSVD         " << mean(time_eigen_jacobi) << " us" << endl;
+    cout << "Eigen::BDCSVD            " << mean(time_eigen_bdc) << " us" << endl;
+}
+
+int main(){
+    srand(time(NULL));
+    int n_samples = 1000;
+
+    // Typical sizes of the (projected) task matrices in the WBC scenes: rows = task variables, cols = robot joints
+    // svd_decomposition() switches to svd_jacobi_decomposition() at cols >= SVD_JACOBI_MIN_ASPECT_RATIO * rows
+    vector<pair<int,int>> sizes = {{6,7}, {6,12}, {6,18}, {6,40}, {12,12}, {12,24}, {12,36}, {12,50}, {16,16}, {16,48}, {24,50}, {30,30}, {60,50}};
+    for(auto s : sizes)
+        evaluateSVD(s.first, s.second, n_samples);
+}
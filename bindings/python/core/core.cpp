@@ -4,6 +4,7 @@
 #include "core/ConstraintConfig.hpp"
 #include "core/ConstraintStatus.hpp"
 #include "core/QuadraticProgram.hpp"
+#include "core/QPSolver.hpp"
 #include <base/JointLimits.hpp>
 #include <boost/python/enum.hpp>
 
@@ -12,6 +13,7 @@ BOOST_PYTHON_MODULE(core){
     np::initialize();
 
     pygen::convertMatrix<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::DontAlign>>();
+    pygen::convertMatrix<wbc::MatrixXdRowMajor>();
     pygen::convertVector<Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::DontAlign>>();
     pygen::convertStdVector<std::vector<std::string>>();
     pygen::convertStdVector<std::vector<double>>();
@@ -26,6 +28,7 @@ BOOST_PYTHON_MODULE(core){
     pygen::convertTransform<Eigen::Transform<double, 3, Eigen::DontAlign>>();
     pygen::convertQuaternion<Eigen::Quaternion<double, Eigen::DontAlign>>();
     pygen::convertStdVector<std::vector<wbc::ConstraintStatus>>();
+    pygen::convertStdVector<std::vector<wbc::SolverStats>>();
 
     py::class_<base::Pose>("Pose")
             .add_property("position",
@@ -235,5 +238,24 @@ BOOST_PYTHON_MODULE(core){
            .add_property("elements",
                py::make_getter(&wbc::ConstraintsStatus::elements, py::return_value_policy<py::copy_non_const_reference>()),
                py::make_setter(&wbc::ConstraintsStatus::elements));
+
+   py::enum_<wbc::QPSolverStatus>("QPSolverStatus")
+       .value("qp_solved", wbc::QPSolverStatus::qp_solved)
+       .value("qp_solved_late", wbc::QPSolverStatus::qp_solved_late)
+       .value("qp_deadline_exceeded", wbc::QPSolverStatus::qp_deadline_exceeded)
+       .value("qp_failed", wbc::QPSolverStatus::qp_failed);
+
+   py::class_<wbc::SolverStats>("SolverStats")
+       .def_readwrite("time",                 &wbc::SolverStats::time)
+       .def_readwrite("status",               &wbc::SolverStats::status)
+       .def_readwrite("total_time",           &wbc::SolverStats::total_time)
+       .def_readwrite("setup_time",           &wbc::SolverStats::setup_time)
+       .def_readwrite("factorization_time",   &wbc::SolverStats::factorization_time)
+       .def_readwrite("iteration_time",       &wbc::SolverStats::iteration_time)
+       .def_readwrite("n_iter",               &wbc::SolverStats::n_iter)
+       .def_readwrite("n_active_set_changes", &wbc::SolverStats::n_active_set_changes)
+       .def_readwrite("primal_residual",      &wbc::SolverStats::primal_residual)
+       .def_readwrite("dual_residual",        &wbc::SolverStats::dual_residual)
+       .def_readwrite("warm_start",           &wbc::SolverStats::warm_start);
 }
 
@@ -120,7 +120,7 @@ BOOST_PYTHON_MODULE(scenes){
 
     np::initialize();
 
-    py::class_<wbc_py::VelocityScene>("VelocityScene", py::init<std::shared_ptr<wbc_py::RobotModelKDL>, std::shared_ptr<wbc_py::QPOASESSolver>>())
+    py::class_<wbc_py::VelocityScene, boost::noncopyable>("VelocityScene", py::init<std::shared_ptr<wbc_py::RobotModelKDL>, std::shared_ptr<wbc_py::QPOASESSolver>>())
             .def(py::init<std::shared_ptr<wbc_py::RobotModelKDL>,std::shared_ptr<wbc_py::HierarchicalLSSolver>>())
             .def("configure",    &wbc_py::VelocityScene::configure)
             .def("update",       &wbc_py::VelocityScene::update, py::return_value_policy<py::copy_const_reference>())
@@ -139,7 +139,7 @@ BOOST_PYTHON_MODULE(scenes){
             .def("getJointWeights",   &wbc_py::VelocityScene::getJointWeights2)
             .def("getActuatedJointWeights",   &wbc_py::VelocityScene::getActuatedJointWeights2);
 
-    py::class_<wbc_py::VelocitySceneQuadraticCost>("VelocitySceneQuadraticCost", py::init<std::shared_ptr<wbc_py::RobotModelKDL>, std::shared_ptr<wbc_py::QPOASESSolver>>())
+    py::class_<wbc_py::VelocitySceneQuadraticCost, boost::noncopyable>("VelocitySceneQuadraticCost", py::init<std::shared_ptr<wbc_py::RobotModelKDL>, std::shared_ptr<wbc_py::QPOASESSolver>>())
             .def("configure",    &wbc_py::VelocitySceneQuadraticCost::configure)
             .def("update",       &wbc_py::VelocitySceneQuadraticCost::update, py::return_value_policy<py::copy_const_reference>())
             .def("solve",        &wbc_py::VelocitySceneQuadraticCost::solve2)
@@ -157,7 +157,7 @@ BOOST_PYTHON_MODULE(scenes){
             .def("getJointWeights",   &wbc_py::VelocitySceneQuadraticCost::getJointWeights2)
             .def("getActuatedJointWeights",   &wbc_py::VelocitySceneQuadraticCost::getActuatedJointWeights2);
 
-    py::class_<wbc_py::AccelerationSceneTSID>("AccelerationSceneTSID", py::init<std::shared_ptr<wbc_py::RobotModelHyrodyn>, std::shared_ptr<wbc_py::QPOASESSolver>>())
+    py::class_<wbc_py::AccelerationSceneTSID, boost::noncopyable>("AccelerationSceneTSID", py::init<std::shared_ptr<wbc_py::RobotModelHyrodyn>, std::shared_ptr<wbc_py::QPOASESSolver>>())
             .def("configure",    &wbc_py::AccelerationSceneTSID::configure)
             .def("update",       &wbc_py::AccelerationSceneTSID::update, py::return_value_policy<py::copy_const_reference>())
             .def("solve",        &wbc_py::AccelerationSceneTSID::solve2)
@@ -11,6 +11,11 @@ base::VectorXd HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hqp){
     wbc::HierarchicalLSSolver::solve(hqp, solver_output);
     return solver_output;
 }
+std::vector<wbc::SolverStats> HierarchicalLSSolver::getStatsHistoryAsVector(uint n){
+    std::vector<wbc::SolverStats> history;
+    wbc::HierarchicalLSSolver::getStatsHistory(history, n);
+    return history;
+}
 }
 
 BOOST_PYTHON_MODULE(hls_solver){
@@ -22,7 +27,12 @@ BOOST_PYTHON_MODULE(hls_solver){
             .def("setMaxSolverOutputNorm", &wbc_py::HierarchicalLSSolver::setMaxSolverOutputNorm)
             .def("getMaxSolverOutputNorm", &wbc_py::HierarchicalLSSolver::getMaxSolverOutputNorm)
             .def("setMinEigenvalue", &wbc_py::HierarchicalLSSolver::setMinEigenvalue)
-            .def("getMinEigenvalue", &wbc_py::HierarchicalLSSolver::getMinEigenvalue);
+            .def("getMinEigenvalue", &wbc_py::HierarchicalLSSolver::getMinEigenvalue)
+            .def("getStatus", &wbc_py::HierarchicalLSSolver::getStatus)
+            .def("getStats", &wbc_py::HierarchicalLSSolver::getStats, py::return_value_policy<py::copy_const_reference>())
+            .def("setStatsHistorySize", &wbc_py::HierarchicalLSSolver::setStatsHistorySize)
+            .def("getStatsHistorySize", &wbc_py::HierarchicalLSSolver::getStatsHistorySize)
+            .def("getStatsHistory", &wbc_py::HierarchicalLSSolver::getStatsHistoryAsVector);
 }
 
 
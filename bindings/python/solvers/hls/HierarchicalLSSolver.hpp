@@ -8,6 +8,7 @@ namespace wbc_py {
 class HierarchicalLSSolver : public wbc::HierarchicalLSSolver{
 public:
     base::VectorXd solve(const wbc::HierarchicalQP &hqp);
+    std::vector<wbc::SolverStats> getStatsHistoryAsVector(uint n);
 };
 
 }
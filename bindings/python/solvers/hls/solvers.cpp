@@ -12,6 +12,11 @@ base::VectorXd HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hqp){
     wbc::HierarchicalLSSolver::solve(hqp, solver_output);
     return solver_output;
 }
+std::vector<wbc::SolverStats> HierarchicalLSSolver::getStatsHistoryAsVector(uint n){
+    std::vector<wbc::SolverStats> history;
+    wbc::HierarchicalLSSolver::getStatsHistory(history, n);
+    return history;
+}
 base::VectorXd QPOASESSolver::solve(const wbc::HierarchicalQP &hqp){
     base::VectorXd solver_output;
     wbc::QPOASESSolver::solve(hqp, solver_output);
@@ -20,6 +25,11 @@ base::VectorXd QPOASESSolver::solve(const wbc::HierarchicalQP &hqp){
 int QPOASESSolver::getReturnValueAsInt(){
     return (int)wbc::QPOASESSolver::getReturnValue();
 }
+std::vector<wbc::SolverStats> QPOASESSolver::getStatsHistoryAsVector(uint n){
+    std::vector<wbc::SolverStats> history;
+    wbc::QPOASESSolver::getStatsHistory(history, n);
+    return history;
+}
 }
 
 BOOST_PYTHON_MODULE(solvers){
@@ -31,7 +41,12 @@ BOOST_PYTHON_MODULE(solvers){
             .def("setMaxSolverOutputNorm", &wbc_py::HierarchicalLSSolver::setMaxSolverOutputNorm)
             .def("getMaxSolverOutputNorm", &wbc_py::HierarchicalLSSolver::getMaxSolverOutputNorm)
             .def("setMinEigenvalue", &wbc_py::HierarchicalLSSolver::setMinEigenvalue)
-            .def("getMinEigenvalue", &wbc_py::HierarchicalLSSolver::getMinEigenvalue);
+            .def("getMinEigenvalue", &wbc_py::HierarchicalLSSolver::getMinEigenvalue)
+            .def("getStatus", &wbc_py::HierarchicalLSSolver::getStatus)
+            .def("getStats", &wbc_py::HierarchicalLSSolver::getStats, py::return_value_policy<py::copy_const_reference>())
+            .def("setStatsHistorySize", &wbc_py::HierarchicalLSSolver::setStatsHistorySize)
+            .def("getStatsHistorySize", &wbc_py::HierarchicalLSSolver::getStatsHistorySize)
+            .def("getStatsHistory", &wbc_py::HierarchicalLSSolver::getStatsHistoryAsVector);
     py::class_<wbc_py::QPOASESSolver>("QPOASESSolver")
             .def("solve", &wbc_py::QPOASESSolver::solve)
             .def("setMaxNoWSR", &wbc_py::QPOASESSolver::setMaxNoWSR)
@@ -39,7 +54,12 @@ BOOST_PYTHON_MODULE(solvers){
             .def("getReturnValue", &wbc_py::QPOASESSolver::getReturnValueAsInt)
             .def("getNoWSR", &wbc_py::QPOASESSolver::getNoWSR)
             .def("getOptions", &wbc_py::QPOASESSolver::getOptions)
-            .def("setOptions", &wbc_py::QPOASESSolver::setOptions);
+            .def("setOptions", &wbc_py::QPOASESSolver::setOptions)
+            .def("getStatus", &wbc_py::QPOASESSolver::getStatus)
+            .def("getStats", &wbc_py::QPOASESSolver::getStats, py::return_value_policy<py::copy_const_reference>())
+            .def("setStatsHistorySize", &wbc_py::QPOASESSolver::setStatsHistorySize)
+            .def("getStatsHistorySize", &wbc_py::QPOASESSolver::getStatsHistorySize)
+            .def("getStatsHistory", &wbc_py::QPOASESSolver::getStatsHistoryAsVector);
 }
 
 
@@ -9,12 +9,14 @@ namespace wbc_py {
 class HierarchicalLSSolver : public wbc::HierarchicalLSSolver{
 public:
     base::VectorXd solve(const wbc::HierarchicalQP &hqp);
+    std::vector<wbc::SolverStats> getStatsHistoryAsVector(uint n);
 };
 
 class QPOASESSolver : public wbc::QPOASESSolver{
 public:
     base::VectorXd solve(const wbc::HierarchicalQP &hqp);
     int getReturnValueAsInt();
+    std::vector<wbc::SolverStats> getStatsHistoryAsVector(uint n);
 };
 }
 
@@ -14,6 +14,11 @@ base::VectorXd QPOASESSolver::solve(const wbc::HierarchicalQP &hqp){
 int QPOASESSolver::getReturnValueAsInt(){
     return (int)wbc::QPOASESSolver::getReturnValue();
 }
+std::vector<wbc::SolverStats> QPOASESSolver::getStatsHistoryAsVector(uint n){
+    std::vector<wbc::SolverStats> history;
+    wbc::QPOASESSolver::getStatsHistory(history, n);
+    return history;
+}
 }
 
 BOOST_PYTHON_MODULE(qpoases_solver){
@@ -26,7 +31,12 @@ BOOST_PYTHON_MODULE(qpoases_solver){
             .def("getReturnValue", &wbc_py::QPOASESSolver::getReturnValueAsInt)
             .def("getNoWSR", &wbc_py::QPOASESSolver::getNoWSR)
             .def("getOptions", &wbc_py::QPOASESSolver::getOptions)
-            .def("setOptions", &wbc_py::QPOASESSolver::setOptions);
+            .def("setOptions", &wbc_py::QPOASESSolver::setOptions)
+            .def("getStatus", &wbc_py::QPOASESSolver::getStatus)
+            .def("getStats", &wbc_py::QPOASESSolver::getStats, py::return_value_policy<py::copy_const_reference>())
+            .def("setStatsHistorySize", &wbc_py::QPOASESSolver::setStatsHistorySize)
+            .def("getStatsHistorySize", &wbc_py::QPOASESSolver::getStatsHistorySize)
+            .def("getStatsHistory", &wbc_py::QPOASESSolver::getStatsHistoryAsVector);
 }
 
 
@@ -10,6 +10,7 @@ class QPOASESSolver : public wbc::QPOASESSolver{
 public:
     base::VectorXd solve(const wbc::HierarchicalQP &hqp);
     int getReturnValueAsInt();
+    std::vector<wbc::SolverStats> getStatsHistoryAsVector(uint n);
 };
 }
 
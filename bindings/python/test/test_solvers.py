@@ -46,5 +46,18 @@ def test_qp_oases_solver():
     assert(solver.getNoWSR() < 100)
     assert(solver.getReturnValue() == 0)
 
+def test_solver_stats():
+    solver = QPOASESSolver()
+    solver.setStatsHistorySize(5)
+    for i in range(7):
+        run(solver)
+    stats = solver.getStats()
+    assert stats.status == QPSolverStatus.qp_solved
+    assert stats.total_time >= stats.setup_time + stats.iteration_time
+    assert stats.warm_start
+    history = solver.getStatsHistory(10)
+    assert len(history) == 5
+    assert history[-1].n_iter == stats.n_iter
+
 if __name__ == '__main__':
     test_qp_oases_solver()
@@ -1,5 +1,6 @@
 #include "CartesianPosPDController.hpp"
 #include "ControllerTools.hpp"
+#include "../tools/SE3Tools.hpp"
 #include <base/samples/RigidBodyStateSE3.hpp>
 
 namespace ctrl_lib{
@@ -44,4 +45,21 @@ const base::samples::RigidBodyStateSE3& CartesianPosPDController::update(const b
 
     return control_output;
 }
+
+void CartesianPosPDController::rollout(const PosPDTrajectory& trajectory, const base::MatrixXd& p_gains, const base::MatrixXd& d_gains, const base::MatrixXd& ff_gains,
+                                       std::vector<base::MatrixXd>& out_vel, std::vector<base::MatrixXd>& out_acc){
+    checkRollout(trajectory, p_gains, d_gains, ff_gains);
+    const size_t n = trajectory.size();
+    if(trajectory.ref_pos.rows() != 7 || trajectory.pos.rows() != 7 || trajectory.pos.cols() != (int)n)
+        throw std::runtime_error("CartesianPosPDController::rollout: Pose trajectories have to be of size 7 x " + std::to_string(n));
+    if(!base::isnotnan(trajectory.ref_pos))
+        throw std::runtime_error("CartesianPosPDController::rollout: Setpoint pose contains NaN values");
+    if(!base::isnotnan(trajectory.pos))
+        throw std::runtime_error("CartesianPosPDController::rollout: Feedback pose contains NaN values");
+
+    // Pose error, see operator-(Pose,Pose)
+    wbc::poseErrors(trajectory.ref_pos, trajectory.pos, batch_pos_diff);
+
+    rolloutFromError(trajectory, p_gains, d_gains, ff_gains, out_vel, out_acc);
+}
 }
@@ -51,6 +51,14 @@ public:
     CartesianPosPDController();
     /** Convert typed to raw input data and call PosPDController::update()*/
     const base::samples::RigidBodyStateSE3& update(const base::samples::RigidBodyStateSE3& setpoint, const base::samples::RigidBodyStateSE3& feedback);
+    /**
+     * @brief Compute the control output for all samples of the given trajectory and for multiple gain sets at once, see PosPDController::rollout(). Here, ref_pos and pos
+     *  of the trajectory contain the poses as 7 x n matrices, where each column is (position, orientation as quaternion (x,y,z,w)). Twists and spatial accelerations are
+     *  6 x n matrices (linear, angular). The pose error is computed as in update(), but directly from the quaternions.
+     */
+    virtual void rollout(const PosPDTrajectory& trajectory, const base::MatrixXd& p_gains, const base::MatrixXd& d_gains, const base::MatrixXd& ff_gains,
+                         std::vector<base::MatrixXd>& out_vel, std::vector<base::MatrixXd>& out_acc);
+    using PosPDController::rollout;
 };
 
 }
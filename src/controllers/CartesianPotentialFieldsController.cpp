@@ -1,10 +1,73 @@
 #include "CartesianPotentialFieldsController.hpp"
+#include "RadialPotentialField.hpp"
 #include <stdexcept>
+#include <typeinfo>
 
 using namespace ctrl_lib;
 
 CartesianPotentialFieldsController::CartesianPotentialFieldsController() :
-    PotentialFieldsController(3){
+    PotentialFieldsController(3),
+    use_spatial_index(false){
+}
+
+void CartesianPotentialFieldsController::setFields(const std::vector<PotentialFieldPtr>& _fields){
+    PotentialFieldsController::setFields(_fields);
+    active_fields.clear();
+    active_fields_prev.clear();
+    is_active.assign(fields.size(), false);
+
+    // Only fields with exactly this type are skipped out of range, derived classes might override update()
+    is_radial.resize(fields.size());
+    all_fields.resize(fields.size());
+    for(uint i = 0; i < fields.size(); i++){
+        const PotentialField& f = *fields[i];
+        is_radial[i] = typeid(f) == typeid(RadialPotentialField);
+        all_fields[i] = i;
+    }
+
+    if(use_spatial_index)
+        buildIndex();
+}
+
+void CartesianPotentialFieldsController::clearFields(){
+    setFields(std::vector<PotentialFieldPtr>());
+}
+
+void CartesianPotentialFieldsController::setSpatialIndex(bool enable){
+    use_spatial_index = enable;
+    if(use_spatial_index)
+        buildIndex();
+    else
+        grid.clear();
+}
+
+void CartesianPotentialFieldsController::buildIndex(){
+    grid.build(fields);
+    // Fields which are never returned by the index have no influence, i.e., zero gradient. Also, none of the fields is active yet
+    for(PotentialFieldPtr f : fields)
+        f->gradient.setZero(3);
+    active_fields.clear();
+}
+
+void CartesianPotentialFieldsController::updateField(uint idx){
+    if(use_spatial_index)
+        grid.update(fields, idx);
+}
+
+void CartesianPotentialFieldsController::evaluateFields(const std::vector<uint>& indices, const base::Vector3d& position){
+
+    // Radial fields out of their influence distance have zero gradient. Since most fields are usually far away from the current position, this saves
+    // most of the gradient computations
+    for(uint idx : indices){
+        PotentialField& f = *fields[idx];
+        if(is_radial[idx] && f.pot_field_center.size() == 3 && f.influence_distance > 0 &&
+           (position - f.pot_field_center).squaredNorm() > f.influence_distance * f.influence_distance){
+            f.distance = position - f.pot_field_center;
+            f.gradient.setZero(3);
+        }
+        else
+            control_output += f.update(position);
+    }
 }
 
 const base::samples::RigidBodyStateSE3& CartesianPotentialFieldsController::update(const base::samples::RigidBodyStateSE3& feedback){
@@ -15,10 +78,22 @@ const base::samples::RigidBodyStateSE3& CartesianPotentialFieldsController::upda
         throw std::runtime_error("CartesianPotentialFieldsController::update: PGain should have size 3, but has size " + std::to_string(p_gain.size()));
 
     control_output.setZero();
-    for(PotentialFieldPtr f : fields){
-        // Update Potential field and add gradient to control output
-        control_output += f->update(feedback.pose.position);
+    if(use_spatial_index){
+        // Evaluate only the fields close to the current position. Reset the gradient of fields that have been active in the previous cycle
+        active_fields.swap(active_fields_prev);
+        grid.query(feedback.pose.position, active_fields);
+        evaluateFields(active_fields, feedback.pose.position);
+        for(uint idx : active_fields)
+            is_active[idx] = true;
+        for(uint idx : active_fields_prev){
+            if(!is_active[idx])
+                fields[idx]->gradient.setZero();
+        }
+        for(uint idx : active_fields)
+            is_active[idx] = false;
     }
+    else
+        evaluateFields(all_fields, feedback.pose.position);
     // Multiply gain
     control_output = p_gain.cwiseProduct(control_output);
 
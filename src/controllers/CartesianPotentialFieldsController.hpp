@@ -2,20 +2,61 @@
 #define CARTESIAN_POTENTIAL_FIELDS_CONTROLLER_HPP
 
 #include "PotentialFieldsController.hpp"
+#include "PotentialFieldGrid.hpp"
 #include <base/samples/RigidBodyStateSE3.hpp>
 
 namespace ctrl_lib{
 
 /**
  * @brief The PotentialFieldsController class implements a multi potential field controller in Cartesian space.
+ *
+ * For a large number of fields, e.g., one radial field per point of an obstacle point cloud, a spatial index can be enabled (see setSpatialIndex()).
+ * Then, only fields that may have an influence on the current position are evaluated, see PotentialFieldGrid.
+ *
+ * Fields of type RadialPotentialField that are out of their influence distance are not evaluated using update(), since their gradient is zero. Only their distance
+ * is computed and their gradient is set to zero. All other fields (including classes derived from RadialPotentialField) are evaluated using their update() method.
  */
 class CartesianPotentialFieldsController : public PotentialFieldsController{
 protected:
     base::samples::RigidBodyStateSE3 cartesian_control_output;
+    bool use_spatial_index;
+    PotentialFieldGrid grid;
+    std::vector<uint> active_fields, active_fields_prev, all_fields;
+    std::vector<bool> is_active;
+
+    std::vector<bool> is_radial;    /** True for fields of type RadialPotentialField (not derived classes)*/
+
+    /** Evaluate the fields with the given indices and add their gradients to the control output*/
+    void evaluateFields(const std::vector<uint>& indices, const base::Vector3d& position);
+    /** Build the spatial index from the current fields and set the gradients of all fields to zero*/
+    void buildIndex();
 
 public:
     CartesianPotentialFieldsController();
 
+    /** Provide new potential fields. Dimension of each field has to be 3. Rebuilds the spatial index, if enabled*/
+    virtual void setFields(const std::vector<PotentialFieldPtr>& _fields);
+
+    /** Erase all potential fields*/
+    virtual void clearFields();
+
+    /**
+     * @brief Enable/disable the spatial index. If enabled, only fields that may influence the current position are evaluated in update(). In this case, the
+     *  gradient and distance of the other fields are not updated, except that the gradient of fields that have been active in the previous cycle is set to zero.
+     *  When the index is (re)built, i.e., in this method and in setFields(), the gradients of all fields are set to zero.
+     *  The field centers and influence distances are copied to the index. If they change, updateField() has to be called. Default is false.
+     */
+    void setSpatialIndex(bool enable);
+
+    /** Returns true if the spatial index is enabled*/
+    bool getSpatialIndex(){return use_spatial_index;}
+
+    /** Update the spatial index after the center or influence distance of the field with the given index has changed. Does nothing if the spatial index is disabled*/
+    void updateField(uint idx);
+
+    /** Indices of the fields that have been evaluated in the last call of update(). Only valid if the spatial index is enabled*/
+    const std::vector<uint>& getActiveFields(){return active_fields;}
+
     /**
      * @brief update Compute control output. Saturation will be applied if its has been set
      * @return control_output Control output
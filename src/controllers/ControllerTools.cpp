@@ -1,4 +1,5 @@
 #include "ControllerTools.hpp"
+#include "../tools/SE3Tools.hpp"
 
 #include <base/Twist.hpp>
 #include <base/Pose.hpp>
@@ -6,16 +7,10 @@
 namespace base{
 
 Twist operator-(const Pose& a, const Pose& b){
-    Eigen::Affine3d tf_a = a.toTransform();
-    Eigen::Affine3d tf_b = b.toTransform();
-
-    Eigen::Matrix3d rot_mat = tf_b.rotation().inverse() * tf_a.rotation();
-    Eigen::AngleAxisd angle_axis;
-    angle_axis.fromRotationMatrix(rot_mat);
-
+    // The rotation error R_b * log(R_b^T * R_a) is the same as log(R_a * R_b^T), which is computed directly from the quaternions
     base::Twist twist;
-    twist.linear = tf_a.translation() - tf_b.translation();
-    twist.angular = tf_b.rotation() * (angle_axis.axis() * angle_axis.angle());
+    twist.linear = a.position - b.position;
+    twist.angular = wbc::rotationError(a.orientation, b.orientation);
     return twist;
 }
 }
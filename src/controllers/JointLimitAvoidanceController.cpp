@@ -23,38 +23,76 @@ JointLimitAvoidanceController::JointLimitAvoidanceController(const base::JointLi
         fields.push_back(field);
     }
 
+    setJointLimits(limits);
+
+    epsilon = 1e-9;
+}
+
+void JointLimitAvoidanceController::setJointLimits(const base::JointLimits& limits){
+    if(limits.size() != dimension)
+        throw runtime_error("JointLimitAvoidanceController::setJointLimits: Size of joint limits is " + to_string(limits.size()) + " but should be " + to_string(dimension));
+
     joint_limits = limits;
     joints_control_output.resize(limits.size());
     joints_control_output.names = limits.names;
 
-    epsilon = 1e-9;
+    lower.resize(dimension);
+    upper.resize(dimension);
+    for(size_t i = 0; i < dimension; i++){
+        lower(i) = limits[i].min.position;
+        upper(i) = limits[i].max.position;
+    }
+    influence.resize(dimension);
+    position.resize(dimension);
+    center.resize(dimension);
+    abs_distance.resize(dimension);
+    gradient.resize(dimension);
+
+    // Joint names might have changed
+    bound_names.clear();
+    joint_indices.clear();
+}
+
+void JointLimitAvoidanceController::bindJoints(const base::samples::Joints& feedback){
+    joint_indices.resize(dimension);
+    for(size_t i = 0; i < dimension; i++)
+        joint_indices[i] = feedback.mapNameToIndex(joint_limits.names[i]);
+    bound_names = feedback.names;
 }
 
 const base::commands::Joints& JointLimitAvoidanceController::update(const base::samples::Joints& feedback){
 
-    for(size_t i = 0; i < joint_limits.size(); i++){
-
-        const string& name = joint_limits.names[i];
-        double min = joint_limits[i].min.position;
-        double max = joint_limits[i].max.position;
-        double pos = feedback[name].position;
-
-        // Prevent infinite control action:
-        if(pos >= max)
-            pos = max - epsilon;
-        if(pos <= min)
-            pos = min  + epsilon;
-
-        // Set potential field center position depending on which is closer: upper or lower limit
-        double c_pos = fabs(max - pos)  < fabs(pos - min) ? max : min;
-        fields[i]->pot_field_center.setConstant(1, c_pos);
-        fields[i]->time = feedback.time;
-
-        // Compute Control output
-        base::VectorXd pos_vect(1);
-        pos_vect << pos;
-        fields[i]->update(pos_vect);
-        control_output(i) = p_gain(i) * fields[i]->gradient(0);
+    // Comparing the names does not allocate memory, the indices are only computed if the joint names change
+    if(joint_indices.size() != dimension || feedback.names != bound_names)
+        bindJoints(feedback);
+
+    for(size_t i = 0; i < dimension; i++){
+        position(i) = feedback[joint_indices[i]].position;
+        influence(i) = fields[i]->influence_distance;
+    }
+    if((influence <= 0).any())
+        throw std::invalid_argument("JointLimitAvoidanceController::update: influence_distance has to be > 0!");
+
+    // Prevent infinite control action:
+    position = (position >= upper).select(upper - epsilon, position);
+    position = (position <= lower).select(lower + epsilon, position);
+
+    // Set potential field center position depending on which is closer: upper or lower limit
+    center = ((upper - position).abs() < (position - lower).abs()).select(upper, lower);
+
+    // Compute Control output. In 1D, the gradient direction is the sign of the distance to the field center
+    abs_distance = (position - center).abs();
+    RadialPotentialField::gradientFactor(abs_distance, influence, gradient);
+    gradient = (abs_distance == 0).select(0.0, gradient * (position - center) / abs_distance);
+    control_output.array() = p_gain.array() * gradient;
+
+    // Write the results back to the potential fields
+    for(size_t i = 0; i < dimension; i++){
+        PotentialField& field = *fields[i];
+        field.pot_field_center(0) = center(i);
+        field.distance(0) = position(i) - center(i);
+        field.gradient(0) = gradient(i);
+        field.time = feedback.time;
     }
 
     // Apply saturation
@@ -4,16 +4,31 @@
 #include "PotentialField.hpp"
 #include "PotentialFieldsController.hpp"
 #include <base/JointLimits.hpp>
+#include <base/samples/Joints.hpp>
 #include <base/commands/Joints.hpp>
 
 namespace ctrl_lib {
 
+/**
+ * @brief Keeps the joints away from their position limits using one 1D radial potential field per joint, whose center is the closer joint limit.
+ *
+ * All joints are evaluated at once using Eigen array operations (see RadialPotentialField::gradientFactor()), update() does not allocate memory. The
+ * indices of the joints in the feedback vector are determined only if the joint names of the feedback change. The results are written back to the potential
+ * fields (see getFields()), whose influence distance may be modified between two calls of update().
+ */
 class JointLimitAvoidanceController : public PotentialFieldsController{
 protected:
     base::JointLimits joint_limits;
     base::commands::Joints joints_control_output;
     double epsilon;
 
+    std::vector<std::string> bound_names;   /** Joint names of the feedback that joint_indices belong to*/
+    std::vector<size_t> joint_indices;      /** Index of each joint in the feedback*/
+    Eigen::ArrayXd lower, upper, influence, position, center, abs_distance, gradient;
+
+    /** Compute the indices of all joints in the feedback vector*/
+    void bindJoints(const base::samples::Joints& feedback);
+
 public:
     JointLimitAvoidanceController(const base::JointLimits& limits,
                                   const base::VectorXd &influence_distance);
@@ -24,7 +39,7 @@ public:
     const base::commands::Joints& update(const base::samples::Joints& feedback);
     /**
      * @brief setJointLimits set upper and lower joint limits for the controller
-     * @param joint_limits
+     * @param joint_limits Size has to be the same as the dimension of the controller
      */
     void setJointLimits(const base::JointLimits& limits);
     /** Value to avoid nunmerical issues close to the joint limits. Default is 1e-9*/
@@ -0,0 +1,154 @@
+#ifndef PID_CONTROLLER_BANK_HPP
+#define PID_CONTROLLER_BANK_HPP
+
+#include <base/Eigen.hpp>
+#include "PIDCtrlParams.hpp"
+#include <stdexcept>
+#include <string>
+#include <limits>
+
+namespace ctrl_lib{
+
+/**
+ * @brief Bank of N independent PID channels, which are updated at once using Eigen array operations. All gains and states are stored in contiguous
+ *  vectors. For N = 3 and N = 6 (e.g. Cartesian force/torque), all members have fixed size and live on the stack, use N = Eigen::Dynamic (PIDControllerBankX)
+ *  for an arbitrary number of channels. update() does not allocate memory.
+ *
+ *  Each channel i computes
+ *  \f[
+ *        u_i = k_{p,i} e_i + k_{i,i} \sum e_i \cdot dt + k_{d,i} \dot{e}_{f,i}
+ *  \f]
+ * with
+ *  - Dead zone and derivative as in PIDController
+ *  - Integral windup per channel: \f$-w_i \leq \sum e_i \cdot dt \leq w_i\f$. Unlike PIDController, which scales the whole integral vector with a common factor
+ *    if one entry exceeds its windup (and thus also shrinks the integrals of the other channels), each channel is clamped independently. Both are identical as long as
+ *    no integral reaches its windup limit.
+ *  - Saturation per channel: \f$-u_{max,i} \leq u_i \leq u_{max,i}\f$. Unlike PIDController, the channels are not scaled with a common factor.
+ *  - Anti-windup by conditional integration: The integral of a channel is not updated if this would saturate the channel and the control error drives it further into saturation
+ *  - First order low pass filter on the derivative: \f$\dot{e}_{f} = a \dot{e}_{f,prev} + (1-a)\frac{e-e_{prev}}{dt}\f$ with \f$a = T_f / (T_f + dt)\f$
+ *    and filter time constant \f$T_f\f$. \f$T_f=0\f$ (default) disables the filter
+ */
+template<int N> class PIDControllerBank{
+public:
+    typedef Eigen::Matrix<double, N, 1> VectorNd;
+    // Fixed size members might require alignment
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+protected:
+    uint dimension;
+    VectorNd p_gain, i_gain, d_gain, windup;
+    VectorNd max_ctrl_output, dead_zone, filter_time_constant;
+    VectorNd control_error, prev_control_error, integral, integral_candidate, derivative, control_output;
+
+    void checkSize(const base::VectorXd& v, const std::string& name) const{
+        if(v.size() != dimension)
+            throw std::runtime_error("Size of " + name + " is " + std::to_string(v.size()) + " but should be " + std::to_string(dimension));
+    }
+
+public:
+    /** Create a bank with the given number of channels. If N is fixed, the number of channels has to be N*/
+    PIDControllerBank(uint n_channels = (N == Eigen::Dynamic ? 0 : N)) :
+        dimension(n_channels){
+        if(N != Eigen::Dynamic && n_channels != (uint)N)
+            throw std::invalid_argument("PIDControllerBank: Number of channels is " + std::to_string(n_channels) + " but should be " + std::to_string(N));
+        p_gain.setZero(dimension);
+        i_gain.setZero(dimension);
+        d_gain.setZero(dimension);
+        windup.setConstant(dimension, std::numeric_limits<double>::max());
+        max_ctrl_output.setConstant(dimension, std::numeric_limits<double>::max());
+        dead_zone.setZero(dimension);
+        filter_time_constant.setZero(dimension);
+        control_output.setConstant(dimension, std::numeric_limits<double>::quiet_NaN());
+        control_error.setZero(dimension);
+        integral_candidate.resize(dimension);
+        derivative.resize(dimension);
+        reset();
+    }
+
+    /**
+     * @brief Compute the control output of all channels
+     * @param setpoint Reference values. Size has to be the number of channels
+     * @param feedback Actual values. Size has to be the number of channels
+     * @param delta_t Time since the last update in seconds. Has to be > 0
+     * @return Control output of all channels
+     */
+    const VectorNd& update(const VectorNd& setpoint, const VectorNd& feedback, const double delta_t){
+        if(setpoint.size() != dimension || feedback.size() != dimension)
+            throw std::invalid_argument("PIDControllerBank::update: Size of setpoint and feedback has to be " + std::to_string(dimension));
+        if(delta_t <= 0)
+            throw std::invalid_argument("PIDControllerBank::update: delta_t has to be > 0");
+
+        control_error = setpoint - feedback;
+
+        // Integral of the raw control error (like PIDController), clamped to the windup per channel
+        integral_candidate = (integral + control_error * delta_t).cwiseMin(windup).cwiseMax(-windup);
+
+        // Dead zone
+        control_error = (control_error.array().abs() < dead_zone.array()).select(0.0,
+                        (control_error.array() >= dead_zone.array()).select(control_error.array() - dead_zone.array(), control_error.array() + dead_zone.array()));
+
+        // Filtered derivative
+        derivative.array() = (filter_time_constant.array() / (filter_time_constant.array() + delta_t)) * (derivative.array() - (control_error - prev_control_error).array() / delta_t)
+                             + (control_error - prev_control_error).array() / delta_t;
+        prev_control_error = control_error;
+
+        // Conditional integration: Keep the old integral in saturated channels if the control error has the same sign as the control output
+        control_output = p_gain.cwiseProduct(control_error) + i_gain.cwiseProduct(integral_candidate) + d_gain.cwiseProduct(derivative);
+        integral = (control_output.array().abs() > max_ctrl_output.array() && control_output.array() * control_error.array() > 0).select(integral, integral_candidate);
+
+        control_output = (p_gain.cwiseProduct(control_error) + i_gain.cwiseProduct(integral) + d_gain.cwiseProduct(derivative)).cwiseMin(max_ctrl_output).cwiseMax(-max_ctrl_output);
+        return control_output;
+    }
+
+    /** Reset integral, derivative and previous control error to zero*/
+    void reset(){
+        integral.setZero(dimension);
+        prev_control_error.setZero(dimension);
+        derivative.setZero(dimension);
+    }
+
+    /** Set P-, I- and D-gain and windup. Size of all entries has to be the number of channels*/
+    void setPID(const PIDCtrlParams &params){
+        checkSize(params.p_gain, "p_gain");
+        checkSize(params.i_gain, "i_gain");
+        checkSize(params.d_gain, "d_gain");
+        checkSize(params.windup, "windup");
+        p_gain = params.p_gain;
+        i_gain = params.i_gain;
+        d_gain = params.d_gain;
+        windup = params.windup;
+    }
+    /** Set the maximum absolute control output of each channel*/
+    void setMaxCtrlOutput(const base::VectorXd &max){
+        checkSize(max, "Max. Ctrl Output");
+        max_ctrl_output = max;
+    }
+    const VectorNd& maxCtrlOutput() const {return max_ctrl_output;}
+    /** Set dead zone of each channel*/
+    void setDeadZone(const base::VectorXd &dz){
+        checkSize(dz, "dead zone");
+        dead_zone = dz;
+    }
+    const VectorNd& deadZone() const {return dead_zone;}
+    /** Set time constants of the derivative low pass filter in seconds. Have to be >= 0, 0 disables the filter*/
+    void setDerivativeFilter(const base::VectorXd &time_constant){
+        checkSize(time_constant, "derivative filter time constant");
+        if((time_constant.array() < 0).any())
+            throw std::invalid_argument("PIDControllerBank::setDerivativeFilter: Time constants have to be >= 0");
+        filter_time_constant = time_constant;
+    }
+    const VectorNd& derivativeFilter() const {return filter_time_constant;}
+    uint getDimension() const {return dimension;}
+    const VectorNd& getControlError() const {return control_error;}
+    const VectorNd& getIntegral() const {return integral;}
+    const VectorNd& getDerivative() const {return derivative;}
+    const VectorNd& getControlOutput() const {return control_output;}
+};
+
+typedef PIDControllerBank<3> PIDControllerBank3;
+typedef PIDControllerBank<6> PIDControllerBank6;
+typedef PIDControllerBank<Eigen::Dynamic> PIDControllerBankX;
+
+}
+
+#endif
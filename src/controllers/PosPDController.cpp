@@ -58,6 +58,95 @@ void PosPDController::update(){
    applySaturation(control_out_acc, max_control_output, control_out_acc);
 }
 
+void PosPDController::checkRollout(const PosPDTrajectory& trajectory, const base::MatrixXd& p_gains, const base::MatrixXd& d_gains, const base::MatrixXd& ff_gains){
+    if(p_gains.rows() != dim_controller || d_gains.rows() != dim_controller || ff_gains.rows() != dim_controller)
+        throw std::runtime_error("PosPDController::rollout: Number of rows of the gain matrices has to be " + std::to_string(dim_controller));
+    if(d_gains.cols() != p_gains.cols() || ff_gains.cols() != p_gains.cols())
+        throw std::runtime_error("PosPDController::rollout: Number of gain sets has to be the same for all gains");
+    if(!base::isnotnan(p_gains) || !base::isnotnan(d_gains) || !base::isnotnan(ff_gains))
+        throw std::runtime_error("PosPDController::rollout: Gains contain NaN values");
+
+    const size_t n = trajectory.size();
+    const base::MatrixXd* m[] = {&trajectory.ref_vel, &trajectory.vel, &trajectory.ref_acc, &trajectory.acc};
+    for(const base::MatrixXd* mat : m){
+        if(mat->size() != 0 && (mat->rows() != dim_controller || mat->cols() != n))
+            throw std::runtime_error("PosPDController::rollout: Velocity and acceleration trajectories have to be empty or of size "
+                                     + std::to_string(dim_controller) + " x " + std::to_string(n));
+    }
+}
+
+// Set all columns that contain NaN to zero
+static void zeroNaNColumns(base::MatrixXd& m){
+    for(int j = 0; j < m.cols(); j++){
+        if(!base::isnotnan(m.col(j)))
+            m.col(j).setZero();
+    }
+}
+
+void PosPDController::rolloutFromError(const PosPDTrajectory& trajectory, const base::MatrixXd& p_gains, const base::MatrixXd& d_gains, const base::MatrixXd& ff_gains,
+                                       std::vector<base::MatrixXd>& out_vel, std::vector<base::MatrixXd>& out_acc){
+
+    const size_t n = trajectory.size();
+
+    // Dead zone, see applyDeadZone()
+    batch_pos_diff = (batch_pos_diff.array().abs() < dead_zone.replicate(1, n).array()).select(0.0,
+                     (batch_pos_diff.array() >= dead_zone.replicate(1, n).array()).select(batch_pos_diff.colwise() - dead_zone,
+                                                                                         batch_pos_diff.colwise() + dead_zone));
+
+    // Velocity feed forward, velocity error and acceleration feed forward do not depend on the gains. NaN samples are set to zero, which is the same as ignoring them
+    if(trajectory.ref_vel.size() == 0)
+        batch_ref_vel.setZero(dim_controller, n);
+    else{
+        batch_ref_vel = trajectory.ref_vel;
+        zeroNaNColumns(batch_ref_vel);
+    }
+    if(trajectory.ref_vel.size() == 0 || trajectory.vel.size() == 0)
+        batch_vel_diff.setZero(dim_controller, n);
+    else{
+        batch_vel_diff = trajectory.ref_vel - trajectory.vel;
+        zeroNaNColumns(batch_vel_diff);
+    }
+    if(trajectory.ref_acc.size() == 0)
+        batch_ref_acc.setZero(dim_controller, n);
+    else{
+        batch_ref_acc = trajectory.ref_acc;
+        zeroNaNColumns(batch_ref_acc);
+    }
+
+    out_vel.resize(p_gains.cols());
+    out_acc.resize(p_gains.cols());
+    for(int g = 0; g < p_gains.cols(); g++){
+        out_vel[g] = p_gains.col(g).asDiagonal() * batch_pos_diff + d_gains.col(g).asDiagonal() * batch_ref_vel;
+        out_acc[g] = p_gains.col(g).asDiagonal() * batch_pos_diff + d_gains.col(g).asDiagonal() * batch_vel_diff + ff_gains.col(g).asDiagonal() * batch_ref_acc;
+
+        // Saturation of each sample, see applySaturation()
+        for(base::MatrixXd* out : {&out_vel[g], &out_acc[g]}){
+            batch_eta = (out->array().abs().inverse().colwise() * max_control_output.array()).colwise().minCoeff().min(1.0);
+            out->array().rowwise() *= batch_eta.array();
+        }
+    }
+}
+
+void PosPDController::rollout(const PosPDTrajectory& trajectory, const base::MatrixXd& p_gains, const base::MatrixXd& d_gains, const base::MatrixXd& ff_gains,
+                              std::vector<base::MatrixXd>& out_vel, std::vector<base::MatrixXd>& out_acc){
+    checkRollout(trajectory, p_gains, d_gains, ff_gains);
+    if(trajectory.ref_pos.rows() != dim_controller || trajectory.pos.rows() != dim_controller || trajectory.pos.cols() != trajectory.ref_pos.cols())
+        throw std::runtime_error("PosPDController::rollout: Position trajectories have to be of size " + std::to_string(dim_controller) + " x " + std::to_string(trajectory.size()));
+    if(!base::isnotnan(trajectory.ref_pos))
+        throw std::runtime_error("PosPDController::rollout: Setpoint position contains NaN values");
+    if(!base::isnotnan(trajectory.pos))
+        throw std::runtime_error("PosPDController::rollout: Feedback position contains NaN values");
+
+    batch_pos_diff = trajectory.ref_pos - trajectory.pos;
+    rolloutFromError(trajectory, p_gains, d_gains, ff_gains, out_vel, out_acc);
+}
+
+void PosPDController::rollout(const PosPDTrajectory& trajectory, base::MatrixXd& out_vel, base::MatrixXd& out_acc){
+    rollout(trajectory, p_gain, d_gain, ff_gain, batch_out_vel, batch_out_acc);
+    out_vel.swap(batch_out_vel[0]);
+    out_acc.swap(batch_out_acc[0]);
+}
+
 void PosPDController::setPGain(const base::VectorXd &gain){
     if(!base::isnotnan(gain))
         throw std::runtime_error("PosPDController::setPGain: Invalid P-Gain. Contains NaN values");
@@ -2,9 +2,22 @@
 #define POS_PD_CONTROLLER
 
 #include <base/Eigen.hpp>
+#include <vector>
 
 namespace ctrl_lib {
 
+/**
+ * @brief Setpoint and feedback trajectories for PosPDController::rollout(). Column j of each matrix contains sample j, the number of rows is the dimension
+ *  of the controller. Columns of the velocity and acceleration matrices that contain NaN are ignored in the same way as in PosPDController::update(). Empty velocity
+ *  or acceleration matrices are treated like NaN, i.e., velocity control or acceleration feed forward is disabled for all samples.
+ */
+struct PosPDTrajectory{
+    base::MatrixXd ref_pos, ref_vel, ref_acc;
+    base::MatrixXd pos, vel, acc;
+    /** Number of samples*/
+    size_t size() const {return ref_pos.cols();}
+};
+
 /**
  * @brief The PosPDController class implements the following two control scemes
  *
@@ -34,12 +47,39 @@ protected:
     base::VectorXd pos_diff, vel_diff;
     base::VectorXd control_out_vel, control_out_acc;
 
+    // Workspace for rollout()
+    base::MatrixXd batch_pos_diff, batch_ref_vel, batch_vel_diff, batch_ref_acc;
+    Eigen::RowVectorXd batch_eta;
+    std::vector<base::MatrixXd> batch_out_vel, batch_out_acc;
+
+    /** Compute the control output of rollout() from the position error in batch_pos_diff (before dead zone) and the velocities and accelerations of the trajectory*/
+    void rolloutFromError(const PosPDTrajectory& trajectory, const base::MatrixXd& p_gains, const base::MatrixXd& d_gains, const base::MatrixXd& ff_gains,
+                          std::vector<base::MatrixXd>& out_vel, std::vector<base::MatrixXd>& out_acc);
+    /** Check size and NaN values of the gains and the velocities/accelerations of the trajectory*/
+    void checkRollout(const PosPDTrajectory& trajectory, const base::MatrixXd& p_gains, const base::MatrixXd& d_gains, const base::MatrixXd& ff_gains);
+
 public:
     PosPDController(size_t dim_controller);
+    virtual ~PosPDController(){}
 
     /** Compute control output and store it in control_out_vel and control_out_acc. Throws if any of the ref or actual position
      *  entries is NaN. Ignores NaN ref or actual velocity (disables velocity control) and NaN ref acceleration (disables acceleration feed forward)*/
     void update();
+    /**
+     * @brief Compute the control output for all samples of the given trajectory and for multiple gain sets at once, e.g., for offline gain tuning.
+     *  The result of each sample is the same as for a call of update() with the corresponding setpoint and feedback. Dead zone and saturation are taken
+     *  from the controller, the state of the controller is not modified.
+     * @param trajectory Setpoint and feedback trajectories. Positions must not contain NaN.
+     * @param p_gains Position gains. Column g is gain set g. Number of rows has to be the dimension of the controller.
+     * @param d_gains Velocity gains. Same size as p_gains.
+     * @param ff_gains Feed forward gains. Same size as p_gains.
+     * @param out_vel Velocity control output for each gain set (dimension x no of samples). Will be resized.
+     * @param out_acc Acceleration control output for each gain set (dimension x no of samples). Will be resized.
+     */
+    virtual void rollout(const PosPDTrajectory& trajectory, const base::MatrixXd& p_gains, const base::MatrixXd& d_gains, const base::MatrixXd& ff_gains,
+                         std::vector<base::MatrixXd>& out_vel, std::vector<base::MatrixXd>& out_acc);
+    /** Same as above, using the current gains of the controller*/
+    void rollout(const PosPDTrajectory& trajectory, base::MatrixXd& out_vel, base::MatrixXd& out_acc);
     /** Set proportional/position gain. Size has to be the same dimension of the controller*/
     void setPGain(const base::VectorXd &gain);
     /** Get proportional/position gain*/
@@ -33,6 +33,10 @@ public:
      */
     virtual const base::VectorXd& update(const base::VectorXd &position) = 0;
 
+    /** True if the gradient is zero for all positions whose distance to pot_field_center is larger than influence_distance. Used to skip
+     *  the evaluation of distant fields. Default is false.*/
+    virtual bool hasLocalSupport() const {return false;}
+
     base::Time time;
 
     /** Dimension of the potential field, e.g. a potential field in 3d space would have size 3.*/
@@ -0,0 +1,126 @@
+#include "PotentialFieldGrid.hpp"
+#include <cmath>
+#include <algorithm>
+
+using namespace ctrl_lib;
+
+PotentialFieldGrid::PotentialFieldGrid() :
+    cell_size(1){
+}
+
+PotentialFieldGrid::CellKey PotentialFieldGrid::cellKey(int x, int y, int z) const{
+    // 21 bits per coordinate. Cell indices beyond +-2^20 wrap around, which only increases the number of candidates, since query() checks the distance
+    const CellKey mask = (1 << 21) - 1;
+    return (((CellKey)x & mask) << 42) | (((CellKey)y & mask) << 21) | ((CellKey)z & mask);
+}
+
+PotentialFieldGrid::CellKey PotentialFieldGrid::cellKey(const base::Vector3d& position) const{
+    return cellKey((int)std::floor(position(0) / cell_size),
+                   (int)std::floor(position(1) / cell_size),
+                   (int)std::floor(position(2) / cell_size));
+}
+
+bool PotentialFieldGrid::isIndexable(const PotentialFieldPtr& field) const{
+    return field->hasLocalSupport() && std::isfinite(field->influence_distance) && field->influence_distance > 0;
+}
+
+void PotentialFieldGrid::insert(uint idx, const PotentialFieldPtr& field){
+    centers[idx] = field->pot_field_center;
+    influence_sq[idx] = field->influence_distance * field->influence_distance;
+    field_cell[idx] = cellKey(centers[idx]);
+    cells[field_cell[idx]].push_back(idx);
+    indexed[idx] = true;
+}
+
+void PotentialFieldGrid::remove(uint idx){
+    std::vector<uint>& cell = cells[field_cell[idx]];
+    auto it = std::find(cell.begin(), cell.end(), idx);
+    if(it != cell.end()){
+        *it = cell.back();
+        cell.pop_back();
+    }
+    if(cell.empty())
+        cells.erase(field_cell[idx]);
+    indexed[idx] = false;
+}
+
+void PotentialFieldGrid::build(const std::vector<PotentialFieldPtr>& fields){
+    clear();
+
+    cell_size = 0;
+    for(const PotentialFieldPtr& f : fields){
+        if(f->dimension != 3)
+            throw std::invalid_argument("PotentialFieldGrid::build: Dimension of field '" + f->name + "' is " + std::to_string(f->dimension) + ", but should be 3");
+        if(isIndexable(f))
+            cell_size = std::max(cell_size, f->influence_distance);
+    }
+    if(cell_size == 0)
+        cell_size = 1;
+
+    centers.resize(fields.size());
+    influence_sq.resize(fields.size());
+    field_cell.resize(fields.size());
+    indexed.assign(fields.size(), false);
+    for(uint i = 0; i < fields.size(); i++){
+        if(isIndexable(fields[i]))
+            insert(i, fields[i]);
+        else
+            unindexed.push_back(i);
+    }
+}
+
+void PotentialFieldGrid::update(const std::vector<PotentialFieldPtr>& fields, uint idx){
+    if(fields.size() != indexed.size())
+        throw std::invalid_argument("PotentialFieldGrid::update: Number of fields has changed, rebuild the grid");
+    if(idx >= fields.size())
+        throw std::out_of_range("PotentialFieldGrid::update: Invalid field index " + std::to_string(idx));
+
+    const PotentialFieldPtr& field = fields[idx];
+    bool indexable = isIndexable(field);
+    if(indexable != indexed[idx] || (indexable && field->influence_distance > cell_size)){
+        build(fields);
+        return;
+    }
+    if(!indexable)
+        return;
+
+    // Most moves are small, so that the field stays in the same cell
+    if(cellKey(field->pot_field_center) == field_cell[idx]){
+        centers[idx] = field->pot_field_center;
+        influence_sq[idx] = field->influence_distance * field->influence_distance;
+        return;
+    }
+    remove(idx);
+    insert(idx, field);
+}
+
+void PotentialFieldGrid::query(const base::Vector3d& position, std::vector<uint>& result) const{
+    result = unindexed;
+
+    int cx = (int)std::floor(position(0) / cell_size);
+    int cy = (int)std::floor(position(1) / cell_size);
+    int cz = (int)std::floor(position(2) / cell_size);
+    for(int x = cx - 1; x <= cx + 1; x++){
+        for(int y = cy - 1; y <= cy + 1; y++){
+            for(int z = cz - 1; z <= cz + 1; z++){
+                auto cell = cells.find(cellKey(x, y, z));
+                if(cell == cells.end())
+                    continue;
+                for(uint idx : cell->second){
+                    if((position - centers[idx]).squaredNorm() <= influence_sq[idx])
+                        result.push_back(idx);
+                }
+            }
+        }
+    }
+}
+
+void PotentialFieldGrid::clear(){
+    cells.clear();
+    field_cell.clear();
+    centers.clear();
+    influence_sq.clear();
+    indexed.clear();
+    unindexed.clear();
+    cell_size = 1;
+}
@@ -0,0 +1,66 @@
+#ifndef POTENTIAL_FIELD_GRID_HPP
+#define POTENTIAL_FIELD_GRID_HPP
+
+#include "PotentialField.hpp"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace ctrl_lib{
+
+/**
+ * @brief Uniform grid over the centers of 3D potential fields, used to find the fields that may have an influence on a given position without evaluating all fields.
+ *  Only fields with local support (see PotentialField::hasLocalSupport()) and finite influence distance are stored in the grid. The cell size is the maximum
+ *  influence distance of these fields, so that all fields that may influence a position are located in the 27 cells around it. All other fields (e.g. planar fields)
+ *  are always returned by query().
+ *
+ *  The grid stores a copy of the field centers and influence distances. If these change, the grid has to be updated using update().
+ */
+class PotentialFieldGrid{
+    typedef uint64_t CellKey;
+
+    std::unordered_map<CellKey, std::vector<uint>> cells;
+    std::vector<CellKey> field_cell;        /** Cell of each indexed field*/
+    std::vector<base::Vector3d> centers;    /** Field centers at the time of insertion*/
+    std::vector<double> influence_sq;       /** Squared influence distances*/
+    std::vector<bool> indexed;              /** True if the field is stored in the grid*/
+    std::vector<uint> unindexed;            /** Fields which are always returned by query()*/
+    double cell_size;
+
+    CellKey cellKey(int x, int y, int z) const;
+    CellKey cellKey(const base::Vector3d& position) const;
+    bool isIndexable(const PotentialFieldPtr& field) const;
+    void insert(uint idx, const PotentialFieldPtr& field);
+    void remove(uint idx);
+
+public:
+    PotentialFieldGrid();
+
+    /** Build the grid from the given fields. All fields must have dimension 3.*/
+    void build(const std::vector<PotentialFieldPtr>& fields);
+
+    /** Update the grid after the center or influence distance of the field with index idx has changed. Rebuilds the grid if the influence distance
+     *  is larger than the cell size.*/
+    void update(const std::vector<PotentialFieldPtr>& fields, uint idx);
+
+    /**
+     * @brief Find all fields that may have an influence on the given position, i.e., all unindexed fields and all indexed fields whose distance
+     *  to the given position is at most their influence distance.
+     * @param position Query position
+     * @param result Indices of the fields. Will be cleared first.
+     */
+    void query(const base::Vector3d& position, std::vector<uint>& result) const;
+
+    /** Clear the grid*/
+    void clear();
+
+    /** Edge length of the grid cells*/
+    double getCellSize() const {return cell_size;}
+
+    /** Number of fields stored in the grid*/
+    size_t getNoOfIndexedFields() const {return indexed.size() - unindexed.size();}
+};
+
+}
+
+#endif
@@ -18,6 +18,7 @@ protected:
 
 public:
     PotentialFieldsController(const uint _dimension);
+    virtual ~PotentialFieldsController(){}
     /**
      * @brief Apply Saturation on the control output. If one or more values of <in> are bigger than the
      *        Corrresponding entry of <max>, all values will be scaled down according to the biggest
@@ -27,11 +28,11 @@ public:
      */
     void applySaturation(const base::VectorXd& in, base::VectorXd &out);
     /** Provide new potential fields. Dimension of each field has to be the same as dimension of the controller. */
-    void setFields(const std::vector<PotentialFieldPtr>& _fields);
+    virtual void setFields(const std::vector<PotentialFieldPtr>& _fields);
     /** Return potential field infos*/
     std::vector<PotentialFieldInfo> getFieldInfos();
     /** Erase all potential fields*/
-    void clearFields(){fields.clear();}
+    virtual void clearFields(){fields.clear();}
     /** Set proportional gain*/
     void setPGain(const base::VectorXd& gain);
     /** Set maximum control output*/
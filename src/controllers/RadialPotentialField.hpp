@@ -26,5 +26,23 @@ public:
      * @return Computed gradient. Size will be same as dimension.
      */
     virtual const base::VectorXd& update(const base::VectorXd& position);
+    /** The gradient is zero outside the influence distance around the field center*/
+    virtual bool hasLocalSupport() const {return true;}
+
+    /**
+     * @brief Gradient factor of radial potential fields, which is a sigmoid function of the normalized distance (influence_distance - d) / influence_distance,
+     *  evaluated for many fields at once. It is 0 for distances d > influence distance and approaches 1 for d -> 0. The gradient is factor * (x - x0) / d.
+     *  Works on arrays of any size, e.g., for 1D fields (see JointLimitAvoidanceController). Does not allocate memory if factor has the correct size.
+     *
+     *  Within the influence distance, the argument of the exponential function is in [-6,6]. For this range, exp(t) is approximated as (p(t/64))^64, where p is the Taylor
+     *  polynomial of degree 6, with a relative error below 1e-9. Unlike Eigen's exp(), which is only vectorized for some instruction sets, this compiles to plain
+     *  vectorized multiplications and additions on all platforms.
+     */
+    static void gradientFactor(const Eigen::ArrayXd& d, const Eigen::ArrayXd& influence_distance, Eigen::ArrayXd& factor){
+        // t/64 = (1 - 2 * (influence_distance - d) / influence_distance) * 6 / 64, clamped to the valid range. Outside the influence distance, the factor is 0 anyway
+        factor = ((2.0 * d - influence_distance) * (6.0 / 64.0) / influence_distance).min(6.0 / 64.0).max(-6.0 / 64.0);
+        factor = 1.0 + factor * (1.0 + factor * (1.0 / 2 + factor * (1.0 / 6 + factor * (1.0 / 24 + factor * (1.0 / 120 + factor * (1.0 / 720))))));
+        factor = (d > influence_distance).select(0.0, 1.0 / (1.0 + factor.square().square().square().square().square().square()));
+    }
 };
 }
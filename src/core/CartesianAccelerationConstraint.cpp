@@ -23,7 +23,7 @@ CartesianAccelerationConstraint::CartesianAccelerationConstraint(ConstraintConfi
 CartesianAccelerationConstraint::~CartesianAccelerationConstraint(){
 }
 
-void CartesianAccelerationConstraint::setReference(const base::samples::RigidBodyStateSE3& ref){
+void CartesianAccelerationConstraint::referenceToRaw(const base::samples::RigidBodyStateSE3& ref, base::VectorXd& raw_ref, base::Time& ref_time) const{
 
     if(!ref.hasValidAcceleration()){
         LOG_ERROR("Constraint %s has invalid linear and/or angular acceleration", config.name.c_str())
@@ -31,11 +31,11 @@ void CartesianAccelerationConstraint::setReference(const base::samples::RigidBod
     }
 
     if(ref.time.isNull())
-        this->time = base::Time::now();
+        ref_time = base::Time::now();
     else
-        this->time = ref.time;
-    this->y_ref.segment(0,3) = ref.acceleration.linear;
-    this->y_ref.segment(3,3) = ref.acceleration.angular;
+        ref_time = ref.time;
+    raw_ref.segment(0,3) = ref.acceleration.linear;
+    raw_ref.segment(3,3) = ref.acceleration.angular;
 }
 
 } // namespace wbc
@@ -18,7 +18,15 @@ public:
     /**
      * @brief Update the Cartesian reference input for this constraint.
      */
-    virtual void setReference(const base::samples::RigidBodyStateSE3& ref) = 0;
+    virtual void setReference(const base::samples::RigidBodyStateSE3& ref){referenceToRaw(ref, y_ref, time);}
+
+    /**
+     * @brief Convert the given Cartesian reference input to the raw reference vector and its time stamp without modifying the constraint. Throws if the reference input is invalid.
+     * @param ref Cartesian reference input
+     * @param raw_ref Raw reference vector. Size has to be same as number of constraint variables.
+     * @param ref_time Time stamp of the reference input. Current time, if the time stamp of ref is null.
+     */
+    virtual void referenceToRaw(const base::samples::RigidBodyStateSE3& ref, base::VectorXd& raw_ref, base::Time& ref_time) const = 0;
 };
 
 } //namespace wbc
@@ -11,7 +11,7 @@ CartesianVelocityConstraint::CartesianVelocityConstraint(ConstraintConfig config
 CartesianVelocityConstraint::~CartesianVelocityConstraint(){
 }
 
-void CartesianVelocityConstraint::setReference(const base::samples::RigidBodyStateSE3& ref){
+void CartesianVelocityConstraint::referenceToRaw(const base::samples::RigidBodyStateSE3& ref, base::VectorXd& raw_ref, base::Time& ref_time) const{
 
     if(!ref.hasValidTwist()){
         LOG_ERROR("Constraint %s has invalid velocity and/or angular velocity", config.name.c_str())
@@ -19,11 +19,11 @@ void CartesianVelocityConstraint::setReference(const base::samples::RigidBodySta
     }
 
     if(ref.time.isNull())
-        this->time = base::Time::now();
+        ref_time = base::Time::now();
     else
-        this->time = ref.time;
-    this->y_ref.segment(0,3) = ref.twist.linear;
-    this->y_ref.segment(3,3) = ref.twist.angular;
+        ref_time = ref.time;
+    raw_ref.segment(0,3) = ref.twist.linear;
+    raw_ref.segment(3,3) = ref.twist.angular;
 }
 
 } // namespace wbc
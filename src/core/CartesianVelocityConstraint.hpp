@@ -14,10 +14,10 @@ public:
     virtual ~CartesianVelocityConstraint();
 
     /**
-     * @brief Update the Cartesian reference input for this constraint.
+     * @brief Convert the Cartesian reference input for this constraint to the raw reference vector (see CartesianConstraint::referenceToRaw())
      * @param ref Reference input for this constraint. Only the velocity part is relevant (Must have a valid linear and angular velocity!)
      */
-    virtual void setReference(const base::samples::RigidBodyStateSE3& ref);
+    virtual void referenceToRaw(const base::samples::RigidBodyStateSE3& ref, base::VectorXd& raw_ref, base::Time& ref_time) const;
 };
 
 typedef std::shared_ptr<CartesianVelocityConstraint> CartesianVelocityConstraintPtr;
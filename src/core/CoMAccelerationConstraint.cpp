@@ -11,7 +11,7 @@ CoMAccelerationConstraint::CoMAccelerationConstraint(ConstraintConfig config, ui
 CoMAccelerationConstraint::~CoMAccelerationConstraint(){
 }
 
-void CoMAccelerationConstraint::setReference(const base::samples::RigidBodyStateSE3& ref){
+void CoMAccelerationConstraint::referenceToRaw(const base::samples::RigidBodyStateSE3& ref, base::VectorXd& raw_ref, base::Time& ref_time) const{
 
     if(!base::isnotnan(ref.acceleration.linear)){
         LOG_ERROR("Constraint %s has invalid linear acceleration", config.name.c_str())
@@ -19,10 +19,10 @@ void CoMAccelerationConstraint::setReference(const base::samples::RigidBodyState
     }
 
     if(ref.time.isNull())
-        this->time = base::Time::now();
+        ref_time = base::Time::now();
     else
-        this->time = ref.time;
-    this->y_ref.segment(0,3) = ref.acceleration.linear;
+        ref_time = ref.time;
+    raw_ref.segment(0,3) = ref.acceleration.linear;
 }
 
 }
@@ -11,7 +11,7 @@ CoMVelocityConstraint::CoMVelocityConstraint(ConstraintConfig config, uint n_rob
 CoMVelocityConstraint::~CoMVelocityConstraint(){
 }
 
-void CoMVelocityConstraint::setReference(const base::samples::RigidBodyStateSE3& ref){
+void CoMVelocityConstraint::referenceToRaw(const base::samples::RigidBodyStateSE3& ref, base::VectorXd& raw_ref, base::Time& ref_time) const{
 
     if(!base::isnotnan(ref.twist.linear)){
         LOG_ERROR("Constraint %s has invalid linear velocity", config.name.c_str())
@@ -19,10 +19,10 @@ void CoMVelocityConstraint::setReference(const base::samples::RigidBodyStateSE3&
     }
 
     if(ref.time.isNull())
-        this->time = base::Time::now();
+        ref_time = base::Time::now();
     else
-        this->time = ref.time;
-    this->y_ref.segment(0,3) = ref.twist.linear;
+        ref_time = ref.time;
+    raw_ref.segment(0,3) = ref.twist.linear;
 }
 
 }
@@ -51,7 +51,7 @@ void Constraint::checkTimeout(){
         timeout = (int)(base::Time::now() - time).toSeconds() > config.timeout;
 }
 
-void Constraint::setWeights(const base::VectorXd& weights){
+void Constraint::checkWeights(const base::VectorXd& weights) const{
     if(config.nVariables() != weights.size()){
         LOG_ERROR("Constraint %s: Size of weight vector should be %i but is %i", config.name.c_str(), config.nVariables(), weights.size())
         throw std::invalid_argument("Invalid constraint weights");
@@ -62,15 +62,22 @@ void Constraint::setWeights(const base::VectorXd& weights){
             LOG_ERROR("Constraint %s: Weight values should be > 0, but weight %i is %f", config.name.c_str(), i, weights(i));
             throw std::invalid_argument("Invalid constraint weights");
         }
-
-    this->weights = weights;
 }
 
-void Constraint::setActivation(const double activation){
+void Constraint::checkActivation(const double activation) const{
     if(activation < 0 || activation > 1){
         LOG_ERROR("Constraint %s: Activation has to be between 0 and 1 but is %f", config.name.c_str(), activation);
         throw std::invalid_argument("Invalid constraint activation");
     }
+}
+
+void Constraint::setWeights(const base::VectorXd& weights){
+    checkWeights(weights);
+    this->weights = weights;
+}
+
+void Constraint::setActivation(const double activation){
+    checkActivation(activation);
     this->activation = activation;
 }
 
@@ -46,6 +46,12 @@ public:
      */
     void setActivation(const double activation);
 
+    /** Throw if the given weights are invalid, see setWeights()*/
+    void checkWeights(const base::VectorXd& weights) const;
+
+    /** Throw if the given activation is invalid, see setActivation()*/
+    void checkActivation(const double activation) const;
+
     /** Last time the constraint reference values was updated.*/
     base::Time time;
 
@@ -0,0 +1,42 @@
+#include "ConstraintsStatusSnapshot.hpp"
+#include <stdexcept>
+
+namespace wbc{
+
+// y = A * x(columns) + b
+static void sparseProduct(const ConstraintsStatusSnapshot::Entry& entry, const base::VectorXd& x, base::VectorXd& y){
+    if(entry.b.size() > 0)
+        y = entry.b;
+    else
+        y.setZero(entry.A.rows());
+    for(uint k = 0; k < entry.columns.size(); k++)
+        y += entry.A.col(k) * x[entry.columns[k]];
+}
+
+void ConstraintsStatusSnapshot::evaluate(ConstraintsStatus& status) const{
+
+    if(status.size() != entries.size())
+        throw std::invalid_argument("ConstraintsStatusSnapshot::evaluate: Status has " + std::to_string(status.size()) +
+                                    " entries, but snapshot has " + std::to_string(entries.size()));
+
+    for(uint i = 0; i < entries.size(); i++){
+        const Entry& entry = entries[i];
+        ConstraintStatus& s = status[i];
+
+        s.time       = entry.time;
+        s.activation = entry.activation;
+        s.timeout    = entry.timeout;
+        if(fields & STATUS_WEIGHTS)
+            s.weights = entry.weights;
+        if(fields & STATUS_Y_REF)
+            s.y_ref = entry.y_ref;
+        if(entry.A.rows() == 0)
+            continue;
+        if(fields & STATUS_Y_SOLUTION)
+            sparseProduct(entry, solver_output, s.y_solution);
+        if(fields & STATUS_Y)
+            sparseProduct(entry, robot_state, s.y);
+    }
+}
+
+}
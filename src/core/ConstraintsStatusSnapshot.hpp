@@ -0,0 +1,58 @@
+#ifndef CONSTRAINTS_STATUS_SNAPSHOT_HPP
+#define CONSTRAINTS_STATUS_SNAPSHOT_HPP
+
+#include "ConstraintStatus.hpp"
+#include <vector>
+
+namespace wbc{
+
+/**
+ * @brief Fields of the constraints status that are computed by WbcScene::updateConstraintsStatus(), see WbcScene::setConstraintsStatusFields().
+ *  Can be combined with bitwise or. Time, activation and timeout are always computed. The constraint configuration is set only once in WbcScene::configure().
+ */
+enum ConstraintStatusField{
+    STATUS_WEIGHTS    = 1,
+    STATUS_Y_REF      = 2,
+    STATUS_Y_SOLUTION = 4,
+    STATUS_Y          = 8,
+    STATUS_ALL        = 15
+};
+
+/**
+ * @brief Copy of all data that is required to compute the constraints status, see WbcScene::snapshotConstraintsStatus(). The snapshot does not refer to
+ *  the scene or the robot model, so that evaluate() can be called in another thread than the control thread.
+ *
+ *  The constraint matrices are stored only for the joints that influence the constraint, e.g., the joints of the kinematic chain of a Cartesian constraint,
+ *  so that y and y_solution are computed from these columns only.
+ */
+class ConstraintsStatusSnapshot{
+public:
+    struct Entry{
+        base::Time time;
+        double activation;
+        int timeout;
+        base::VectorXd weights;
+        base::VectorXd y_ref;
+        std::vector<uint> columns;  /** Joint indices of the columns of A*/
+        base::MatrixXd A;           /** Constraint matrix, reduced to the given columns. Empty if y and y_solution are not available for this constraint*/
+        base::VectorXd b;           /** Offset that is added to y and y_solution, e.g. the spatial acceleration bias. Empty if there is no offset*/
+    };
+
+    uint fields;                    /** Fields to compute, see ConstraintStatusField*/
+    std::vector<Entry> entries;     /** One entry per constraint, in the order of the constraint IDs*/
+    base::VectorXd solver_output;   /** Solver output (joint velocities or accelerations) in the joint order of the robot model*/
+    base::VectorXd robot_state;     /** Actual joint velocities or accelerations in the joint order of the robot model*/
+
+    ConstraintsStatusSnapshot() : fields(STATUS_ALL){}
+
+    /**
+     * @brief Compute the constraints status from the snapshot. Only the given fields are written, all other fields of the status remain unchanged.
+     *  Does not allocate memory if the status has been computed before.
+     * @param status Status with one entry per constraint in the order of the constraint IDs, e.g. a copy of WbcScene::getConstraintsStatus()
+     */
+    void evaluate(ConstraintsStatus& status) const;
+};
+
+}
+
+#endif
@@ -12,7 +12,7 @@ JointAccelerationConstraint::~JointAccelerationConstraint(){
 
 }
 
-void JointAccelerationConstraint::setReference(const base::commands::Joints& ref){
+void JointAccelerationConstraint::referenceToRaw(const base::commands::Joints& ref, base::VectorXd& raw_ref, base::Time& ref_time) const{
 
     if(ref.size() != config.nVariables()){
         LOG_ERROR("Constraint %s: Size of reference input is %i, but should be %i", config.name.c_str(), ref.size(), config.nVariables());
@@ -20,9 +20,9 @@ void JointAccelerationConstraint::setReference(const base::commands::Joints& ref
     }
 
     if(ref.time.isNull())
-        this->time = base::Time::now();
+        ref_time = base::Time::now();
     else
-        this->time = ref.time;
+        ref_time = ref.time;
 
     for(size_t i = 0; i < ref.size(); i++){
         uint idx;
@@ -39,7 +39,7 @@ void JointAccelerationConstraint::setReference(const base::commands::Joints& ref
             throw std::invalid_argument("Invalid constraint reference input");
         }
 
-        this->y_ref(i) = ref[idx].acceleration;
+        raw_ref(i) = ref[idx].acceleration;
     }
 }
 } // namespace wbc
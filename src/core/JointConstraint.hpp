@@ -16,7 +16,15 @@ public:
     /**
      * @brief Update the Joint reference input for this constraint.
      */
-    virtual void setReference(const base::commands::Joints& ref) = 0;
+    virtual void setReference(const base::commands::Joints& ref){referenceToRaw(ref, y_ref, time);}
+
+    /**
+     * @brief Convert the given Joint reference input to the raw reference vector and its time stamp without modifying the constraint. Throws if the reference input is invalid.
+     * @param ref Joint reference input
+     * @param raw_ref Raw reference vector. Size has to be same as number of constraint variables.
+     * @param ref_time Time stamp of the reference input. Current time, if the time stamp of ref is null.
+     */
+    virtual void referenceToRaw(const base::commands::Joints& ref, base::VectorXd& raw_ref, base::Time& ref_time) const = 0;
 
 };
 
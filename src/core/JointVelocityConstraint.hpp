@@ -13,11 +13,11 @@ public:
     virtual ~JointVelocityConstraint();
 
     /**
-     * @brief Update the Joint reference input for this constraint.
+     * @brief Convert the Joint reference input for this constraint to the raw reference vector (see JointConstraint::referenceToRaw())
      * @param ref Joint reference input. Vector size has ot be same number of constraint variables. Joint Names have to match the constraint joint names.
      * Each entry has to have a valid velocity. All other entries will be ignored.
      */
-    virtual void setReference(const base::commands::Joints& ref);
+    virtual void referenceToRaw(const base::commands::Joints& ref, base::VectorXd& raw_ref, base::Time& ref_time) const;
 };
 
 typedef std::shared_ptr<JointVelocityConstraint> JointVelocityConstraintPtr;
@@ -0,0 +1,145 @@
+#include "QPSolver.hpp"
+#include "QuadraticProgram.hpp"
+#include <tools/WorkerPool.hpp>
+#include <stdexcept>
+#include <limits>
+
+namespace wbc{
+
+void SolverStats::reset(){
+    time = base::Time();
+    status = qp_solved;
+    total_time = setup_time = factorization_time = iteration_time = 0;
+    n_iter = n_active_set_changes = 0;
+    primal_residual = dual_residual = std::numeric_limits<double>::quiet_NaN();
+    warm_start = false;
+}
+
+void QPSolver::startSolve(){
+    solve_start = base::Time::now();
+    status = qp_solved;
+    stats.reset();
+    stats.time = solve_start;
+}
+
+double QPSolver::remainingTime() const{
+    return (time_budget - (base::Time::now() - solve_start)).toSeconds();
+}
+
+bool QPSolver::deadlineExceeded() const{
+    return !time_budget.isNull() && base::Time::now() - solve_start > time_budget;
+}
+
+void QPSolver::fallbackSolution(const QuadraticProgram& qp, base::VectorXd& solver_output) const{
+    if(last_solution.size() == qp.nq)
+        solver_output = last_solution;
+    else
+        solver_output.setZero(qp.nq);
+    // NaN bounds are ignored, since comparisons with NaN are always false
+    for(int i = 0; i < qp.nq; i++){
+        if(qp.lower_x.size() == qp.nq && solver_output(i) < qp.lower_x(i))
+            solver_output(i) = qp.lower_x(i);
+        if(qp.upper_x.size() == qp.nq && solver_output(i) > qp.upper_x(i))
+            solver_output(i) = qp.upper_x(i);
+    }
+}
+
+void QPSolver::handleFailure(const QuadraticProgram& qp, QPSolverStatus failure, const std::string& msg, base::VectorXd& solver_output, const base::VectorXd* best_iterate){
+    if(time_budget.isNull())
+        throw std::runtime_error(msg);
+
+    if(best_iterate)
+        solver_output = *best_iterate;
+    else
+        fallbackSolution(qp, solver_output);
+
+    // Don't use the fallback solution as next fallback, i.e., last_solution is not updated
+    solve_time = base::Time::now() - solve_start;
+    n_calls++;
+    if(failure == qp_deadline_exceeded || solve_time > time_budget)
+        n_deadline_misses++;
+    status = stats.status = failure;
+    stats.total_time = solve_time.toSeconds();
+    stats_history.push(stats);
+}
+
+void QPSolver::finishSolve(const base::VectorXd& solver_output){
+    solve_time = base::Time::now() - solve_start;
+    n_calls++;
+    if(!time_budget.isNull() && solve_time > time_budget){
+        n_deadline_misses++;
+        status = qp_solved_late;
+    }
+    last_solution = solver_output;
+    stats.status = status;
+    stats.total_time = solve_time.toSeconds();
+    stats_history.push(stats);
+}
+
+void QPSolver::solveBatch(const std::vector<HierarchicalQP>& hierarchical_qps, std::vector<base::VectorXd>& solver_outputs){
+
+    // All problems must have the same shape
+    for(size_t i = 1; i < hierarchical_qps.size(); i++){
+        const HierarchicalQP& hqp = hierarchical_qps[i];
+        bool same_shape = hqp.size() == hierarchical_qps[0].size();
+        for(size_t prio = 0; same_shape && prio < hqp.size(); prio++)
+            same_shape = hqp[prio].nq == hierarchical_qps[0][prio].nq && hqp[prio].nc == hierarchical_qps[0][prio].nc;
+        if(!same_shape)
+            throw std::invalid_argument("QPSolver::solveBatch: Problem " + std::to_string(i) + " has a different shape than problem 0");
+    }
+
+    solver_outputs.resize(hierarchical_qps.size());
+
+    if(batch_solvers.size() != hierarchical_qps.size()){
+        batch_solvers.clear();
+        for(size_t i = 0; i < hierarchical_qps.size(); i++){
+            QPSolver* solver = createBatchSolver();
+            if(!solver)
+                break;
+            solver->time_budget = time_budget;
+            batch_solvers.push_back(std::shared_ptr<QPSolver>(solver));
+        }
+    }
+
+    // No batch support: Solve sequentially with this instance
+    if(batch_solvers.size() != hierarchical_qps.size()){
+        batch_solvers.clear();
+        for(size_t i = 0; i < hierarchical_qps.size(); i++)
+            solve(hierarchical_qps[i], solver_outputs[i]);
+        return;
+    }
+
+    if(!worker_pool){
+        for(size_t i = 0; i < hierarchical_qps.size(); i++)
+            batch_solvers[i]->solve(hierarchical_qps[i], solver_outputs[i]);
+        return;
+    }
+
+    // Each worker solves a contiguous range of problems. Solver instances and solutions are not shared between workers
+    const size_t n_problems = hierarchical_qps.size();
+    const uint n_workers = worker_pool->size();
+    worker_pool->run([&](uint worker){
+        for(size_t i = worker * n_problems / n_workers; i < (worker + 1) * n_problems / n_workers; i++)
+            batch_solvers[i]->solve(hierarchical_qps[i], solver_outputs[i]);
+    });
+}
+
+std::shared_ptr<QPSolver> QPSolver::getBatchSolver(uint idx){
+    if(idx >= batch_solvers.size())
+        throw std::out_of_range("QPSolver::getBatchSolver: Index " + std::to_string(idx) + " is out of range, number of batch solvers is " + std::to_string(batch_solvers.size()));
+    return batch_solvers[idx];
+}
+
+void QPSolver::setNumberOfThreads(uint n_threads){
+    if(n_threads == 0)
+        throw std::invalid_argument("QPSolver::setNumberOfThreads: Number of threads has to be > 0");
+    worker_pool.reset();
+    if(n_threads > 1)
+        worker_pool = std::make_shared<WorkerPool>(n_threads);
+}
+
+uint QPSolver::getNumberOfThreads(){
+    return worker_pool ? worker_pool->size() : 1;
+}
+
+}
@@ -3,17 +3,76 @@
 
 #include <vector>
 #include <base/Eigen.hpp>
+#include <base/Time.hpp>
 #include <memory>
+#include <string>
+#include "../tools/RingBuffer.hpp"
 
 namespace wbc{
 
 class HierarchicalQP;
+class QuadraticProgram;
+class WorkerPool;
+
+/** Result of the last call to QPSolver::solve()*/
+enum QPSolverStatus{
+    qp_solved = 0,           /** Solution found within the time budget*/
+    qp_solved_late,          /** Solution found, but the time budget has been exceeded (solver can't be interrupted)*/
+    qp_deadline_exceeded,    /** Solver has been interrupted, because the time budget has been exceeded. The output is the best iterate or the fallback solution (see QPSolver::setTimeBudget())*/
+    qp_failed                /** Solver failed. The output is the fallback solution (see QPSolver::setTimeBudget())*/
+};
+
+/** Statistics of a single call to QPSolver::solve(). All times are in seconds. Entries which are not provided by a solver are zero (residuals: NaN).*/
+struct SolverStats{
+    base::Time time;              /** Time stamp at the start of the call*/
+    QPSolverStatus status;        /** Result of the call*/
+    double total_time;            /** Total computation time of the call*/
+    double setup_time;            /** Time for converting the QP into the solver format*/
+    double factorization_time;    /** Time for matrix factorizations, if it can be measured separately from the iterations*/
+    double iteration_time;        /** Time for the solver iterations (including factorizations, if these can't be measured separately)*/
+    uint n_iter;                  /** Number of iterations (active set: working set recalculations, interior point/ADMM: iterations)*/
+    uint n_active_set_changes;    /** Number of changes to the active set (active set solvers only)*/
+    double primal_residual;       /** Maximum constraint violation of the solution*/
+    double dual_residual;         /** Maximum violation of the stationarity condition*/
+    bool warm_start;              /** True if the solver has been warm started successfully from the previous solution*/
+
+    SolverStats(){reset();}
+    void reset();
+};
 
 class QPSolver{
 protected:
     bool configured;
+
+    base::Time time_budget, solve_start, solve_time;
+    QPSolverStatus status;
+    uint n_calls, n_deadline_misses;
+    base::VectorXd last_solution;
+    SolverStats stats;
+    RingBuffer<SolverStats> stats_history;
+    std::shared_ptr<WorkerPool> worker_pool;
+    std::vector<std::shared_ptr<QPSolver>> batch_solvers;
+
+    /** Create a new solver instance with the same settings as this one, which is used to solve one problem of a batch, see solveBatch().
+     *  Returns a null pointer if the solver doesn't support batch solving (default).*/
+    virtual QPSolver* createBatchSolver(){return 0;}
+
+    /** Start the time measurement of a solver call and reset the statistics. Call this at the beginning of solve()*/
+    void startSolve();
+    /** Returns the remaining time of the time budget in seconds. Negative, if the deadline has passed. Only valid if a time budget is set*/
+    double remainingTime() const;
+    /** Returns true if a time budget is set and it has been exceeded*/
+    bool deadlineExceeded() const;
+    /** Write the fallback solution to solver_output: The solution of the last successful call, projected onto the bounds of the given QP (zero if not available)*/
+    void fallbackSolution(const QuadraticProgram& qp, base::VectorXd& solver_output) const;
+    /** Handle a solver failure or an interrupted solver call: Throw an exception with the given message if no time budget is set, otherwise set the status,
+     *  write the fallback solution to solver_output, and finish the solver call. If best_iterate is given, it is used instead of the fallback solution.*/
+    void handleFailure(const QuadraticProgram& qp, QPSolverStatus failure, const std::string& msg, base::VectorXd& solver_output, const base::VectorXd* best_iterate = 0);
+    /** Stop the time measurement of a solver call, update statistics and the statistics history, and store the solution. Call this at the end of solve()*/
+    void finishSolve(const base::VectorXd& solver_output);
+
 public:
-    QPSolver() : configured(false){}
+    QPSolver() : configured(false), status(qp_solved), n_calls(0), n_deadline_misses(0){}
     virtual ~QPSolver(){}
     /**
      * @brief solve Solve the given quadratic program
@@ -22,8 +81,65 @@ public:
      */
     virtual void solve(const HierarchicalQP& hierarchical_qp, base::VectorXd &solver_output) = 0;
 
-    /** @brief reset Enforces reconfiguration at next call to solve() */
-    void reset(){configured=false;}
+    /** @brief reset Enforces reconfiguration at next call to solve() and solveBatch() */
+    void reset(){configured=false; batch_solvers.clear();}
+
+    /**
+     * @brief Solve a batch of independent hierarchical QPs of the same shape, e.g., the QPs of multiple robot instances. Each problem of the batch is solved by its own
+     *  solver instance (see getBatchSolver()), which is kept between calls, so that the problem at index i can be warm started from the solution of the problem at
+     *  index i in the previous call. If parallel solving is enabled (see setNumberOfThreads()), the problems are distributed evenly over the worker threads.
+     *  The batch solvers are created from the settings of this solver on the first call and when the batch size changes. Call reset() to apply changed settings.
+     *  Solvers that don't support batch solving solve the problems sequentially with this instance.
+     *  Note that nothing is shared between the batch solvers: Each instance allocates its own workspace and performs its own setup (e.g., symbolic analysis
+     *  of the problem structure) on its first call, even though all problems have the same shape.
+     * @param hierarchical_qps Problems to solve. All problems must have the same number of priorities, constraints and joints
+     * @param solver_outputs Solutions, same order as hierarchical_qps
+     */
+    virtual void solveBatch(const std::vector<HierarchicalQP>& hierarchical_qps, std::vector<base::VectorXd>& solver_outputs);
+
+    /** Solver instance that solved the problem with the given index in the last call of solveBatch(), e.g., to access its status and statistics.*/
+    std::shared_ptr<QPSolver> getBatchSolver(uint idx);
+
+    /**
+     * @brief Enable parallel solving in solveBatch(). A persistent pool of worker threads is created.
+     * @param n_threads Number of threads including the calling thread. 1 disables parallel solving (default).
+     */
+    void setNumberOfThreads(uint n_threads);
+
+    /** Return the number of threads used in solveBatch()*/
+    uint getNumberOfThreads();
+
+    /**
+     * @brief Set the time budget of a single call to solve(). If the budget is exceeded, solvers that support it are interrupted and return
+     *  their best iterate or the fallback solution, i.e., the solution of the last call projected onto the bounds of the current QP. Solvers that can't
+     *  be interrupted finish the current call and report qp_solved_late. If a budget is set, solve() doesn't throw on solver failures, but returns the fallback solution
+     *  and reports qp_failed, see getStatus(). Errors in the problem description (e.g. wrong matrix sizes) still throw. Default is 0 (no time budget).
+     */
+    void setTimeBudget(const base::Time& budget){time_budget = budget;}
+    /** Return the time budget of a single call to solve(). 0 means no time budget.*/
+    const base::Time& getTimeBudget(){return time_budget;}
+    /** Status of the last call to solve()*/
+    QPSolverStatus getStatus(){return status;}
+    /** Computation time of the last call to solve()*/
+    const base::Time& getSolveTime(){return solve_time;}
+    /** Number of calls to solve() since the last call of resetStatistics()*/
+    uint getNoOfCalls(){return n_calls;}
+    /** Number of calls to solve() which exceeded the time budget since the last call of resetStatistics()*/
+    uint getNoOfDeadlineMisses(){return n_deadline_misses;}
+    /** Reset call and deadline miss counters*/
+    void resetStatistics(){n_calls = n_deadline_misses = 0;}
+    /** Statistics of the last call to solve()*/
+    const SolverStats& getStats(){return stats;}
+    /** Keep the statistics of the last n calls to solve() in a ring buffer. Clears the history. Not thread-safe, call this before solving. Default is 0 (no history).*/
+    void setStatsHistorySize(size_t n){stats_history.resize(n);}
+    /** Size of the statistics history*/
+    size_t getStatsHistorySize(){return stats_history.capacity();}
+    /**
+     * @brief Copy the statistics of the last n calls to solve(), oldest first. This is lock-free and may be called from another thread while the solver is running,
+     *  e.g. to diagnose latency spikes. In this case, fewer than n entries may be returned.
+     * @return Number of entries
+     */
+    size_t getStatsHistory(std::vector<SolverStats>& history, size_t n) const{return stats_history.latest(history, n);}
 };
 
 typedef std::shared_ptr<QPSolver> QPSolverPtr;
@@ -7,6 +7,9 @@
 
 namespace wbc{
 
+/** Row-major dynamic size matrix. Used for the constraint matrix of the quadratic program, so that solvers which expect row-major data (e.g. qpOASES) can access it without copying*/
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor | Eigen::DontAlign> MatrixXdRowMajor;
+
 class JointWeights : public base::NamedVector<double>{
 };
 
@@ -23,13 +26,13 @@ class JointWeights : public base::NamedVector<double>{
  */
 class QuadraticProgram{
 public:
-    base::MatrixXd A;       /** Constraint matrix (nc x nq, where nc = number of constraints, nq = number of joints) */
+    MatrixXdRowMajor A;     /** Constraint matrix (nc x nq, where nc = number of constraints, nq = number of joints), stored in row-major order */
     base::VectorXd g;       /** Gradient vector (nq x 1) */
     base::VectorXd lower_x; /** Lower bound of the solution vector (nq x 1) */
     base::VectorXd upper_x; /** Upper bound of the solution vector (nq x 1) */
     base::VectorXd lower_y; /** Lower bound of the constraint vector (nc x 1) */
     base::VectorXd upper_y; /** Upper bound of the constraint vector (nc x 1) */
-    base::MatrixXd H;       /** Hessian Matrix (nq x nq) */
+    base::MatrixXd H;       /** Hessian Matrix (nq x nq). Symmetric, so that the storage order is irrelevant */
     base::VectorXd Wy;      /** Constraint weights (nc x 1). Default entry is 1. */
     int nc;                 /** Number of constraints for this prio*/
     int nq;                 /** Number of all joints (actuated + unactuated)*/
@@ -0,0 +1,69 @@
+#ifndef WBC_CORE_REFERENCE_CHANNEL_HPP
+#define WBC_CORE_REFERENCE_CHANNEL_HPP
+
+#include "Constraint.hpp"
+#include "../tools/TripleBuffer.hpp"
+
+namespace wbc{
+
+/**
+ * @brief Passes reference values, weights and activation of a single constraint from other threads (e.g. teleoperation or a planner) to the control thread,
+ *  see WbcScene::publishReference(). Reference, weights and activation are passed through separate TripleBuffers, so that neither the writers nor the control
+ *  thread ever block or allocate memory. Each of the three values may be published by a different thread, but each of them must have only one publishing thread.
+ *  apply() only overwrites the constraint members that have actually been published since the last call.
+ */
+class ReferenceChannel{
+    struct Reference{
+        base::VectorXd y_ref;
+        base::Time time;
+    };
+
+    TripleBuffer<Reference> reference;
+    TripleBuffer<base::VectorXd> weights;
+    TripleBuffer<double> activation;
+
+public:
+    /** Create a channel for a constraint with the given number of variables*/
+    ReferenceChannel(uint n_variables){
+        Reference ref;
+        ref.y_ref.setZero(n_variables);
+        reference.init(ref);
+        weights.init(base::VectorXd::Zero(n_variables));
+        activation.init(0);
+    }
+
+    /** Reference writer: Raw reference vector to be filled before calling publishReference()*/
+    base::VectorXd& rawReference(){return reference.writeBuffer().y_ref;}
+    /** Reference writer: Time stamp of the reference to be filled before calling publishReference()*/
+    base::Time& referenceTime(){return reference.writeBuffer().time;}
+    /** Reference writer: Publish rawReference() and referenceTime()*/
+    void publishReference(){
+        reference.publish();
+    }
+    /** Weights writer: Publish constraint weights. Size has to be the number of constraint variables*/
+    void publishWeights(const base::VectorXd& w){
+        weights.writeBuffer() = w;
+        weights.publish();
+    }
+    /** Activation writer: Publish constraint activation*/
+    void publishActivation(const double a){
+        activation.writeBuffer() = a;
+        activation.publish();
+    }
+
+    /** Reader: Copy the values that have been published since the last call to the given constraint*/
+    void apply(Constraint& constraint){
+        if(reference.update()){
+            constraint.y_ref = reference.readBuffer().y_ref;
+            constraint.time = reference.readBuffer().time;
+        }
+        if(weights.update())
+            constraint.weights = weights.readBuffer();
+        if(activation.update())
+            constraint.activation = activation.readBuffer();
+    }
+};
+
+} // namespace wbc
+
+#endif
@@ -2,13 +2,17 @@
 #include <base-logging/Logging.hpp>
 #include "JointConstraint.hpp"
 #include "CartesianConstraint.hpp"
+#include "RobotModelFactory.hpp"
+#include <tools/WorkerPool.hpp>
 
 namespace wbc{
 
 WbcScene::WbcScene(RobotModelPtr robot_model, QPSolverPtr solver) :
     robot_model(robot_model),
     solver(solver),
-    configured(false){
+    configured(false),
+    solver_context(std::make_shared<SolverContext>()),
+    constraints_status_fields(STATUS_ALL){
 }
 
 WbcScene::~WbcScene(){
@@ -23,6 +27,10 @@ void WbcScene::clearConstraints(){
     }
     constraints.clear();
     constraints_status.clear();
+    constraints_by_id.clear();
+    constraint_ids.clear();
+    reference_channels.clear();
+    constraint_columns.clear();
     configured = false;
 }
 
@@ -54,8 +62,13 @@ bool WbcScene::configure(const std::vector<ConstraintConfig> &config){
             ConstraintPtr constraint = constraints[i][j];
             constraints_status.names.push_back(constraint->config.name);
             constraints_status.elements.push_back(ConstraintStatus());
+            constraints_status.elements.back().config = constraint->config;
+            constraint_ids.emplace(constraint->config.name, constraints_by_id.size());
+            constraints_by_id.push_back(constraint);
+            reference_channels.push_back(std::unique_ptr<ReferenceChannel>(new ReferenceChannel(constraint->config.nVariables())));
         }
     }
+    constraint_columns.resize(constraints_by_id.size());
 
     constraints_prio.resize(constraints.size());
     for(uint prio = 0; prio < constraints.size(); prio++)
@@ -96,17 +109,11 @@ bool WbcScene::configure(const std::vector<ConstraintConfig> &config){
 }
 
 void WbcScene::setReference(const std::string& constraint_name, const base::samples::Joints& ref){
-    ConstraintPtr c = getConstraint(constraint_name);
-    if(c->config.type == cart)
-        throw std::runtime_error("Constraint '" + c->config.name + "' has type cart, but you are trying to set a joint space reference");
-    std::static_pointer_cast<JointConstraint>(c)->setReference(ref);
+    setReference(getConstraintId(constraint_name), ref);
 }
 
 void WbcScene::setReference(const std::string& constraint_name, const base::samples::RigidBodyStateSE3& ref){
-    ConstraintPtr c = getConstraint(constraint_name);
-    if(c->config.type == jnt)
-        throw std::runtime_error("Constraint '" + c->config.name + "' has type jnt, but you are trying to set a cartesian reference");
-    std::static_pointer_cast<CartesianConstraint>(getConstraint(constraint_name))->setReference(ref);
+    setReference(getConstraintId(constraint_name), ref);
 }
 
 void WbcScene::setTaskWeights(const std::string& constraint_name, const base::VectorXd &weights){
@@ -117,25 +124,131 @@ void WbcScene::setTaskActivation(const std::string& constraint_name, const doubl
     getConstraint(constraint_name)->setActivation(activation);
 }
 
+void WbcScene::setReference(uint constraint_id, const base::samples::Joints& ref){
+    const ConstraintPtr& c = getConstraint(constraint_id);
+    if(c->config.type == cart)
+        throw std::runtime_error("Constraint '" + c->config.name + "' has type cart, but you are trying to set a joint space reference");
+    std::static_pointer_cast<JointConstraint>(c)->setReference(ref);
+}
+
+void WbcScene::setReference(uint constraint_id, const base::samples::RigidBodyStateSE3& ref){
+    const ConstraintPtr& c = getConstraint(constraint_id);
+    if(c->config.type == jnt)
+        throw std::runtime_error("Constraint '" + c->config.name + "' has type jnt, but you are trying to set a cartesian reference");
+    std::static_pointer_cast<CartesianConstraint>(c)->setReference(ref);
+}
+
+void WbcScene::setTaskWeights(uint constraint_id, const base::VectorXd &weights){
+    getConstraint(constraint_id)->setWeights(weights);
+}
+
+void WbcScene::setTaskActivation(uint constraint_id, const double activation){
+    getConstraint(constraint_id)->setActivation(activation);
+}
+
 ConstraintPtr WbcScene::getConstraint(const std::string& name){
+    return constraints_by_id[getConstraintId(name)];
+}
 
-    for(size_t i = 0; i < constraints.size(); i++){
-        for(size_t j = 0; j < constraints[i].size(); j++){
-            if(constraints[i][j]->config.name == name)
-                return constraints[i][j];
+const ConstraintPtr& WbcScene::getConstraint(uint constraint_id){
+    if(constraint_id >= constraints_by_id.size())
+        throw std::out_of_range("Invalid constraint id: " + std::to_string(constraint_id) + ", number of constraints is " + std::to_string(constraints_by_id.size()));
+    return constraints_by_id[constraint_id];
+}
+
+uint WbcScene::getConstraintId(const std::string& name){
+    auto it = constraint_ids.find(name);
+    if(it == constraint_ids.end())
+        throw std::invalid_argument("Invalid constraint name: " + name);
+    return it->second;
+}
+
+void WbcScene::publishReference(uint constraint_id, const base::samples::Joints& ref){
+    const ConstraintPtr& c = getConstraint(constraint_id);
+    if(c->config.type == cart)
+        throw std::runtime_error("Constraint '" + c->config.name + "' has type cart, but you are trying to set a joint space reference");
+    ReferenceChannel& channel = *reference_channels[constraint_id];
+    static_cast<const JointConstraint&>(*c).referenceToRaw(ref, channel.rawReference(), channel.referenceTime());
+    channel.publishReference();
+}
+
+void WbcScene::publishReference(uint constraint_id, const base::samples::RigidBodyStateSE3& ref){
+    const ConstraintPtr& c = getConstraint(constraint_id);
+    if(c->config.type == jnt)
+        throw std::runtime_error("Constraint '" + c->config.name + "' has type jnt, but you are trying to set a cartesian reference");
+    ReferenceChannel& channel = *reference_channels[constraint_id];
+    static_cast<const CartesianConstraint&>(*c).referenceToRaw(ref, channel.rawReference(), channel.referenceTime());
+    channel.publishReference();
+}
+
+void WbcScene::publishTaskWeights(uint constraint_id, const base::VectorXd &weights){
+    getConstraint(constraint_id)->checkWeights(weights);
+    reference_channels[constraint_id]->publishWeights(weights);
+}
+
+void WbcScene::publishTaskActivation(uint constraint_id, const double activation){
+    getConstraint(constraint_id)->checkActivation(activation);
+    reference_channels[constraint_id]->publishActivation(activation);
+}
+
+void WbcScene::applyReferenceInputs(){
+    for(uint i = 0; i < constraints_by_id.size(); i++)
+        reference_channels[i]->apply(*constraints_by_id[i]);
+}
+
+const base::commands::Joints& WbcScene::solve(const HierarchicalQP& hqp){
+    updateSolverContext(*solver_context);
+    solveWithContext(hqp, *solver_context);
+    return solver_context->joint_cmd;
+}
+
+void WbcScene::updateSolverContext(SolverContext& context){
+    const std::vector<std::string>& names = robot_model->actuatedJointNames();
+    context.joint_names = names;
+    context.joint_idx.resize(names.size());
+    for(uint i = 0; i < names.size(); i++)
+        context.joint_idx[i] = robot_model->jointIndex(names[i]);
+}
+
+const ConstraintsStatus& WbcScene::updateConstraintsStatus(){
+    snapshotConstraintsStatus(status_snapshot);
+    status_snapshot.evaluate(constraints_status);
+    return constraints_status;
+}
+
+void WbcScene::snapshotConstraint(ConstraintsStatusSnapshot& snapshot, uint constraint_id, const base::VectorXd& y_ref, const base::MatrixXd& A){
+
+    const Constraint& constraint = *getConstraint(constraint_id);
+    ConstraintsStatusSnapshot::Entry& entry = snapshot.entries[constraint_id];
+
+    entry.time       = constraint.time;
+    entry.activation = constraint.activation;
+    entry.timeout    = constraint.timeout;
+    if(constraints_status_fields & STATUS_WEIGHTS)
+        entry.weights = constraint.weights;
+    if(constraints_status_fields & STATUS_Y_REF)
+        entry.y_ref = y_ref;
+
+    if(!statusNeedsSolution() || A.size() == 0){
+        entry.A.resize(0, 0);
+        return;
+    }
+
+    std::vector<uint>& columns = constraint_columns[constraint_id];
+    if(columns.empty()){
+        for(uint j = 0; j < A.cols(); j++){
+            if(constraint.config.type == com || !A.col(j).isZero(0))
+                columns.push_back(j);
         }
     }
-    throw std::invalid_argument("Invalid constraint name: " + name);
+    entry.columns = columns;
+    entry.A.resize(A.rows(), columns.size());
+    for(uint k = 0; k < columns.size(); k++)
+        entry.A.col(k) = A.col(columns[k]);
 }
 
 bool WbcScene::hasConstraint(const std::string &name){
-
-    for(size_t i = 0; i < constraints.size(); i++){
-        for(size_t j = 0; j < constraints[i].size(); j++)
-            if(constraints[i][j]->config.name == name)
-                return true;
-    }
-    return false;
+    return constraint_ids.count(name) > 0;
 }
 
 void WbcScene::sortConstraintConfig(const std::vector<ConstraintConfig>& config, std::vector< std::vector<ConstraintConfig> >& sorted_config){
@@ -201,4 +314,58 @@ void WbcScene::setJointWeights(const JointWeights &weights){
         actuated_joint_weights[n] = joint_weights[n];
 }
 
+void WbcScene::setNumberOfThreads(uint n_threads){
+
+    if(n_threads == 0)
+        throw std::invalid_argument("WbcScene::setNumberOfThreads: Number of threads has to be > 0");
+
+    worker_pool.reset();
+    worker_models.clear();
+    if(n_threads == 1)
+        return;
+
+    // Worker 0 is the calling thread, which uses the original robot model
+    const RobotModelConfig& cfg = robot_model->getRobotModelConfig();
+    worker_models.push_back(robot_model);
+    for(uint i = 1; i < n_threads; i++){
+        RobotModelPtr model(RobotModelFactory::createInstance(cfg.type));
+        if(!model->configure(cfg))
+            throw std::runtime_error("WbcScene::setNumberOfThreads: Failed to configure robot model for worker " + std::to_string(i));
+        worker_models.push_back(model);
+    }
+    worker_pool = std::make_shared<WorkerPool>(n_threads);
+}
+
+uint WbcScene::getNumberOfThreads(){
+    return worker_pool ? worker_pool->size() : 1;
+}
+
+void WbcScene::updateWorkerModels(){
+
+    if(!worker_pool)
+        return;
+
+    const base::samples::Joints& joint_state = robot_model->jointState(robot_model->actuatedJointNames());
+    const base::samples::RigidBodyStateSE3& floating_base_state = robot_model->floatingBaseState();
+    worker_pool->run([&](uint worker){
+        if(worker > 0)
+            worker_models[worker]->update(joint_state, floating_base_state);
+    });
+}
+
+void WbcScene::forEachConstraint(uint prio, const std::function<void(uint, RobotModel&)>& fn){
+
+    if(!worker_pool){
+        for(uint i = 0; i < constraints[prio].size(); i++)
+            fn(i, *robot_model);
+        return;
+    }
+
+    uint n_workers = worker_pool->size();
+    worker_pool->run([&](uint worker){
+        for(uint i = worker; i < constraints[prio].size(); i += n_workers)
+            fn(i, *worker_models[worker]);
+    });
+}
+
 } // namespace wbc
@@ -5,9 +5,31 @@
 #include "QuadraticProgram.hpp"
 #include "RobotModel.hpp"
 #include "QPSolver.hpp"
+#include "ReferenceChannel.hpp"
+#include "ConstraintsStatusSnapshot.hpp"
+#include <functional>
+#include <memory>
+#include <unordered_map>
 
 namespace wbc{
 
+class WorkerPool;
+
+/**
+ * @brief Data of one control cycle that is required to solve the QP of a scene and to convert the solution into a joint command, see WbcScene::solveWithContext().
+ *  The data is copied from the scene and the robot model by WbcScene::updateSolverContext(), so that the QP can be solved in another thread while the scene is
+ *  being updated. Scenes that require additional data derive from this class.
+ */
+class SolverContext{
+public:
+    virtual ~SolverContext(){}
+    std::vector<std::string> joint_names;   /** Names of the actuated joints*/
+    std::vector<uint> joint_idx;            /** Indices of the actuated joints in the joint order of the robot model*/
+    base::VectorXd solver_output;           /** Solution of the QP*/
+    base::commands::Joints joint_cmd;       /** Solution as joint command*/
+};
+typedef std::shared_ptr<SolverContext> SolverContextPtr;
+
 /**
  * @brief Base class for all wbc scenes.
  */
@@ -20,20 +42,65 @@ protected:
     HierarchicalQP constraints_prio;
     std::vector<int> n_constraint_variables_per_prio;
     bool configured;
-    base::commands::Joints solver_output_joints;
+    SolverContextPtr solver_context;
     JointWeights joint_weights, actuated_joint_weights;
     std::vector<ConstraintConfig> wbc_config;
+    std::shared_ptr<WorkerPool> worker_pool;
+    std::vector<RobotModelPtr> worker_models;
+    std::vector<ConstraintPtr> constraints_by_id;
+    std::unordered_map<std::string, uint> constraint_ids;
+    std::vector<std::unique_ptr<ReferenceChannel>> reference_channels;
+    uint constraints_status_fields;
+    std::vector< std::vector<uint> > constraint_columns;
+    ConstraintsStatusSnapshot status_snapshot;
 
     /**
      * brief Create a constraint and add it to the WBC scene
      */
     virtual ConstraintPtr createConstraint(const ConstraintConfig &config) = 0;
 
+    /**
+     * @brief Copy the current state of the robot model to the robot models of all workers. Has to be called once per cycle before forEachConstraint(), if
+     *  parallel evaluation is enabled. Does nothing otherwise.
+     */
+    void updateWorkerModels();
+
+    /**
+     * @brief Evaluate the given function for all constraints of the given priority. If parallel evaluation is enabled (see setNumberOfThreads()), the constraints
+     *  are distributed over the workers, each of them using its own robot model. Thus, the function must only write to data that belongs to the given constraint.
+     * @param prio Priority of the constraints
+     * @param fn Function to evaluate. Arguments are the index of the constraint within the priority and the robot model to use.
+     */
+    void forEachConstraint(uint prio, const std::function<void(uint, RobotModel&)>& fn);
+
     /**
      * @brief Delete all constraints and free memory
      */
     void clearConstraints();
 
+    /**
+     * @brief Copy the reference values, weights and activations that have been published from other threads (see publishReference()) to the constraints.
+     *  Has to be called at the beginning of update().
+     */
+    void applyReferenceInputs();
+
+    /**
+     * @brief Store the status data of the given constraint in the snapshot. Only copies the fields given by setConstraintsStatusFields(). The constraint
+     *  matrix is reduced to its non-zero columns, which are determined once after configure(). This assumes that the columns that are zero are
+     *  structurally zero, e.g. columns of joints that are not part of the kinematic chain. For CoM constraints, all columns are used.
+     * @param snapshot Snapshot with one entry per constraint
+     * @param constraint_id ID of the constraint
+     * @param y_ref Reference values to store in the status
+     * @param A Constraint matrix in joint space (one column per robot joint). Pass an empty matrix, if y and y_solution cannot be computed for this constraint.
+     *  An offset of y and y_solution can be set afterwards in the snapshot entry.
+     */
+    void snapshotConstraint(ConstraintsStatusSnapshot& snapshot, uint constraint_id, const base::VectorXd& y_ref, const base::MatrixXd& A = base::MatrixXd());
+
+    /**
+     * @brief True if y or y_solution have to be computed for the constraints status
+     */
+    bool statusNeedsSolution() const {return constraints_status_fields & (STATUS_Y | STATUS_Y_SOLUTION);}
+
 public:
     WbcScene(RobotModelPtr robot_model, QPSolverPtr solver);
     ~WbcScene();
@@ -50,10 +117,30 @@ public:
     virtual const HierarchicalQP& update() = 0;
 
     /**
-     * @brief Solve the given optimization problem
+     * @brief Solve the given optimization problem. Same as updateSolverContext() followed by solveWithContext() with the solver context of the scene
      * @return Solver output as joint command
      */
-    virtual const base::commands::Joints& solve(const HierarchicalQP& hqp) = 0;
+    virtual const base::commands::Joints& solve(const HierarchicalQP& hqp);
+
+    /**
+     * @brief Create an empty solver context, which can be used with updateSolverContext() and solveWithContext()
+     */
+    virtual SolverContextPtr createSolverContext(){return std::make_shared<SolverContext>();}
+
+    /**
+     * @brief Copy the data of the current cycle that is required by solveWithContext() from the scene and the robot model to the given context. Call this in the
+     *  control thread after update().
+     */
+    virtual void updateSolverContext(SolverContext& context);
+
+    /**
+     * @brief Solve the given optimization problem and convert the solution into a joint command, which is stored in the given context. Does not access any data of the
+     *  scene or the robot model that is modified by update(), only the given QP, the context and the solver. Thus, it can be called in another thread concurrently to
+     *  update(). It must not be called concurrently to solve() or another call of solveWithContext(), since the solver is shared.
+     * @param hqp Optimization problem, e.g. a copy of the QP returned by update()
+     * @param context Solver context, which has been updated with updateSolverContext() after update()
+     */
+    virtual void solveWithContext(const HierarchicalQP& hqp, SolverContext& context) = 0;
 
     /**
      * @brief Set reference input for a joint space constraint
@@ -81,11 +168,83 @@ public:
      * @param activation Activation value. Has to be in interval [0.0,1.0]
      */
     void setTaskActivation(const std::string& constraint_name, const double activation);
+
+    /**
+     * @brief Set reference input for a joint space constraint. Same as setReference() with constraint name, but avoids the name lookup
+     * @param constraint_id ID of the constraint, see getConstraintId()
+     * @param ref Joint space reference values
+     */
+    void setReference(uint constraint_id, const base::samples::Joints& ref);
+
+    /**
+     * @brief Set reference input for a cartesian space constraint. Same as setReference() with constraint name, but avoids the name lookup
+     * @param constraint_id ID of the constraint, see getConstraintId()
+     * @param ref Cartesian space reference values
+     */
+    void setReference(uint constraint_id, const base::samples::RigidBodyStateSE3& ref);
+
+    /**
+     * @brief Set Task weights input for a constraint. Same as setTaskWeights() with constraint name, but avoids the name lookup
+     * @param constraint_id ID of the constraint, see getConstraintId()
+     * @param weights Weight vector. Size has to be same as number of constraint variables
+     */
+    void setTaskWeights(uint constraint_id, const base::VectorXd &weights);
+
+    /**
+     * @brief Set Task activation for a constraint. Same as setTaskActivation() with constraint name, but avoids the name lookup
+     * @param constraint_id ID of the constraint, see getConstraintId()
+     * @param activation Activation value. Has to be in interval [0.0,1.0]
+     */
+    void setTaskActivation(uint constraint_id, const double activation);
+
     /**
      * @brief Return a Particular constraint. Throw if the constraint does not exist
      */
     ConstraintPtr getConstraint(const std::string& name);
 
+    /**
+     * @brief Return the constraint with the given ID, see getConstraintId(). Throw if the ID is invalid
+     */
+    const ConstraintPtr& getConstraint(uint constraint_id);
+
+    /**
+     * @brief Return the integer ID of the given constraint, which can be used with the ID overloads of setReference(), setTaskWeights(), setTaskActivation()
+     *  and getConstraint(), as well as with publishReference(), publishTaskWeights() and publishTaskActivation().
+     *  IDs are the indices of the constraints in getConstraintsStatus() and remain valid until the next call of configure(). Throw if the constraint does not exist.
+     */
+    uint getConstraintId(const std::string& name);
+
+    /**
+     * @brief Publish a reference input for a joint space constraint from another thread. In contrast to setReference(), this method may be called concurrently
+     *  to update(): The reference is converted and validated in the calling thread and passed to the control thread without locks or memory allocation.
+     *  The newest published value is copied to the constraint at the beginning of the next update(). There must be only one thread publishing references for a given
+     *  constraint. Weights and activation of the same constraint are passed separately, so publishTaskWeights() and publishTaskActivation() may be called from other threads.
+     * @param constraint_id ID of the constraint, see getConstraintId()
+     * @param ref Joint space reference values
+     */
+    void publishReference(uint constraint_id, const base::samples::Joints& ref);
+
+    /**
+     * @brief Publish a reference input for a Cartesian space constraint from another thread. See publishReference() for joint space constraints for details.
+     * @param constraint_id ID of the constraint, see getConstraintId()
+     * @param ref Cartesian space reference values
+     */
+    void publishReference(uint constraint_id, const base::samples::RigidBodyStateSE3& ref);
+
+    /**
+     * @brief Publish task weights for a constraint from another thread. See publishReference() for details.
+     * @param constraint_id ID of the constraint, see getConstraintId()
+     * @param weights Weight vector. Size has to be same as number of constraint variables
+     */
+    void publishTaskWeights(uint constraint_id, const base::VectorXd &weights);
+
+    /**
+     * @brief Publish task activation for a constraint from another thread. See publishReference() for details.
+     * @param constraint_id ID of the constraint, see getConstraintId()
+     * @param activation Activation value. Has to be in interval [0.0,1.0]
+     */
+    void publishTaskActivation(uint constraint_id, const double activation);
+
     /**
      * @brief True in case the given constraint exists
      */
@@ -107,9 +266,28 @@ public:
     static std::vector<int> getNConstraintVariablesPerPrio(const std::vector<ConstraintConfig> &config);
 
     /**
-     * @brief updateConstraintsStatus Evaluate the fulfillment of the constraints given the current robot state and the solver output
+     * @brief updateConstraintsStatus Evaluate the fulfillment of the constraints given the current robot state and the solver output.
+     *  Only computes the fields given by setConstraintsStatusFields(). Same as snapshotConstraintsStatus() followed by ConstraintsStatusSnapshot::evaluate()
+     */
+    virtual const ConstraintsStatus &updateConstraintsStatus();
+
+    /**
+     * @brief Copy all data that is required to compute the constraints status to the given snapshot. Call this in the control thread after solve().
+     *  The status can then be computed in another thread using ConstraintsStatusSnapshot::evaluate(), e.g., on a copy of getConstraintsStatus().
+     */
+    virtual void snapshotConstraintsStatus(ConstraintsStatusSnapshot& snapshot) = 0;
+
+    /**
+     * @brief Select the fields of the constraints status that are computed by updateConstraintsStatus(), see ConstraintStatusField. Default is STATUS_ALL.
+     *  Fields that are not selected keep their previous values. Use the constraint IDs (see getConstraintId()), which are the indices in the status vector,
+     *  to access the constraint configuration via getConstraint().
      */
-    virtual const ConstraintsStatus &updateConstraintsStatus() = 0;
+    void setConstraintsStatusFields(uint fields){constraints_status_fields = fields;}
+
+    /**
+     * @brief Return the fields of the constraints status that are computed by updateConstraintsStatus()
+     */
+    uint getConstraintsStatusFields(){return constraints_status_fields;}
 
     /**
      * @brief Return constraints sorted by priority for the solver
@@ -119,7 +297,7 @@ public:
     /**
      * @brief Get current solver output
      */
-    const base::commands::Joints& getSolverOutput(){return solver_output_joints;}
+    const base::commands::Joints& getSolverOutput(){return solver_context->joint_cmd;}
 
     /**
      * @brief set Joint weights by given name
@@ -147,6 +325,19 @@ public:
     QPSolverPtr getSolver(){return solver;}
 
     std::vector<ConstraintConfig> getWbcConfig(){return wbc_config;}
+
+    /**
+     * @brief Enable parallel evaluation of the constraints in update(). A persistent pool of worker threads is created, each of them using its own copy of
+     *  the robot model, which is created from the configuration of the current robot model. The robot model has to be configured before calling this method.
+     *  Parallel evaluation pays off only for a larger number of (Cartesian) constraints.
+     * @param n_threads Number of threads including the calling thread. 1 disables parallel evaluation (default).
+     */
+    void setNumberOfThreads(uint n_threads);
+
+    /**
+     * @brief Return the number of threads used in update()
+     */
+    uint getNumberOfThreads();
 };
 
 typedef std::shared_ptr<WbcScene> WbcScenePtr;
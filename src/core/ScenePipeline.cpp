@@ -0,0 +1,119 @@
+#include "ScenePipeline.hpp"
+#include <stdexcept>
+
+namespace wbc{
+
+ScenePipeline::ScenePipeline(WbcScenePtr scene) :
+    scene(scene),
+    solver_state(IDLE),
+    solve_idx(0),
+    write_idx(0),
+    pipelined(true),
+    solve_pending(false),
+    has_result(false){
+
+    if(!scene)
+        throw std::invalid_argument("ScenePipeline: Invalid scene pointer");
+    for(uint i = 0; i < 2; i++)
+        solver_context[i] = scene->createSolverContext();
+    if(sem_init(&solver_wakeup, 0, 0) != 0)
+        throw std::runtime_error("ScenePipeline: Failed to create semaphore");
+    solver_thread = std::thread(&ScenePipeline::solverLoop, this);
+}
+
+ScenePipeline::~ScenePipeline(){
+    while(solver_state.load(std::memory_order_acquire) == SOLVE)
+        std::this_thread::yield();
+    solver_state.store(STOP, std::memory_order_release);
+    sem_post(&solver_wakeup);
+    solver_thread.join();
+    sem_destroy(&solver_wakeup);
+}
+
+void ScenePipeline::solverLoop(){
+
+    while(true){
+        // Sleep until there is something to do. sem_wait() may be interrupted by a signal
+        if(sem_wait(&solver_wakeup) != 0)
+            continue;
+        int state = solver_state.load(std::memory_order_acquire);
+        if(state == STOP)
+            return;
+        if(state != SOLVE)
+            continue;
+
+        // The buffers of solve_idx are not touched by the calling thread until the solver state is IDLE again
+        uint idx = solve_idx.load(std::memory_order_relaxed);
+        solver_error = nullptr;
+        try{
+            scene->solveWithContext(hqp[idx], *solver_context[idx]);
+        }
+        catch(...){
+            solver_error = std::current_exception();
+        }
+        solver_state.store(IDLE, std::memory_order_release);
+    }
+}
+
+void ScenePipeline::startSolver(uint idx){
+    solve_idx.store(idx, std::memory_order_relaxed);
+    solver_state.store(SOLVE, std::memory_order_release);
+    solve_pending = true;
+    sem_post(&solver_wakeup);
+}
+
+void ScenePipeline::waitForSolver(){
+    while(solver_state.load(std::memory_order_acquire) == SOLVE)
+        std::this_thread::yield();
+    solve_pending = false;
+
+    if(solver_error){
+        std::exception_ptr e = solver_error;
+        solver_error = nullptr;
+        has_result = false;
+        std::rethrow_exception(e);
+    }
+}
+
+void ScenePipeline::setPipelined(bool enable){
+    if(solve_pending)
+        waitForSolver();
+    // The last result of the pipeline is outdated now
+    has_result = false;
+    pipelined = enable;
+}
+
+const base::commands::Joints& ScenePipeline::step(){
+
+    if(!pipelined){
+        const HierarchicalQP& qp = scene->update();
+        const base::commands::Joints& output = scene->solve(qp);
+        latency = base::Time::now() - qp.time;
+        return output;
+    }
+
+    // Set up the QP of this cycle, while the solver thread is still working on its copy of the QP of the previous cycle
+    hqp[write_idx] = scene->update();
+    scene->updateSolverContext(*solver_context[write_idx]);
+
+    if(solve_pending)
+        waitForSolver();
+    else if(!has_result){
+        // Pipeline is empty: There is no previous solution, so solve the current QP directly
+        startSolver(write_idx);
+        waitForSolver();
+        has_result = true;
+        latency = base::Time::now() - hqp[write_idx].time;
+        write_idx = 1 - write_idx;
+        return solver_context[solve_idx]->joint_cmd;
+    }
+
+    // Result of the previous cycle is in solver_context[solve_idx]. Start solving the current QP and return the previous result
+    uint result_idx = solve_idx;
+    startSolver(write_idx);
+    write_idx = 1 - write_idx;
+    latency = base::Time::now() - hqp[result_idx].time;
+    return solver_context[result_idx]->joint_cmd;
+}
+
+} // namespace wbc
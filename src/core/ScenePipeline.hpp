@@ -0,0 +1,98 @@
+#ifndef SCENE_PIPELINE_HPP
+#define SCENE_PIPELINE_HPP
+
+#include "Scene.hpp"
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <semaphore.h>
+
+namespace wbc{
+
+/**
+ * @brief Runs update() and solve() of a WBC scene in a two-stage pipeline: While the QP of cycle k is being solved in a separate solver thread,
+ *  the calling thread already sets up the QP of cycle k+1. The solver thread works on a copy of the QP and of the data that is required to convert the solution
+ *  into a joint command (see WbcScene::updateSolverContext()), so that it does not access the scene or the robot model while they are being updated.
+ *  QPs and solver contexts are double buffered.
+ *
+ * The handoff between the calling thread and the solver thread is lock-free: The slot to be solved and the solver state are passed through atomics, so that
+ * step() never blocks on a lock that is held by the solver thread (no priority inversion). If the solution of the previous cycle is not available yet, step()
+ * busy-waits for it, yielding the processor in between. The solver thread sleeps on a semaphore while there is nothing to solve, which step() posts without
+ * blocking. In a real-time setup, run the solver thread on a different core than the control thread, since a high-priority control thread that busy-waits on the
+ * same core would starve it.
+ *
+ * This increases the achievable control frequency to roughly 1/max(t_update, t_solve) instead of 1/(t_update + t_solve), at the cost of one cycle of
+ * additional latency: The output returned by step() is the solution of the QP that has been set up in the previous call of step(). Use getLatency() and
+ * getLatencyCycles() to evaluate this trade-off. If minimum latency is more important than throughput, disable pipelining with setPipelined(false),
+ * in which case step() just calls update() and solve() sequentially.
+ *
+ * Note: While pipelining is enabled, the solver of the scene is used by the solver thread. Do not call solve() or updateConstraintsStatus() of the scene
+ * directly in this case.
+ */
+class ScenePipeline{
+protected:
+    enum SolverState{IDLE, SOLVE, STOP};
+
+    WbcScenePtr scene;
+    HierarchicalQP hqp[2];
+    SolverContextPtr solver_context[2];
+    std::thread solver_thread;
+    sem_t solver_wakeup;                    /** Posted by the calling thread whenever solver_state changes from IDLE*/
+    std::atomic<int> solver_state;          /** SolverState. Set to SOLVE/STOP by the calling thread, back to IDLE by the solver thread*/
+    std::atomic<uint> solve_idx;            /** Slot that is solved by the solver thread*/
+    std::exception_ptr solver_error;        /** Written by the solver thread before it sets solver_state to IDLE*/
+    uint write_idx;
+    bool pipelined, solve_pending, has_result;
+    base::Time latency;
+
+    void solverLoop();
+    /** Hand the given slot over to the solver thread. Never blocks*/
+    void startSolver(uint idx);
+    /** Busy-wait until the solver thread has finished. Rethrows an exception of the solver*/
+    void waitForSolver();
+
+public:
+    /**
+     * @brief Create the pipeline and start the solver thread
+     * @param scene Configured WBC scene
+     */
+    ScenePipeline(WbcScenePtr scene);
+    ~ScenePipeline();
+
+    /**
+     * @brief Execute one control cycle. Call this after updating the robot model. Sets up the QP for the current cycle and returns the solver output.
+     *  If pipelining is enabled, the returned solver output belongs to the QP of the previous cycle (except for the first call, where the current
+     *  QP is solved directly, as there is no previous one).
+     * @return Solver output, valid until the next call of step()
+     */
+    const base::commands::Joints& step();
+
+    /**
+     * @brief Enable/disable pipelining. Default is true. Switching waits for an ongoing solve to be finished.
+     */
+    void setPipelined(bool enable);
+
+    /**
+     * @brief Returns true if pipelining is enabled
+     */
+    bool isPipelined(){return pipelined;}
+
+    /**
+     * @brief Number of control cycles between setting up a QP and returning its solution: 1 if pipelining is enabled, 0 otherwise
+     */
+    uint getLatencyCycles(){return pipelined ? 1 : 0;}
+
+    /**
+     * @brief Time between setting up the QP and returning its solution in the last call of step(). Includes the additional cycle if pipelining is enabled.
+     */
+    const base::Time& getLatency(){return latency;}
+
+    /**
+     * @brief Return the WBC scene
+     */
+    WbcScenePtr getScene(){return scene;}
+};
+
+} // namespace wbc
+
+#endif
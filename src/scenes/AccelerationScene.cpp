@@ -4,6 +4,7 @@
 #include "../core/JointAccelerationConstraint.hpp"
 #include "../core/CartesianAccelerationConstraint.hpp"
 #include "../core/CoMAccelerationConstraint.hpp"
+#include "../tools/SE3Tools.hpp"
 
 namespace wbc{
 
@@ -26,13 +27,13 @@ const HierarchicalQP& AccelerationScene::update(){
     if(!configured)
         throw std::runtime_error("AccelerationScene has not been configured!. PLease call configure() before calling update() for the first time!");
 
+    applyReferenceInputs();
+
     if(constraints.size() != 1){
         LOG_ERROR("Number of priorities in AccelerationScene should be 1, but is %i", constraints.size());
         throw std::runtime_error("Invalid constraint configuration");
     }
 
-    base::samples::RigidBodyStateSE3 ref_frame;
-
     // Create equation system
     //    Walk through all priorities and update the optimization problem. The outcome will be
     //    A - Vector of constraint matrices. One matrix for each priority
@@ -63,15 +64,12 @@ const HierarchicalQP& AccelerationScene::update(){
             // Convert input acceleration from the reference frame of the constraint to the base frame of the robot. We transform only the orientation of the
             // reference frame to which the twist is expressed, NOT the position. This means that the center of rotation for a Cartesian constraint will
             // be the origin of ref frame, not the root frame. This is more intuitive when controlling the orientation of e.g. a robot' s end effector.
-            ref_frame = robot_model->rigidBodyState(constraint->config.root, constraint->config.ref_frame);
-            constraint->y_ref_root.segment(0,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->y_ref.segment(0,3);
-            constraint->y_ref_root.segment(3,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->y_ref.segment(3,3);
+            const Eigen::Matrix3d rot = robot_model->rigidBodyState(constraint->config.root, constraint->config.ref_frame).pose.orientation.toRotationMatrix();
+            rotateVector6(rot, constraint->y_ref, constraint->y_ref_root);
 
             // Also convert the weight vector from ref frame to the root frame. Take the absolute values after rotation, since weights can only
             // assume positive values
-            constraint->weights_root.segment(0,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->weights.segment(0,3);
-            constraint->weights_root.segment(3,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->weights.segment(3,3);
-            constraint->weights_root = constraint->weights_root.cwiseAbs();
+            rotateWeights6(rot, constraint->weights, constraint->weights_root);
 
         }
         else if(type == com){
@@ -119,7 +117,7 @@ const HierarchicalQP& AccelerationScene::update(){
 
         row_index += n_vars;
     }
-    const base::MatrixXd& A = constraints_prio[prio].A;
+    const MatrixXdRowMajor& A = constraints_prio[prio].A;
     const base::VectorXd& y = constraints_prio[prio].lower_y;
 
     // Cost Function: x^T*H*x + x^T * g
@@ -137,55 +135,53 @@ const HierarchicalQP& AccelerationScene::update(){
     return constraints_prio;
 }
 
-const base::commands::Joints& AccelerationScene::solve(const HierarchicalQP& hqp){
+void AccelerationScene::solveWithContext(const HierarchicalQP& hqp, SolverContext& context){
 
     // solve
+    base::VectorXd& solver_output = context.solver_output;
     solver_output.resize(hqp[0].nq);
     solver->solve(hqp, solver_output);
 
     // Convert Output
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
-    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
-        const std::string& name = robot_model->actuatedJointNames()[i];
-        uint idx = robot_model->jointIndex(name);
+    base::commands::Joints& cmd = context.joint_cmd;
+    cmd.resize(context.joint_names.size());
+    cmd.names = context.joint_names;
+    for(uint i = 0; i < context.joint_names.size(); i++){
+        uint idx = context.joint_idx[i];
         if(base::isNaN(solver_output[idx]))
-            throw std::runtime_error("Solver output (acceleration) for joint " + name + " is NaN");
-        solver_output_joints[name].acceleration = solver_output[idx];
+            throw std::runtime_error("Solver output (acceleration) for joint " + context.joint_names[i] + " is NaN");
+        cmd[i].acceleration = solver_output[idx];
     }
-    solver_output_joints.time = base::Time::now();
-    return solver_output_joints;
+    cmd.time = base::Time::now();
 }
 
-const ConstraintsStatus &AccelerationScene::updateConstraintsStatus(){
-
-    robot_acc.resize(robot_model->noOfJoints());
-    uint nj = robot_model->noOfJoints();
-    const base::samples::Joints &joint_state = robot_model->jointState(robot_model->jointNames());
-    for(size_t i = 0; i < nj; i++)
-        robot_acc(i) = joint_state[i].acceleration;
-
-    for(uint prio = 0; prio < constraints.size(); prio++){
-        for(uint i = 0; i < constraints[prio].size(); i++){
-            ConstraintPtr constraint = constraints[prio][i];
-            const std::string &name = constraint->config.name;
-
-            constraints_status[name].time       = constraint->time;
-            constraints_status[name].config     = constraint->config;
-            constraints_status[name].activation = constraint->activation;
-            constraints_status[name].timeout    = constraint->timeout;
-            constraints_status[name].weights    = constraint->weights;
-            constraints_status[name].y_ref      = constraint->y_ref_root;
-            if(constraint->config.type == cart){
-                const base::MatrixXd &jac = robot_model->spaceJacobian(constraint->config.root, constraint->config.tip);
-                const base::Acceleration &bias_acc = robot_model->spatialAccelerationBias(constraint->config.root, constraint->config.tip);
-                constraints_status[name].y_solution = jac * solver_output + bias_acc;
-                constraints_status[name].y          = jac * robot_acc + bias_acc;
-            }
-        }
+void AccelerationScene::snapshotConstraintsStatus(ConstraintsStatusSnapshot& snapshot){
+
+    snapshot.fields = constraints_status_fields;
+    snapshot.entries.resize(constraints_by_id.size());
+    if(constraints_status_fields & STATUS_Y_SOLUTION)
+        snapshot.solver_output = solver_context->solver_output;
+    if(constraints_status_fields & STATUS_Y){
+        uint nj = robot_model->noOfJoints();
+        const base::samples::Joints &joint_state = robot_model->jointState(robot_model->jointNames());
+        snapshot.robot_state.resize(nj);
+        for(size_t i = 0; i < nj; i++)
+            snapshot.robot_state(i) = joint_state[i].acceleration;
     }
 
-    return constraints_status;
+    for(uint id = 0; id < constraints_by_id.size(); id++){
+        const ConstraintPtr& constraint = constraints_by_id[id];
+        if(constraint->config.type == cart && statusNeedsSolution()){
+            const base::MatrixXd &jac = robot_model->spaceJacobian(constraint->config.root, constraint->config.tip);
+            const base::Acceleration &bias_acc = robot_model->spatialAccelerationBias(constraint->config.root, constraint->config.tip);
+            snapshotConstraint(snapshot, id, constraint->y_ref_root, jac);
+            base::VectorXd& b = snapshot.entries[id].b;
+            b.resize(6);
+            b << bias_acc.linear, bias_acc.angular;
+        }
+        else
+            snapshotConstraint(snapshot, id, constraint->y_ref_root);
+    }
 }
 
 } // namespace wbc
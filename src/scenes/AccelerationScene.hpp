@@ -26,7 +26,6 @@ namespace wbc{
  */
 class AccelerationScene : public WbcScene{
 protected:
-    base::VectorXd solver_output, robot_acc;
 
     /**
      * brief Create a constraint and add it to the WBC scene
@@ -47,15 +46,15 @@ public:
     virtual const HierarchicalQP& update();
 
     /**
-     * @brief Solve the given optimization problem
-     * @return Solver output as joint acceleration command
+     * @brief Solve the given optimization problem and convert the solution into a joint acceleration command, see WbcScene::solveWithContext()
      */
-    virtual const base::commands::Joints& solve(const HierarchicalQP& hqp);
+    virtual void solveWithContext(const HierarchicalQP& hqp, SolverContext& context);
 
     /**
-     * @brief evaluateConstraints Evaluate the fulfillment of the constraints given the current robot state and the solver output
+     * @brief Copy the data required to evaluate the fulfillment of the constraints given the current robot state and the solver output, see updateConstraintsStatus().
+     *  y and y_solution are only computed for Cartesian constraints
      */
-    virtual const ConstraintsStatus &updateConstraintsStatus();
+    virtual void snapshotConstraintsStatus(ConstraintsStatusSnapshot& snapshot);
 };
 
 } // namespace wbc
@@ -0,0 +1,159 @@
+#include "AccelerationSceneReduced.hpp"
+#include "core/RobotModel.hpp"
+#include <base-logging/Logging.hpp>
+
+namespace wbc {
+
+AccelerationSceneReduced::AccelerationSceneReduced(RobotModelPtr robot_model, QPSolverPtr solver) :
+    AccelerationSceneTSID(robot_model,solver){
+    solver_context = createSolverContext();
+}
+
+void AccelerationSceneReduced::computeContactNullSpace(){
+
+    uint nj = robot_model->noOfJoints();
+    const ActiveContacts& contact_points = robot_model->getActiveContacts();
+    uint ncp = contact_points.size();
+
+    // No contacts: Whole joint space is feasible
+    if(ncp == 0){
+        null_space_basis.setIdentity(nj,nj);
+        acc_particular.setZero(nj);
+        return;
+    }
+
+    // Stacked contact constraints: Jc*qdd = -Jcdot*qd
+    contact_jac.resize(6*ncp, nj);
+    contact_acc.resize(6*ncp);
+    for(uint i = 0; i < ncp; i++){
+        contact_jac.block(i*6, 0, 6, nj) = robot_model->spaceJacobian(robot_model->worldFrame(), contact_points.names[i]);
+        const base::Acceleration& a = robot_model->spatialAccelerationBias(robot_model->worldFrame(), contact_points.names[i]);
+        contact_acc.segment(i*6,3) = -a.linear;
+        contact_acc.segment(i*6+3,3) = -a.angular;
+    }
+
+    // Rank revealing QR of Jc^T: Jc^T*P = Q*R. The last nj-r columns of Q span the null space of Jc
+    qr.compute(contact_jac.transpose());
+    uint r = qr.rank();
+    q_mat = qr.householderQ();
+    null_space_basis = q_mat.rightCols(nj-r);
+
+    // Particular solution: Jc = P*R^T*Q^T, so Jc*qdd = b is fulfilled by qdd_p = Q_1*w with R_11^T*w = (P^T*b)_1..r
+    contact_acc_perm = qr.colsPermutation().transpose() * contact_acc;
+    acc_particular = q_mat.leftCols(r) *
+            qr.matrixR().topLeftCorner(r,r).triangularView<Eigen::Upper>().transpose().solve(contact_acc_perm.head(r));
+}
+
+const HierarchicalQP& AccelerationSceneReduced::update(){
+
+    if(!configured)
+        throw std::runtime_error("AccelerationSceneReduced has not been configured!. PLease call configure() before calling update() for the first time!");
+
+    applyReferenceInputs();
+
+    if(constraints.size() != 1){
+        LOG_ERROR("Number of priorities in AccelerationSceneReduced should be 1, but is %i", (int)constraints.size());
+        throw std::runtime_error("Invalid constraint configuration");
+    }
+
+    if(formulation != tsid_full)
+        throw std::runtime_error("AccelerationSceneReduced does not support the formulation " + std::to_string(formulation));
+
+    int prio = 0; // Only one priority is implemented here!
+    uint nj = robot_model->noOfJoints();
+    uint na = robot_model->noOfActuatedJoints();
+    const ActiveContacts& contact_points = robot_model->getActiveContacts();
+    uint ncp = contact_points.size();
+
+    computeContactNullSpace();
+    uint nu = null_space_basis.cols();
+
+    // QP Size: (NJoints x NNullSpace+NActuatedJoints+NContacts*6)
+    // Variable order: (null space acc,torque,f_ext)
+    // The number of variables follows the rank of the contact Jacobian. If it changes, the solver cannot be warm started from the previous QP
+    QuadraticProgram& qp = constraints_prio[prio];
+    if(qp.nq != (int)(nu+na+ncp*6))
+        solver->reset();
+    qp.resize(nj,nu+na+ncp*6);
+    qp.H.setZero();
+    qp.g.setZero();
+
+    ///////// Tasks
+
+    // Evaluate all tasks. Each task writes only to its own data, so that the tasks can be evaluated in parallel
+    updateWorkerModels();
+    forEachConstraint(prio, [&](uint i, RobotModel& model){
+        updateConstraint(constraints[prio][i], model);
+    });
+
+    // Accumulate the cost function in joint space and project it to the null space: qdd = qdd_p + Z*u
+    hessian_full.setZero(nj,nj);
+    gradient_full.setZero(nj);
+    for(uint i = 0; i < constraints[prio].size(); i++){
+        ConstraintPtr constraint = constraints[prio][i];
+        hessian_full += constraint->Aw.transpose()*constraint->Aw;
+        gradient_full -= constraint->Aw.transpose()*constraint->y_ref_root;
+    }
+    gradient_full += hessian_full * acc_particular;
+    null_space_hessian.noalias() = hessian_full * null_space_basis;
+    qp.H.block(0,0,nu,nu).noalias() = null_space_basis.transpose() * null_space_hessian;
+    qp.H.block(0,0,nu,nu).diagonal().array() += hessian_regularizer;
+    qp.g.segment(0,nu).noalias() = null_space_basis.transpose() * gradient_full;
+
+    ///////// Constraints
+
+    // 1. M*Z*u - S^T*tau - Jb_1^T*f_ext_1 - Jb_2^T*f_ext_2 - ... = -h - M*qdd_p (Rigid Body Dynamic Equation)
+    //    The rigid contact constraints are fulfilled by construction
+
+    const base::MatrixXd& M = robot_model->jointSpaceInertiaMatrix();
+    qp.A.setZero();
+    qp.A.block(0,  0, nj, nu).noalias() = M * null_space_basis;
+    qp.A.block(0, nu, nj, na) = -robot_model->selectionMatrix().transpose();
+    for(uint i = 0; i < ncp; i++)
+        qp.A.block(0, nu+na+i*6, nj, 6) = -robot_model->bodyJacobian(robot_model->worldFrame(), contact_points.names[i]).transpose();
+    qp.lower_y = -robot_model->biasForces() - M * acc_particular;
+    qp.upper_y = qp.lower_y;
+
+    // 2. Torque limits. Acceleration limits are applied to the null space accelerations
+
+    qp.upper_x.setConstant(10000);
+    qp.lower_x.setConstant(-10000);
+    for(uint i = 0; i < na; i++){
+        const std::string& name = robot_model->actuatedJointNames()[i];
+        qp.lower_x(i+nu) = robot_model->jointLimits()[name].min.effort;
+        qp.upper_x(i+nu) = robot_model->jointLimits()[name].max.effort;
+    }
+
+    constraints_prio.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
+    constraints_prio.time = base::Time::now();
+    return constraints_prio;
+}
+
+void AccelerationSceneReduced::updateSolverContext(SolverContext& context){
+    AccelerationSceneTSID::updateSolverContext(context);
+    ReducedSolverContext& ctx = static_cast<ReducedSolverContext&>(context);
+    ctx.null_space_basis = null_space_basis;
+    ctx.acc_particular = acc_particular;
+}
+
+void AccelerationSceneReduced::solveWithContext(const HierarchicalQP& hqp, SolverContext& context){
+
+    ReducedSolverContext& ctx = static_cast<ReducedSolverContext&>(context);
+
+    // solve
+    ctx.solver_output_reduced.resize(hqp[0].nq);
+    solver->solve(hqp, ctx.solver_output_reduced);
+
+    // Recover the joint accelerations from the null space accelerations. Torques and contact wrenches remain unchanged
+    uint nj = ctx.nj;
+    uint nu = ctx.null_space_basis.cols();
+    uint n_rest = hqp[0].nq - nu;
+    ctx.solver_output.resize(nj + n_rest);
+    ctx.solver_output.segment(0,nj) = ctx.acc_particular;
+    ctx.solver_output.segment(0,nj).noalias() += ctx.null_space_basis * ctx.solver_output_reduced.segment(0,nu);
+    ctx.solver_output.segment(nj,n_rest) = ctx.solver_output_reduced.segment(nu,n_rest);
+
+    convertSolverOutput(hqp, ctx);
+}
+
+}
@@ -0,0 +1,83 @@
+#ifndef WBCACCELERATIONSCENEREDUCED_HPP
+#define WBCACCELERATIONSCENEREDUCED_HPP
+
+#include "AccelerationSceneTSID.hpp"
+#include <Eigen/QR>
+
+namespace wbc{
+
+/**
+ * @brief Solver context of AccelerationSceneReduced, see WbcScene::solveWithContext()
+ */
+class ReducedSolverContext : public TSIDSolverContext{
+public:
+    base::MatrixXd null_space_basis;        /** Basis of the contact null space*/
+    base::VectorXd acc_particular;          /** Particular solution of the contact constraints*/
+    base::VectorXd solver_output_reduced;   /** Solution of the reduced QP*/
+};
+
+/**
+ * @brief Acceleration-based implementation of the WBC Scene, which solves the same problem as AccelerationSceneTSID, but with reduced dimension:
+ *  The rigid contact constraints \f$\mathbf{J}_c\ddot{\mathbf{q}} = -\dot{\mathbf{J}}_c\dot{\mathbf{q}}\f$ are not passed to the solver, but eliminated by parameterizing
+ *  the joint accelerations in the null space of the stacked contact Jacobian:
+ *  \f[
+ *        \ddot{\mathbf{q}} = \ddot{\mathbf{q}}_p + \mathbf{Z}\mathbf{u}
+ *  \f]
+ * \f$\ddot{\mathbf{q}}_p\f$ - Particular solution of the contact constraints<br>
+ * \f$\mathbf{Z}\f$ - Basis of the null space of \f$\mathbf{J}_c\f$<br>
+ * \f$\mathbf{u}\f$ - Null space accelerations, replace \f$\ddot{\mathbf{q}}\f$ as optimization variables<br>
+ *
+ * Both \f$\ddot{\mathbf{q}}_p\f$ and \f$\mathbf{Z}\f$ are computed once per cycle from a rank-revealing QR decomposition of \f$\mathbf{J}_c^T\f$.
+ * The QP has nj-r+na+6*nc variables (r = rank of the contact Jacobian) and only the nj rows of the rigid body dynamics as constraints, compared to nj+na+6*nc
+ * variables and nj+6*nc constraints in AccelerationSceneTSID. Since r is the numerical rank of the contact Jacobian in the current cycle, the number of QP
+ * variables can change between cycles, e.g., close to a singular contact configuration. In this case, the solver is reset and initialized from scratch. The task API is the same as for AccelerationSceneTSID. Only the QP formulation
+ * tsid_full is supported (see AccelerationSceneTSID::setFormulation()).
+ *
+ * Note that the joint acceleration limits of AccelerationSceneTSID (+/-10000) are applied to \f$\mathbf{u}\f$ instead of \f$\ddot{\mathbf{q}}\f$ here.
+ */
+class AccelerationSceneReduced : public AccelerationSceneTSID{
+protected:
+    base::MatrixXd contact_jac, q_mat, null_space_basis, hessian_full, null_space_hessian;
+    base::VectorXd contact_acc, contact_acc_perm, acc_particular, gradient_full;
+    Eigen::ColPivHouseholderQR<base::MatrixXd> qr;
+
+    /**
+     * @brief Compute particular solution and null space basis of the contact constraints
+     */
+    void computeContactNullSpace();
+
+public:
+    AccelerationSceneReduced(RobotModelPtr robot_model, QPSolverPtr solver);
+    virtual ~AccelerationSceneReduced(){
+    }
+
+    /**
+     * @brief Update the wbc scene and return the (updated) optimization problem
+     */
+    virtual const HierarchicalQP& update();
+
+    /**
+     * @brief Create an empty solver context, see WbcScene::solveWithContext()
+     */
+    virtual SolverContextPtr createSolverContext(){return std::make_shared<ReducedSolverContext>();}
+
+    /**
+     * @brief Copy the data of AccelerationSceneTSID::updateSolverContext(), the contact null space basis and the particular solution to the given context
+     */
+    virtual void updateSolverContext(SolverContext& context);
+
+    /**
+     * @brief Solve the given optimization problem, recover the joint accelerations from the null space accelerations and convert the solution,
+     *  see WbcScene::solveWithContext()
+     */
+    virtual void solveWithContext(const HierarchicalQP& hqp, SolverContext& context);
+
+    /**
+     * @brief Return the current basis of the contact null space (nj x nj-r, where r is the rank of the contact Jacobian)
+     */
+    const base::MatrixXd& getNullSpaceBasis(){return null_space_basis;}
+};
+
+} // namespace wbc
+
+#endif
@@ -4,13 +4,24 @@
 #include "../core/JointAccelerationConstraint.hpp"
 #include "../core/CartesianAccelerationConstraint.hpp"
 #include "../core/CoMAccelerationConstraint.hpp"
+#include "../tools/SE3Tools.hpp"
 
 namespace wbc {
 
 AccelerationSceneTSID::AccelerationSceneTSID(RobotModelPtr robot_model, QPSolverPtr solver) :
     WbcScene(robot_model,solver),
-    hessian_regularizer(1e-8){
+    hessian_regularizer(1e-8),
+    formulation(tsid_full){
+    solver_context = createSolverContext();
+}
 
+void AccelerationSceneTSID::setFormulation(const TSIDFormulation f){
+    if(f != tsid_full && f != tsid_torque_eliminated)
+        throw std::invalid_argument("AccelerationSceneTSID::setFormulation: Invalid formulation: " + std::to_string(f));
+    // The size of the QP changes, so the solver has to be reconfigured
+    if(f != formulation)
+        solver->reset();
+    formulation = f;
 }
 
 ConstraintPtr AccelerationSceneTSID::createConstraint(const ConstraintConfig &config){
@@ -27,11 +38,133 @@ ConstraintPtr AccelerationSceneTSID::createConstraint(const ConstraintConfig &co
     }
 }
 
+void AccelerationSceneTSID::updateConstraint(ConstraintPtr constraint, RobotModel& model){
+
+    int type = constraint->config.type;
+    constraint->checkTimeout();
+
+    if(type == cart){
+        // Task Jacobian
+        constraint->A = model.spaceJacobian(constraint->config.root, constraint->config.tip);
+
+         // Desired task space acceleration: y_r = y_d - Jdot*qdot
+        constraint->y_ref = constraint->y_ref - model.spatialAccelerationBias(constraint->config.root, constraint->config.tip);
+
+        // Convert input acceleration from the reference frame of the constraint to the base frame of the robot. We transform only the orientation of the
+        // reference frame to which the twist is expressed, NOT the position. This means that the center of rotation for a Cartesian constraint will
+        // be the origin of ref frame, not the root frame. This is more intuitive when controlling the orientation of e.g. a robot' s end effector.
+        const Eigen::Matrix3d rot = model.rigidBodyState(constraint->config.root, constraint->config.ref_frame).pose.orientation.toRotationMatrix();
+        rotateVector6(rot, constraint->y_ref, constraint->y_ref_root);
+
+        // Also convert the weight vector from ref frame to the root frame. Take the absolute values after rotation, since weights can only
+        // assume positive values
+        rotateWeights6(rot, constraint->weights, constraint->weights_root);
+    }
+    else if(type == com){
+        constraint->A = model.comJacobian();
+        // Desired task space acceleration: y_r = y_d - Jdot*qdot
+        constraint->y_ref = constraint->y_ref - model.spatialAccelerationBias(model.worldFrame(), model.baseFrame()).linear;
+        // CoM tasks are always in world/base frame, no need to transform.
+        constraint->y_ref_root = constraint->y_ref;
+        constraint->weights_root = constraint->weights;
+    }
+    else if(type == jnt){
+        // Joint space constraints: constraint matrix has only ones and Zeros. The joint order in the constraints might be different than in the robot model.
+        // Thus, for joint space constraints, the joint indices have to be mapped correctly.
+        for(uint k = 0; k < constraint->config.joint_names.size(); k++){
+
+            int idx = model.jointIndex(constraint->config.joint_names[k]);
+            constraint->A(k,idx) = 1.0;
+            constraint->y_ref_root = constraint->y_ref;     // In joint space y_ref is equal to y_ref_root
+            constraint->weights_root = constraint->weights; // Same for the weights
+        }
+    }
+    else{
+        LOG_ERROR("Constraint %s: Invalid type: %i", constraint->config.name.c_str(), type);
+        throw std::invalid_argument("Invalid constraint configuration");
+    }
+
+    // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
+    // task phases and we don't want to store the "old" reference value, in case we switch on the constraint again
+    if(constraint->activation == 0){
+       constraint->y_ref.setZero();
+       constraint->y_ref_root.setZero();
+    }
+
+    for(int i = 0; i < constraint->A.rows(); i++)
+        constraint->Aw.row(i) = constraint->weights_root(i) * constraint->A.row(i) * constraint->activation * (!constraint->timeout);
+    for(int i = 0; i < constraint->A.cols(); i++)
+        constraint->Aw.col(i) = joint_weights[i] * constraint->Aw.col(i);
+}
+
+void AccelerationSceneTSID::setupTorqueEliminatedConstraints(QuadraticProgram& qp){
+
+    uint nj = robot_model->noOfJoints();
+    uint na = robot_model->noOfActuatedJoints();
+    const ActiveContacts& contact_points = robot_model->getActiveContacts();
+    uint ncp = contact_points.size();
+
+    // Split the joints into unactuated (e.g. floating base) and actuated joints
+    unactuated_idx.clear();
+    for(uint i = 0; i < nj; i++){
+        if(!robot_model->hasActuatedJoint(robot_model->jointNames()[i]))
+            unactuated_idx.push_back(i);
+    }
+    actuated_idx.resize(na);
+    for(uint i = 0; i < na; i++)
+        actuated_idx[i] = robot_model->jointIndex(robot_model->actuatedJointNames()[i]);
+
+    // Full rows of the rigid body dynamics without torques: [M -Jc^T] * [qdd f_ext]^T = S^T*tau - h
+    const base::MatrixXd& M = robot_model->jointSpaceInertiaMatrix();
+    const base::VectorXd& h = robot_model->biasForces();
+    dynamics_mat.resize(nj, nj+ncp*6);
+    dynamics_mat.block(0,0,nj,nj) = M;
+    for(uint i = 0; i < ncp; i++)
+        dynamics_mat.block(0, nj+i*6, nj, 6) = -robot_model->bodyJacobian(robot_model->worldFrame(), contact_points.names[i]).transpose();
+
+    // 1. Unactuated rows of the rigid body dynamics: M_u*qdd - Jc_u^T*f_ext = -h_u
+    uint row = 0;
+    for(uint idx : unactuated_idx){
+        qp.A.row(row) = dynamics_mat.row(idx);
+        qp.lower_y(row) = qp.upper_y(row) = -h(idx);
+        row++;
+    }
+
+    // 2. For all contacts: Js*qdd = -Jsdot*qd (Rigid Contacts, contact points do not move!)
+    for(uint i = 0; i < ncp; i++){
+        qp.A.block(row, 0, 6, nj) = robot_model->spaceJacobian(robot_model->worldFrame(), contact_points.names[i]);
+        const base::Acceleration& a = robot_model->spatialAccelerationBias(robot_model->worldFrame(), contact_points.names[i]);
+        qp.lower_y.segment(row,3) = qp.upper_y.segment(row,3) = -a.linear;
+        qp.lower_y.segment(row+3,3) = qp.upper_y.segment(row+3,3) = -a.angular;
+        row += 6;
+    }
+
+    // 3. Actuated rows of the rigid body dynamics replace the torques: tau = M_a*qdd - Jc_a^T*f_ext + h_a. Torque limits become
+    //    inequality constraints: tau_min - h_a <= M_a*qdd - Jc_a^T*f_ext <= tau_max - h_a
+    tau_bias.resize(na);
+    const base::JointLimits& limits = robot_model->jointLimits();
+    for(uint i = 0; i < na; i++){
+        uint idx = actuated_idx[i];
+        const std::string& name = robot_model->actuatedJointNames()[i];
+        tau_bias(i) = h(idx);
+        qp.A.row(row) = dynamics_mat.row(idx);
+        qp.lower_y(row) = limits[name].min.effort - h(idx);
+        qp.upper_y(row) = limits[name].max.effort - h(idx);
+        row++;
+    }
+
+    // 4. Acceleration and contact force limits
+    qp.upper_x.setConstant(10000);
+    qp.lower_x.setConstant(-10000);
+}
+
 const HierarchicalQP& AccelerationSceneTSID::update(){
 
     if(!configured)
         throw std::runtime_error("AccelerationSceneTSID has not been configured!. PLease call configure() before calling update() for the first time!");
 
+    applyReferenceInputs();
+
     if(constraints.size() != 1){
         LOG_ERROR("Number of priorities in AccelerationSceneTSID should be 1, but is %i", constraints.size());
         throw std::runtime_error("Invalid constraint configuration");
@@ -42,82 +175,24 @@ const HierarchicalQP& AccelerationSceneTSID::update(){
     uint na = robot_model->noOfActuatedJoints();
     uint ncp = robot_model->getActiveContacts().size();
 
-    // QP Size: (NJoints+NContacts*2*6 x NJoints+NActuatedJoints+NContacts*6)
-    // Variable order: (acc,torque,f_ext)
-    constraints_prio[prio].resize(nj+ncp*6,nj+na+ncp*6);
+    // QP Size: (NJoints+NContacts*6 x NJoints+NActuatedJoints+NContacts*6)
+    // Variable order: (acc,torque,f_ext). If the torques are eliminated: (acc,f_ext)
+    uint nt = (formulation == tsid_torque_eliminated) ? 0 : na;
+    constraints_prio[prio].resize(nj+ncp*6,nj+nt+ncp*6);
     constraints_prio[prio].H.setZero();
     constraints_prio[prio].g.setZero();
 
     ///////// Tasks
 
-    // Walk through all tasks
-    for(uint i = 0; i < constraints[prio].size(); i++){
-
-        int type = constraints[prio][i]->config.type;
-        constraints[prio][i]->checkTimeout();
-        ConstraintPtr constraint;
-
-        if(type == cart){
-            constraint = std::static_pointer_cast<CartesianAccelerationConstraint>(constraints[prio][i]);
-
-            // Task Jacobian
-            constraint->A = robot_model->spaceJacobian(constraint->config.root, constraint->config.tip);
-
-             // Desired task space acceleration: y_r = y_d - Jdot*qdot
-            constraint->y_ref = constraint->y_ref - robot_model->spatialAccelerationBias(constraint->config.root, constraint->config.tip);
-
-            // Convert input acceleration from the reference frame of the constraint to the base frame of the robot. We transform only the orientation of the
-            // reference frame to which the twist is expressed, NOT the position. This means that the center of rotation for a Cartesian constraint will
-            // be the origin of ref frame, not the root frame. This is more intuitive when controlling the orientation of e.g. a robot' s end effector.
-            base::samples::RigidBodyStateSE3 ref_frame = robot_model->rigidBodyState(constraint->config.root, constraint->config.ref_frame);
-            constraint->y_ref_root.segment(0,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->y_ref.segment(0,3);
-            constraint->y_ref_root.segment(3,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->y_ref.segment(3,3);
-
-            // Also convert the weight vector from ref frame to the root frame. Take the absolute values after rotation, since weights can only
-            // assume positive values
-            constraint->weights_root.segment(0,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->weights.segment(0,3);
-            constraint->weights_root.segment(3,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->weights.segment(3,3);
-            constraint->weights_root = constraint->weights_root.cwiseAbs();
-        }
-        else if(type == com){
-            constraint = std::static_pointer_cast<CoMAccelerationConstraint>(constraints[prio][i]);
-            constraint->A = robot_model->comJacobian();
-            // Desired task space acceleration: y_r = y_d - Jdot*qdot
-            constraint->y_ref = constraint->y_ref - robot_model->spatialAccelerationBias(robot_model->worldFrame(), robot_model->baseFrame()).linear;
-            // CoM tasks are always in world/base frame, no need to transform.
-            constraint->y_ref_root = constraint->y_ref;
-            constraint->weights_root = constraint->weights;
-        }
-        else if(type == jnt){
-            constraint = std::static_pointer_cast<JointAccelerationConstraint>(constraints[prio][i]);
-
-            // Joint space constraints: constraint matrix has only ones and Zeros. The joint order in the constraints might be different than in the robot model.
-            // Thus, for joint space constraints, the joint indices have to be mapped correctly.
-            for(uint k = 0; k < constraint->config.joint_names.size(); k++){
-
-                int idx = robot_model->jointIndex(constraint->config.joint_names[k]);
-                constraint->A(k,idx) = 1.0;
-                constraint->y_ref_root = constraint->y_ref;     // In joint space y_ref is equal to y_ref_root
-                constraint->weights_root = constraint->weights; // Same for the weights
-            }
-        }
-        else{
-            LOG_ERROR("Constraint %s: Invalid type: %i", constraints[prio][i]->config.name.c_str(), type);
-            throw std::invalid_argument("Invalid constraint configuration");
-        }
-
-        // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
-        // task phases and we don't want to store the "old" reference value, in case we switch on the constraint again
-        if(constraint->activation == 0){
-           constraint->y_ref.setZero();
-           constraint->y_ref_root.setZero();
-        }
-
-        for(int i = 0; i < constraint->A.rows(); i++)
-            constraint->Aw.row(i) = constraint->weights_root(i) * constraint->A.row(i) * constraint->activation * (!constraint->timeout);
-        for(int i = 0; i < constraint->A.cols(); i++)
-            constraint->Aw.col(i) = joint_weights[i] * constraint->Aw.col(i);
+    // Evaluate all tasks. Each task writes only to its own data, so that the tasks can be evaluated in parallel
+    updateWorkerModels();
+    forEachConstraint(prio, [&](uint i, RobotModel& model){
+        updateConstraint(constraints[prio][i], model);
+    });
 
+    // Walk through all tasks and accumulate the cost function
+    for(uint i = 0; i < constraints[prio].size(); i++){
+        ConstraintPtr constraint = constraints[prio][i];
         constraints_prio[prio].H.block(0,0,nj,nj) += constraint->Aw.transpose()*constraint->Aw;
         constraints_prio[prio].g.segment(0,nj) -= constraint->Aw.transpose()*constraint->y_ref_root;
     }
@@ -132,34 +207,39 @@ const HierarchicalQP& AccelerationSceneTSID::update(){
     constraints_prio[prio].upper_y.setZero();
 
 
-    // 1. M*qdd - S^T*tau - Jb_1^T*f_ext_1 - Jb_2^T*f_ext_2 - ... = -h (Rigid Body Dynamic Equation)
+    if(formulation == tsid_torque_eliminated)
+        setupTorqueEliminatedConstraints(constraints_prio[prio]);
+    else{
+        ActiveContacts contact_points = robot_model->getActiveContacts();
 
-    ActiveContacts contact_points = robot_model->getActiveContacts();
-    constraints_prio[prio].A.block(0,  0, nj, nj) =  robot_model->jointSpaceInertiaMatrix();
-    constraints_prio[prio].A.block(0, nj, nj, na) = -robot_model->selectionMatrix().transpose();
-    for(int i = 0; i < contact_points.size(); i++)
-        constraints_prio[prio].A.block(0, nj+na+i*6, nj, 6) = -robot_model->bodyJacobian(robot_model->worldFrame(), contact_points.names[i]).transpose();
-    constraints_prio[prio].lower_y.segment(0,nj) = constraints_prio[prio].upper_y.segment(0,nj) = -robot_model->biasForces();// + robot_model->bodyJacobian(world_link, contact_link).transpose() * f_ext;
+        // 1. M*qdd - S^T*tau - Jb_1^T*f_ext_1 - Jb_2^T*f_ext_2 - ... = -h (Rigid Body Dynamic Equation)
 
-    // 2. For all contacts: Js*qdd = -Jsdot*qd (Rigid Contacts, contact points do not move!)
+        constraints_prio[prio].A.block(0,  0, nj, nj) =  robot_model->jointSpaceInertiaMatrix();
+        constraints_prio[prio].A.block(0, nj, nj, na) = -robot_model->selectionMatrix().transpose();
+        for(int i = 0; i < contact_points.size(); i++)
+            constraints_prio[prio].A.block(0, nj+na+i*6, nj, 6) = -robot_model->bodyJacobian(robot_model->worldFrame(), contact_points.names[i]).transpose();
+        constraints_prio[prio].lower_y.segment(0,nj) = constraints_prio[prio].upper_y.segment(0,nj) = -robot_model->biasForces();// + robot_model->bodyJacobian(world_link, contact_link).transpose() * f_ext;
 
-    for(int i = 0; i < contact_points.size(); i++){
-        constraints_prio[prio].A.block(nj+i*6,  0, 6, nj) = robot_model->spaceJacobian(robot_model->worldFrame(), contact_points.names[i]);
-        base::Vector6d acc;
-        base::Acceleration a = robot_model->spatialAccelerationBias(robot_model->worldFrame(), contact_points.names[i]);
-        acc.segment(0,3) = a.linear;
-        acc.segment(3,3) = a.angular;
-        constraints_prio[prio].lower_y.segment(nj+i*6,6) = constraints_prio[prio].upper_y.segment(nj+i*6,6) = -acc;
-    }
+        // 2. For all contacts: Js*qdd = -Jsdot*qd (Rigid Contacts, contact points do not move!)
 
-    // 3. Torque and acceleration limits
+        for(int i = 0; i < contact_points.size(); i++){
+            constraints_prio[prio].A.block(nj+i*6,  0, 6, nj) = robot_model->spaceJacobian(robot_model->worldFrame(), contact_points.names[i]);
+            base::Vector6d acc;
+            base::Acceleration a = robot_model->spatialAccelerationBias(robot_model->worldFrame(), contact_points.names[i]);
+            acc.segment(0,3) = a.linear;
+            acc.segment(3,3) = a.angular;
+            constraints_prio[prio].lower_y.segment(nj+i*6,6) = constraints_prio[prio].upper_y.segment(nj+i*6,6) = -acc;
+        }
 
-    constraints_prio[prio].upper_x.setConstant(10000);
-    constraints_prio[prio].lower_x.setConstant(-10000);
-    for(int i = 0; i < robot_model->noOfActuatedJoints(); i++){
-        const std::string& name = robot_model->actuatedJointNames()[i];
-        constraints_prio[prio].lower_x(i+nj) = robot_model->jointLimits()[name].min.effort;
-        constraints_prio[prio].upper_x(i+nj) = robot_model->jointLimits()[name].max.effort;
+        // 3. Torque and acceleration limits
+
+        constraints_prio[prio].upper_x.setConstant(10000);
+        constraints_prio[prio].lower_x.setConstant(-10000);
+        for(int i = 0; i < robot_model->noOfActuatedJoints(); i++){
+            const std::string& name = robot_model->actuatedJointNames()[i];
+            constraints_prio[prio].lower_x(i+nj) = robot_model->jointLimits()[name].min.effort;
+            constraints_prio[prio].upper_x(i+nj) = robot_model->jointLimits()[name].max.effort;
+        }
     }
 
     constraints_prio.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
@@ -167,75 +247,90 @@ const HierarchicalQP& AccelerationSceneTSID::update(){
     return constraints_prio;
 }
 
-const base::commands::Joints& AccelerationSceneTSID::solve(const HierarchicalQP& hqp){
+void AccelerationSceneTSID::updateSolverContext(SolverContext& context){
+    WbcScene::updateSolverContext(context);
+    TSIDSolverContext& ctx = static_cast<TSIDSolverContext&>(context);
+    ctx.nj = robot_model->noOfJoints();
+    ctx.formulation = formulation;
+    if(formulation == tsid_torque_eliminated)
+        ctx.tau_bias = tau_bias;
+    ctx.contact_names = robot_model->getActiveContacts().names;
+}
+
+void AccelerationSceneTSID::solveWithContext(const HierarchicalQP& hqp, SolverContext& context){
 
     // solve
-    solver_output.resize(hqp[0].nq);
-    solver->solve(hqp, solver_output);
+    context.solver_output.resize(hqp[0].nq);
+    solver->solve(hqp, context.solver_output);
+
+    convertSolverOutput(hqp, static_cast<TSIDSolverContext&>(context));
+}
+
+void AccelerationSceneTSID::convertSolverOutput(const HierarchicalQP& hqp, TSIDSolverContext& context){
 
     // Convert solver output: Acceleration and torque
-    uint nj = robot_model->noOfJoints();
-    uint na = robot_model->noOfActuatedJoints();
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
-    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
-        const std::string& name = robot_model->actuatedJointNames()[i];
-        uint idx = robot_model->jointIndex(name);
+    const base::VectorXd& solver_output = context.solver_output;
+    base::commands::Joints& cmd = context.joint_cmd;
+    uint nj = context.nj;
+    uint na = context.joint_names.size();
+    cmd.resize(na);
+    cmd.names = context.joint_names;
+    // For tsid_torque_eliminated, the torques are not part of the solution, but recovered from the actuated rows of the rigid body dynamics,
+    // which are the last na rows of the constraint matrix
+    bool torque_eliminated = context.formulation == tsid_torque_eliminated;
+    uint nt = torque_eliminated ? 0 : na;
+    const QuadraticProgram& qp = hqp[0];
+    for(uint i = 0; i < na; i++){
+        uint idx = context.joint_idx[i];
+        double effort = torque_eliminated ? qp.A.row(qp.nc-na+i).dot(solver_output) + context.tau_bias[i] : solver_output[idx+nj];
         if(base::isNaN(solver_output[idx]))
-            throw std::runtime_error("Solver output (acceleration) for joint " + name + " is NaN");
-        if(base::isNaN(solver_output[idx+nj]))
-            throw std::runtime_error("Solver output (force/torque) for joint " + name + " is NaN");
-        solver_output_joints[name].acceleration = solver_output[idx];
-        solver_output_joints[name].effort = solver_output[idx+nj];
+            throw std::runtime_error("Solver output (acceleration) for joint " + context.joint_names[i] + " is NaN");
+        if(base::isNaN(effort))
+            throw std::runtime_error("Solver output (force/torque) for joint " + context.joint_names[i] + " is NaN");
+        cmd[i].acceleration = solver_output[idx];
+        cmd[i].effort = effort;
     }
-    solver_output_joints.time = base::Time::now();
-
-    /*std::cout<<"Acc:   "<<solver_output.segment(0,nj).transpose()<<std::endl;
-    std::cout<<"Tau:   "<<solver_output.segment(nj,na).transpose()<<std::endl;
-    std::cout<<"F_ext: "<<solver_output.segment(nj+na,12).transpose()<<std::endl<<std::endl;*/
+    cmd.time = base::Time::now();
 
     // Convert solver output: contact wrenches
-    contact_wrenches.resize(robot_model->getActiveContacts().size());
-    contact_wrenches.names = robot_model->getActiveContacts().names;
-    for(uint i = 0; i < robot_model->getActiveContacts().size(); i++){
-        contact_wrenches[i].force = solver_output.segment(nj+na+i*6,3);
-        contact_wrenches[i].torque = solver_output.segment(nj+na+i*6+3,3);
+    base::samples::Wrenches& contact_wrenches = context.contact_wrenches;
+    contact_wrenches.resize(context.contact_names.size());
+    contact_wrenches.names = context.contact_names;
+    for(uint i = 0; i < context.contact_names.size(); i++){
+        contact_wrenches[i].force = solver_output.segment(nj+nt+i*6,3);
+        contact_wrenches[i].torque = solver_output.segment(nj+nt+i*6+3,3);
     }
 
     contact_wrenches.time = base::Time::now();
-    return solver_output_joints;
 }
 
-const ConstraintsStatus& AccelerationSceneTSID::updateConstraintsStatus(){
+void AccelerationSceneTSID::snapshotConstraintsStatus(ConstraintsStatusSnapshot& snapshot){
+
+    snapshot.fields = constraints_status_fields;
+    snapshot.entries.resize(constraints_by_id.size());
+    if(constraints_status_fields & STATUS_Y_SOLUTION)
+        snapshot.solver_output = solver_context->solver_output.segment(0,robot_model->noOfJoints());
+    if(constraints_status_fields & STATUS_Y){
+        uint nj = robot_model->noOfJoints();
+        const base::samples::Joints &joint_state = robot_model->jointState(robot_model->jointNames());
+        snapshot.robot_state.resize(nj);
+        for(size_t i = 0; i < nj; i++)
+            snapshot.robot_state(i) = joint_state[i].acceleration;
+    }
 
-    uint nj = robot_model->noOfJoints();
-    solver_output_acc = solver_output.segment(0,nj);
-    const base::samples::Joints& joint_state = robot_model->jointState(robot_model->jointNames());
-    robot_acc.resize(nj);
-    for(size_t i = 0; i < nj; i++)
-        robot_acc(i) = joint_state[i].acceleration;
-
-    for(uint prio = 0; prio < constraints.size(); prio++){
-        for(uint i = 0; i < constraints[prio].size(); i++){
-            ConstraintPtr constraint = constraints[prio][i];
-            const std::string &name = constraint->config.name;
-
-            constraints_status[name].time       = constraint->time;
-            constraints_status[name].config     = constraint->config;
-            constraints_status[name].activation = constraint->activation;
-            constraints_status[name].timeout    = constraint->timeout;
-            constraints_status[name].weights    = constraint->weights;
-            constraints_status[name].y_ref      = constraint->y_ref_root;
-            if(constraint->config.type == cart){
-                const base::MatrixXd &jac = robot_model->spaceJacobian(constraint->config.root, constraint->config.tip);
-                const base::Acceleration &bias_acc = robot_model->spatialAccelerationBias(constraint->config.root, constraint->config.tip);
-                constraints_status[name].y_solution = jac * solver_output_acc + bias_acc;
-                constraints_status[name].y          = jac * robot_acc + bias_acc;
-            }
+    for(uint id = 0; id < constraints_by_id.size(); id++){
+        const ConstraintPtr& constraint = constraints_by_id[id];
+        if(constraint->config.type == cart && statusNeedsSolution()){
+            const base::MatrixXd &jac = robot_model->spaceJacobian(constraint->config.root, constraint->config.tip);
+            const base::Acceleration &bias_acc = robot_model->spatialAccelerationBias(constraint->config.root, constraint->config.tip);
+            snapshotConstraint(snapshot, id, constraint->y_ref_root, jac);
+            base::VectorXd& b = snapshot.entries[id].b;
+            b.resize(6);
+            b << bias_acc.linear, bias_acc.angular;
         }
+        else
+            snapshotConstraint(snapshot, id, constraint->y_ref_root);
     }
-
-    return constraints_status;
 }
 
 }
@@ -6,6 +6,29 @@
 
 namespace wbc{
 
+/**
+ * @brief Formulation of the QP in AccelerationSceneTSID.
+ *  tsid_full: Optimization variables are joint accelerations, joint torques and contact wrenches.
+ *  tsid_torque_eliminated: The torques are eliminated using the actuated rows of the rigid body dynamics, i.e., optimization variables are joint accelerations and contact wrenches only.
+ *   Torque limits become inequality constraints on the actuated rows of the dynamics. This reduces the QP by the number of actuated joints. The torques are recovered after solving.
+ */
+enum TSIDFormulation{
+    tsid_full = 0,
+    tsid_torque_eliminated = 1
+};
+
+/**
+ * @brief Solver context of AccelerationSceneTSID, see WbcScene::solveWithContext()
+ */
+class TSIDSolverContext : public SolverContext{
+public:
+    uint nj;                                    /** Number of joints*/
+    TSIDFormulation formulation;                /** Formulation of the QP*/
+    base::VectorXd tau_bias;                    /** Bias torques of the actuated joints, only used for tsid_torque_eliminated*/
+    std::vector<std::string> contact_names;     /** Names of the active contacts*/
+    base::samples::Wrenches contact_wrenches;   /** Contact wrenches from the solution of the QP*/
+};
+
 /**
  * @brief Acceleration-based implementation of the WBC Scene. It sets up and solves the following problem:
  *  \f[
@@ -39,15 +62,34 @@ namespace wbc{
 class AccelerationSceneTSID : public WbcScene{
 protected:
     // Helper variables
-    base::VectorXd solver_output, robot_acc, solver_output_acc;
-    base::samples::Wrenches contact_wrenches;
     double hessian_regularizer;
+    TSIDFormulation formulation;
+    base::MatrixXd dynamics_mat;
+    base::VectorXd tau_bias;
+    std::vector<uint> actuated_idx, unactuated_idx;
 
     /**
      * brief Create a constraint and add it to the WBC scene
      */
     virtual ConstraintPtr createConstraint(const ConstraintConfig &config);
 
+    /**
+     * @brief Compute the (weighted) constraint matrix, reference and weights of the given constraint in robot root coordinates. Only writes to the constraint itself.
+     * @param model Robot model to use for the kinematics computations
+     */
+    void updateConstraint(ConstraintPtr constraint, RobotModel& model);
+
+    /**
+     * @brief Set up the constraints of the QP for the formulation tsid_torque_eliminated: Unactuated rows of the rigid body dynamics and rigid contacts as
+     *  equality constraints, actuated rows of the rigid body dynamics as inequality constraints (torque limits).
+     */
+    void setupTorqueEliminatedConstraints(QuadraticProgram& qp);
+
+    /**
+     * @brief Convert the solver output of the given context (joint accelerations, torques and contact wrenches) to joint command and contact wrenches
+     */
+    static void convertSolverOutput(const HierarchicalQP& hqp, TSIDSolverContext& context);
+
     base::Time stamp;
 
 public:
@@ -61,20 +103,30 @@ public:
     virtual const HierarchicalQP& update();
 
     /**
-     * @brief Solve the given optimization problem
-     * @return Solver output as joint acceleration command
+     * @brief Create an empty solver context, see WbcScene::solveWithContext()
+     */
+    virtual SolverContextPtr createSolverContext(){return std::make_shared<TSIDSolverContext>();}
+
+    /**
+     * @brief Copy joint names, active contacts and bias torques to the given context, see WbcScene::updateSolverContext()
      */
-    virtual const base::commands::Joints& solve(const HierarchicalQP& hqp);
+    virtual void updateSolverContext(SolverContext& context);
 
     /**
-     * @brief evaluateConstraints Evaluate the fulfillment of the constraints given the current robot state and the solver output
+     * @brief Solve the given optimization problem and convert the solution into a joint acceleration/torque command and contact wrenches, see WbcScene::solveWithContext()
      */
-    virtual const ConstraintsStatus &updateConstraintsStatus();
+    virtual void solveWithContext(const HierarchicalQP& hqp, SolverContext& context);
 
     /**
-     * @brief Get estimated contact wrenches
+     * @brief Copy the data required to evaluate the fulfillment of the constraints given the current robot state and the solver output, see updateConstraintsStatus().
+     *  y and y_solution are only computed for Cartesian constraints
      */
-    const base::samples::Wrenches& getContactWrenches(){return contact_wrenches;}
+    virtual void snapshotConstraintsStatus(ConstraintsStatusSnapshot& snapshot);
+
+    /**
+     * @brief Get estimated contact wrenches from the last call of solve()
+     */
+    const base::samples::Wrenches& getContactWrenches(){return static_cast<const TSIDSolverContext&>(*solver_context).contact_wrenches;}
 
     /**
      * @brief setHessianRegularizer
@@ -86,6 +138,17 @@ public:
      * @brief Return the current value of hessian regularizer
      */
     double getHessianRegularizer(){return hessian_regularizer;}
+
+    /**
+     * @brief Set the formulation of the QP, see TSIDFormulation. Default is tsid_full. Changing the formulation changes the size of the QP,
+     *  so the solver will be reset. The solver has to support inequality constraints (lower_y != upper_y) for tsid_torque_eliminated.
+     */
+    void setFormulation(const TSIDFormulation f);
+
+    /**
+     * @brief Return the current formulation of the QP
+     */
+    TSIDFormulation getFormulation(){return formulation;}
 };
 
 } // namespace wbc
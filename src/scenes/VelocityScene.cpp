@@ -4,6 +4,7 @@
 #include "../core/JointVelocityConstraint.hpp"
 #include "../core/CartesianVelocityConstraint.hpp"
 #include "../core/CoMVelocityConstraint.hpp"
+#include "../tools/SE3Tools.hpp"
 
 namespace wbc{
 
@@ -21,12 +22,71 @@ ConstraintPtr VelocityScene::createConstraint(const ConstraintConfig &config){
     }
 }
 
+void VelocityScene::updateConstraint(ConstraintPtr constraint, RobotModel& model){
+
+    constraint->checkTimeout();
+    int type = constraint->config.type;
+
+    if(type == cart){
+
+        CartesianVelocityConstraintPtr cart_constraint = std::static_pointer_cast<CartesianVelocityConstraint>(constraint);
+
+        // Constraint Jacobian
+        cart_constraint->A = model.spaceJacobian(cart_constraint->config.root, cart_constraint->config.tip);
+
+        // Constraint reference
+        // Convert input twist from the reference frame of the constraint to the base frame of the robot. We transform only the orientation of the
+        // reference frame to which the twist is expressed, NOT the position. This means that the center of rotation for a Cartesian constraint will
+        // be the origin of ref frame, not the root frame. This is more intuitive when controlling the orientation of e.g. a robot' s end effector.
+        const Eigen::Matrix3d rot = model.rigidBodyState(cart_constraint->config.root, cart_constraint->config.ref_frame).pose.orientation.toRotationMatrix();
+        rotateVector6(rot, cart_constraint->y_ref, cart_constraint->y_ref_root);
+
+        // Also convert the weight vector from ref frame to the root frame. Take the absolute values after rotation, since weights can only
+        // assume positive values
+        rotateWeights6(rot, cart_constraint->weights, cart_constraint->weights_root);
+    }
+    else if(type == com){
+        CoMVelocityConstraintPtr com_constraint = std::static_pointer_cast<CoMVelocityConstraint>(constraint);
+        com_constraint->A = model.comJacobian();
+        // CoM tasks are always in world/base frame, no need to transform.
+        com_constraint->y_ref_root = com_constraint->y_ref;
+        com_constraint->weights_root = com_constraint->weights;
+    }
+    else if(type == jnt){
+
+        JointVelocityConstraintPtr jnt_constraint = std::static_pointer_cast<JointVelocityConstraint>(constraint);
+
+        // Joint space constraints: constraint matrix has only ones and Zeros. The joint order in the constraints might be different than in the robot model.
+        // Thus, for joint space constraints, the joint indices have to be mapped correctly.
+        for(uint k = 0; k < jnt_constraint->config.joint_names.size(); k++){
+
+            int idx = model.jointIndex(jnt_constraint->config.joint_names[k]);
+            jnt_constraint->A(k,idx) = 1.0;
+            jnt_constraint->y_ref_root = jnt_constraint->y_ref;     // In joint space y_ref is equal to y_ref_root
+            jnt_constraint->weights_root = jnt_constraint->weights; // Same of the weights
+        }
+    }
+    else{
+        LOG_ERROR("Constraint %s: Invalid type: %i", constraint->config.name.c_str(), type);
+        throw std::invalid_argument("Invalid constraint configuration");
+    }
+
+    // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
+    // task phases and we don't want to store the "old" reference value, in case we switch on the constraint again
+    if(constraint->activation == 0){
+       constraint->y_ref.setZero();
+       constraint->y_ref_root.setZero();
+    }
+}
+
 const HierarchicalQP& VelocityScene::update(){
 
     if(!configured)
         throw std::runtime_error("VelocityScene has not been configured!. PLease call configure() before calling update() for the first time!");
 
-    base::samples::RigidBodyStateSE3 ref_frame;
+    applyReferenceInputs();
+
+    updateWorkerModels();
 
     // Create equation system
     //    Walk through all priorities and update the optimization problem. The outcome will be
@@ -36,87 +96,62 @@ const HierarchicalQP& VelocityScene::update(){
     for(uint prio = 0; prio < constraints.size(); prio++){
 
         constraints_prio[prio].resize(n_constraint_variables_per_prio[prio], robot_model->noOfJoints());
+        constraints_prio[prio].H.setIdentity();
+        constraints_prio[prio].g.setZero();
 
-        // Walk through all tasks of current priority
+        // Row index of each constraint in the equation system of the current priority
+        row_indices.resize(constraints[prio].size());
         uint row_index = 0;
         for(uint i = 0; i < constraints[prio].size(); i++){
+            row_indices[i] = row_index;
+            row_index += constraints[prio][i]->config.nVariables();
+        }
 
-            constraints[prio][i]->checkTimeout();
-            int type = constraints[prio][i]->config.type;
-            uint n_vars = constraints[prio][i]->config.nVariables();
-
-            if(type == cart){
-
-                CartesianVelocityConstraintPtr constraint = std::static_pointer_cast<CartesianVelocityConstraint>(constraints[prio][i]);
-
-                // Constraint Jacobian
-                constraint->A = robot_model->spaceJacobian(constraint->config.root, constraint->config.tip);
-
-                // Constraint reference
-                // Convert input twist from the reference frame of the constraint to the base frame of the robot. We transform only the orientation of the
-                // reference frame to which the twist is expressed, NOT the position. This means that the center of rotation for a Cartesian constraint will
-                // be the origin of ref frame, not the root frame. This is more intuitive when controlling the orientation of e.g. a robot' s end effector.
-                ref_frame = robot_model->rigidBodyState(constraint->config.root, constraint->config.ref_frame);
-                constraint->y_ref_root.segment(0,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->y_ref.segment(0,3);
-                constraint->y_ref_root.segment(3,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->y_ref.segment(3,3);
-
-                // Also convert the weight vector from ref frame to the root frame. Take the absolute values after rotation, since weights can only
-                // assume positive values
-                constraint->weights_root.segment(0,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->weights.segment(0,3);
-                constraint->weights_root.segment(3,3) = ref_frame.pose.orientation.toRotationMatrix() * constraint->weights.segment(3,3);
-                constraint->weights_root = constraint->weights_root.cwiseAbs();
-            }
-            else if(type == com){
-                CoMVelocityConstraintPtr constraint = std::static_pointer_cast<CoMVelocityConstraint>(constraints[prio][i]);
-                constraint->A = robot_model->comJacobian();
-                // CoM tasks are always in world/base frame, no need to transform.
-                constraint->y_ref_root = constraint->y_ref;
-                constraint->weights_root = constraint->weights;
-            }
-            else if(type == jnt){
-
-                JointVelocityConstraintPtr constraint = std::static_pointer_cast<JointVelocityConstraint>(constraints[prio][i]);
-
-                // Joint space constraints: constraint matrix has only ones and Zeros. The joint order in the constraints might be different than in the robot model.
-                // Thus, for joint space constraints, the joint indices have to be mapped correctly.
-                for(uint k = 0; k < constraint->config.joint_names.size(); k++){
-
-                    int idx = robot_model->jointIndex(constraint->config.joint_names[k]);
-                    constraint->A(k,idx) = 1.0;
-                    constraint->y_ref_root = constraint->y_ref;     // In joint space y_ref is equal to y_ref_root
-                    constraint->weights_root = constraint->weights; // Same of the weights
-                }
-            }
-            else{
-                LOG_ERROR("Constraint %s: Invalid type: %i", constraints[prio][i]->config.name.c_str(), type);
-                throw std::invalid_argument("Invalid constraint configuration");
-            }
+        // Walk through all tasks of current priority. Each constraint writes only to its own row block, so that the constraints can be evaluated in parallel
+        forEachConstraint(prio, [&](uint i, RobotModel& model){
+            updateConstraint(constraints[prio][i], model);
 
             ConstraintPtr constraint = constraints[prio][i];
-
-            // If the activation value is zero, also set reference to zero. Activation is usually used to switch between different
-            // task phases and we don't want to store the "old" reference value, in case we switch on the constraint again
-            if(constraint->activation == 0){
-               constraint->y_ref.setZero();
-               constraint->y_ref_root.setZero();
-            }
+            uint n_vars = constraint->config.nVariables();
 
             // Insert constraints into equation system of current priority at the correct position. Note: Weights will be zero if activations
             // for this constraint is zero or if the constraint is in timeout
-            constraints_prio[prio].Wy.segment(row_index, n_vars) = constraint->weights_root * constraint->activation * (!constraint->timeout);
-            constraints_prio[prio].A.block(row_index, 0, n_vars, robot_model->noOfJoints()) = constraint->A;
-            constraints_prio[prio].lower_y.segment(row_index, n_vars) = constraint->y_ref_root;
-            constraints_prio[prio].upper_y.segment(row_index, n_vars) = constraint->y_ref_root;
-            constraints_prio[prio].H.setIdentity();
-            constraints_prio[prio].lower_x.resize(0);
-            constraints_prio[prio].upper_x.resize(0);
-            constraints_prio[prio].g.setZero();
-
-            row_index += n_vars;
-
-        } // constraints on prio
+            constraints_prio[prio].Wy.segment(row_indices[i], n_vars) = constraint->weights_root * constraint->activation * (!constraint->timeout);
+            constraints_prio[prio].A.block(row_indices[i], 0, n_vars, model.noOfJoints()) = constraint->A;
+            constraints_prio[prio].lower_y.segment(row_indices[i], n_vars) = constraint->y_ref_root;
+            constraints_prio[prio].upper_y.segment(row_indices[i], n_vars) = constraint->y_ref_root;
+        });
+
+        constraints_prio[prio].lower_x.resize(0);
+        constraints_prio[prio].upper_x.resize(0);
     } // priorities
 
+    // Joint limits: Bounds on the joint velocities, valid for the whole hierarchy. Position limits are converted into velocity bounds using the cycle time.
+    // Joints without limits (e.g. floating base) are unbounded.
+    if(use_joint_limits && constraints_prio.size() > 0){
+        uint nj = robot_model->noOfJoints();
+        QuadraticProgram& qp = constraints_prio[0];
+        qp.lower_x.setConstant(nj, -1000);
+        qp.upper_x.setConstant(nj, 1000);
+        const base::samples::Joints& joint_state = robot_model->jointState(robot_model->jointNames());
+        const base::JointLimits& joint_limits = robot_model->jointLimits();
+        for(uint i = 0; i < joint_limits.size(); i++){
+            uint idx = robot_model->jointIndex(joint_limits.names[i]);
+            const base::JointLimitRange& range = joint_limits[i];
+            double q = joint_state[idx].position;
+            qp.lower_x(idx) = std::max(range.min.speed, (range.min.position - q) / cycle_time);
+            qp.upper_x(idx) = std::min(range.max.speed, (range.max.position - q) / cycle_time);
+            // If the joint is far beyond its position limit, the bounds become inconsistent. In this case, the velocity limit has precedence and
+            // the joint is driven back towards the position limit with maximum velocity
+            if(qp.lower_x(idx) > qp.upper_x(idx)){
+                if(q > range.max.position)
+                    qp.upper_x(idx) = qp.lower_x(idx);
+                else
+                    qp.lower_x(idx) = qp.upper_x(idx);
+            }
+        }
+    }
+
     constraints_prio.time = base::Time::now(); //  TODO: Use latest time stamp from all constraints!?
 
     // Joint Weights
@@ -124,53 +159,44 @@ const HierarchicalQP& VelocityScene::update(){
     return constraints_prio;
 }
 
-const base::commands::Joints& VelocityScene::solve(const HierarchicalQP& hqp){
+void VelocityScene::solveWithContext(const HierarchicalQP& hqp, SolverContext& context){
 
     // solve
+    base::VectorXd& solver_output = context.solver_output;
     solver_output.resize(hqp[0].nq);
     solver->solve(hqp, solver_output);
 
     // Convert Output
-    solver_output_joints.resize(robot_model->noOfActuatedJoints());
-    solver_output_joints.names = robot_model->actuatedJointNames();
-    for(uint i = 0; i < robot_model->noOfActuatedJoints(); i++){
-        const std::string& name = robot_model->actuatedJointNames()[i];
-        uint idx = robot_model->jointIndex(name);
+    base::commands::Joints& cmd = context.joint_cmd;
+    cmd.resize(context.joint_names.size());
+    cmd.names = context.joint_names;
+    for(uint i = 0; i < context.joint_names.size(); i++){
+        uint idx = context.joint_idx[i];
         if(base::isNaN(solver_output[idx]))
-            throw std::runtime_error("Solver output (speed) for joint " + name + " is NaN");
-        solver_output_joints[name].speed = solver_output[idx];
+            throw std::runtime_error("Solver output (speed) for joint " + context.joint_names[i] + " is NaN");
+        cmd[i].speed = solver_output[idx];
     }
-
-    solver_output_joints.time = base::Time::now();
-    return solver_output_joints;
+    cmd.time = base::Time::now();
 }
 
-const ConstraintsStatus& VelocityScene::updateConstraintsStatus(){
-
-    robot_vel.resize(robot_model->noOfJoints());
-    uint nj = robot_model->noOfJoints();
-    const base::samples::Joints &joint_state = robot_model->jointState(robot_model->jointNames());
-    for(size_t i = 0; i < nj; i++)
-        robot_vel(i) = joint_state[i].speed;
-
-    for(uint prio = 0; prio < constraints.size(); prio++){
-        for(uint i = 0; i < constraints[prio].size(); i++){
-            ConstraintPtr constraint = constraints[prio][i];
-            const std::string &name = constraint->config.name;
-
-            constraints_status[name].time       = constraint->time;
-            constraints_status[name].config     = constraint->config;
-            constraints_status[name].activation = constraint->activation;
-            constraints_status[name].timeout    = constraint->timeout;
-            constraints_status[name].weights    = constraint->weights;
-            constraints_status[name].y_ref      = constraint->y_ref;
-            constraints_status[name].y_solution = constraint->A * solver_output;
-            constraints_status[name].y          = constraint->A * robot_vel;
-        }
+void VelocityScene::snapshotConstraintsStatus(ConstraintsStatusSnapshot& snapshot){
+
+    snapshot.fields = constraints_status_fields;
+    snapshot.entries.resize(constraints_by_id.size());
+    if(constraints_status_fields & STATUS_Y_SOLUTION)
+        snapshot.solver_output = solver_context->solver_output;
+    if(constraints_status_fields & STATUS_Y){
+        uint nj = robot_model->noOfJoints();
+        const base::samples::Joints &joint_state = robot_model->jointState(robot_model->jointNames());
+        snapshot.robot_state.resize(nj);
+        for(size_t i = 0; i < nj; i++)
+            snapshot.robot_state(i) = joint_state[i].speed;
     }
 
-    constraints_prio.Wq = base::VectorXd::Map(joint_weights.elements.data(), robot_model->noOfJoints());
-    return constraints_status;
+    for(uint id = 0; id < constraints_by_id.size(); id++){
+        const ConstraintPtr& constraint = constraints_by_id[id];
+        snapshotConstraint(snapshot, id, constraint->y_ref, constraint->A);
+    }
 }
 
 
@@ -21,21 +21,35 @@ namespace wbc{
  * \f$\mathbf{W}\f$ - Diagonal task weight matrix<br>
  *
  * The tasks are all modeled as linear equality constraints to the above optimization problem. The task hierarchies are kept, i.e., multiple priorities are possible, depending on the solver.
+ *
+ * Optionally, the joint position and velocity limits of the robot model can be added as bounds on \f$\dot{\mathbf{q}}\f$ (see setJointLimitsEnabled()).
+ * The position limits are converted to velocity bounds using the cycle time, i.e., \f$(\mathbf{q}_{min}-\mathbf{q})/dt \leq \dot{\mathbf{q}} \leq (\mathbf{q}_{max}-\mathbf{q})/dt\f$.
+ * The bounds are set on the first priority only and are valid for the whole hierarchy.
  */
 class VelocityScene : public WbcScene{
 protected:
-    base::VectorXd solver_output, robot_vel;
     bool compute_id;
+    bool use_joint_limits;
+    double cycle_time;
+    std::vector<uint> row_indices;
 
     /**
      * @brief Create a constraint and add it to the WBC scene
      */
     virtual ConstraintPtr createConstraint(const ConstraintConfig &config);
 
+    /**
+     * @brief Compute constraint matrix, reference and weights of the given constraint in robot root coordinates. Only writes to the constraint itself.
+     * @param model Robot model to use for the kinematics computations
+     */
+    void updateConstraint(ConstraintPtr constraint, RobotModel& model);
+
 public:
     VelocityScene(RobotModelPtr robot_model, QPSolverPtr solver) :
         WbcScene(robot_model, solver),
-        compute_id(false){
+        compute_id(false),
+        use_joint_limits(false),
+        cycle_time(0.001){
     }
     virtual ~VelocityScene(){
     }
@@ -46,17 +60,41 @@ public:
     virtual const HierarchicalQP& update();
 
     /**
-     * @brief Solve the given optimization problem
-     * @return Solver output as joint velocity command
+     * @brief Solve the given optimization problem and convert the solution into a joint velocity command, see WbcScene::solveWithContext()
      */
-    virtual const base::commands::Joints& solve(const HierarchicalQP& hqp);
+    virtual void solveWithContext(const HierarchicalQP& hqp, SolverContext& context);
 
     /**
-     * @brief Compute y and y_solution for each constraint. y_solution denotes the constraint velocity that can be achieved
-     *  with the solution generated by the solver and y denotes the actual joint velocity achieved by the robot.
+     * @brief Copy the data required to compute y and y_solution for each constraint (see updateConstraintsStatus()). y_solution denotes the constraint velocity
+     *  that can be achieved with the solution generated by the solver and y denotes the actual joint velocity achieved by the robot.
      *  Both values can be used to evaluate the performance of WBC
      */
-    virtual const ConstraintsStatus &updateConstraintsStatus();
+    virtual void snapshotConstraintsStatus(ConstraintsStatusSnapshot& snapshot);
+
+    /**
+     * @brief If true, the joint position and velocity limits of the robot model will be added as bounds (lower_x/upper_x) to the first priority of the
+     *  optimization problem. The solver has to support bounds. Default is false.
+     */
+    void setJointLimitsEnabled(bool enable){use_joint_limits = enable;}
+
+    /**
+     * @brief Returns true if the joint limits are used as bounds in the optimization problem
+     */
+    bool getJointLimitsEnabled(){return use_joint_limits;}
+
+    /**
+     * @brief Set the control cycle time in seconds. It is used to convert the joint position limits into velocity bounds. Has to be > 0. Default is 0.001.
+     */
+    void setCycleTime(double dt){
+        if(dt <= 0)
+            throw std::invalid_argument("VelocityScene::setCycleTime: Cycle time has to be > 0, but is " + std::to_string(dt));
+        cycle_time = dt;
+    }
+
+    /**
+     * @brief Returns the control cycle time in seconds
+     */
+    double getCycleTime(){return cycle_time;}
 };
 
 } // namespace wbc
@@ -4,6 +4,7 @@
 #include "../core/CartesianVelocityConstraint.hpp"
 #include "../core/JointVelocityConstraint.hpp"
 #include "../core/CoMVelocityConstraint.hpp"
+#include "../tools/SE3Tools.hpp"
 
 
 namespace wbc{
@@ -22,6 +23,8 @@ const HierarchicalQP& VelocitySceneQuadraticCost::update(){
     if(!configured)
         throw std::runtime_error("VelocitySceneQuadraticCost has not been configured!. PLease call configure() before calling update() for the first time!");
 
+    applyReferenceInputs();
+
     if(constraints.size() != 1){
         LOG_ERROR("Number of priorities in VelocitySceneQuadraticCost should be 1, but is %i", constraints.size());
         throw std::runtime_error("Invalid constraint configuration");
@@ -53,15 +56,12 @@ const HierarchicalQP& VelocitySceneQuadraticCost::update(){
             constraint->A = robot_model->spaceJacobian(constraint->config.root, constraint->config.tip);
 
             // Convert constraint twist to robot root
-            base::MatrixXd rot_mat = robot_model->rigidBodyState(constraint->config.root, constraint->config.ref_frame).pose.orientation.toRotationMatrix();
-            constraint->y_ref_root.segment(0,3) = rot_mat * constraint->y_ref.segment(0,3);
-            constraint->y_ref_root.segment(3,3) = rot_mat * constraint->y_ref.segment(3,3);
+            const Eigen::Matrix3d rot = robot_model->rigidBodyState(constraint->config.root, constraint->config.ref_frame).pose.orientation.toRotationMatrix();
+            rotateVector6(rot, constraint->y_ref, constraint->y_ref_root);
 
             // Also convert the weight vector from ref frame to the root frame. Take the absolute values after rotation, since weights can only
             // assume positive values
-            constraint->weights_root.segment(0,3) = rot_mat * constraint->weights.segment(0,3);
-            constraint->weights_root.segment(3,3) = rot_mat * constraint->weights.segment(3,3);
-            constraint->weights_root = constraint->weights_root.cwiseAbs();
+            rotateWeights6(rot, constraint->weights, constraint->weights_root);
         }
         else if(type == com){
             constraint = std::static_pointer_cast<CoMVelocityConstraint>(constraints[prio][i]);
@@ -0,0 +1,350 @@
+#include "ADMMSolver.hpp"
+#include "../../core/QuadraticProgram.hpp"
+#include <limits>
+#include <stdexcept>
+
+namespace wbc {
+
+QPSolverRegistry<ADMMSolver> ADMMSolver::reg("admm");
+
+ADMMSolver::ADMMSolver() :
+    max_iter(4000),
+    abs_tol(1e-5),
+    rel_tol(1e-5),
+    rho(0.1),
+    rho_init(0.1),
+    sigma(1e-6),
+    alpha(1.6),
+    adaptive_rho(true),
+    warm_start(true),
+    n_iter(0),
+    n_factorizations(0),
+    nq(0),
+    nc(0),
+    n_rows(0),
+    has_bounds(false),
+    kkt_changed(true){
+}
+
+ADMMSolver::~ADMMSolver(){
+}
+
+void ADMMSolver::setRho(double val){
+    if(val <= 0)
+        throw std::invalid_argument("ADMMSolver::setRho: Rho has to be > 0");
+    rho = rho_init = val;
+    configured = false;
+}
+
+void ADMMSolver::extractPattern(const QuadraticProgram &qp){
+
+    nq = qp.nq;
+    nc = qp.nc;
+    has_bounds = qp.lower_x.size() > 0 || qp.upper_x.size() > 0;
+    n_rows = nc + (has_bounds ? nq : 0);
+
+    typedef Eigen::Triplet<double> Triplet;
+    std::vector<Triplet> triplets;
+
+    // P: lower triangular part of H. The diagonal is always part of the pattern, since the KKT matrix contains P + sigma*I
+    for(uint j = 0; j < nq; j++){
+        for(uint i = j; i < nq; i++){
+            if(i == j || qp.H(i,j) != 0)
+                triplets.push_back(Triplet(i, j, qp.H(i,j)));
+        }
+    }
+    P.resize(nq, nq);
+    P.setFromTriplets(triplets.begin(), triplets.end());
+    P.makeCompressed();
+
+    // C = [A; I]
+    triplets.clear();
+    for(uint i = 0; i < nc; i++){
+        for(uint j = 0; j < nq; j++){
+            if(qp.A(i,j) != 0)
+                triplets.push_back(Triplet(i, j, qp.A(i,j)));
+        }
+    }
+    if(has_bounds){
+        for(uint j = 0; j < nq; j++)
+            triplets.push_back(Triplet(nc + j, j, 1.0));
+    }
+    C.resize(n_rows, nq);
+    C.setFromTriplets(triplets.begin(), triplets.end());
+    C.makeCompressed();
+
+    // Row-wise view on the pattern of A, so that the row-major matrix A of the QP can be traversed in storage order when updating the values
+    a_row_start.assign(nc + 1, 0);
+    for(int idx = 0; idx < C.nonZeros(); idx++){
+        if(C.innerIndexPtr()[idx] < (int)nc)
+            a_row_start[C.innerIndexPtr()[idx] + 1]++;
+    }
+    for(uint i = 0; i < nc; i++)
+        a_row_start[i+1] += a_row_start[i];
+    a_cols.resize(a_row_start[nc]);
+    a_val_idx.resize(a_row_start[nc]);
+    std::vector<int> next(a_row_start.begin(), a_row_start.end() - 1);
+    for(uint j = 0; j < nq; j++){
+        for(int idx = C.outerIndexPtr()[j]; idx < C.outerIndexPtr()[j+1]; idx++){
+            int i = C.innerIndexPtr()[idx];
+            if(i < (int)nc){
+                a_cols[next[i]] = j;
+                a_val_idx[next[i]++] = idx;
+            }
+        }
+    }
+
+    // Lower triangular part of the quasi-definite KKT matrix [P + sigma*I, C^T; C, -diag(1/rho)]. The storage order is known in advance:
+    // Column j < nq holds column j of P followed by column j of C, column nq+i holds the rho term of constraint row i.
+    kkt.resize(nq + n_rows, nq + n_rows);
+    kkt.reserve(P.nonZeros() + C.nonZeros() + n_rows);
+    kkt_src.clear();
+    kkt_p_diag.clear();
+    kkt_rho_diag.clear();
+    int k = 0;
+    for(uint j = 0; j < nq; j++){
+        kkt.startVec(j);
+        for(int idx = P.outerIndexPtr()[j]; idx < P.outerIndexPtr()[j+1]; idx++){
+            if(P.innerIndexPtr()[idx] == (int)j)
+                kkt_p_diag.push_back(k);
+            kkt.insertBack(P.innerIndexPtr()[idx], j) = 0;
+            kkt_src.push_back(idx);
+            k++;
+        }
+        for(int idx = C.outerIndexPtr()[j]; idx < C.outerIndexPtr()[j+1]; idx++){
+            kkt.insertBack(nq + C.innerIndexPtr()[idx], j) = 0;
+            kkt_src.push_back(-1-idx);
+            k++;
+        }
+    }
+    for(uint i = 0; i < n_rows; i++){
+        kkt.startVec(nq + i);
+        kkt.insertBack(nq + i, nq + i) = 0;
+        kkt_rho_diag.push_back(k++);
+    }
+    kkt.finalize();
+
+    ldlt.analyzePattern(kkt);
+
+    // Reset the solver state
+    x.setZero(nq);
+    y.setZero(n_rows);
+    z.setZero(n_rows);
+    rho = rho_init;
+    // The values of the KKT matrix are set in updateValues() and updateRho()
+    rho_vec.setConstant(n_rows, std::numeric_limits<double>::quiet_NaN());
+    kkt_changed = true;
+}
+
+bool ADMMSolver::updateValues(const QuadraticProgram &qp){
+
+    // Walk the dense matrices along the cached pattern. Entries of the pattern are copied, a non-zero outside of the pattern means that the pattern has changed
+    bool changed = false;
+    const int* p_outer = P.outerIndexPtr();
+    const int* p_inner = P.innerIndexPtr();
+    double* p_val = P.valuePtr();
+    for(uint j = 0; j < nq; j++){
+        int k = p_outer[j];
+        for(uint i = j; i < nq; i++){
+            double v = qp.H(i,j);
+            if(k < p_outer[j+1] && p_inner[k] == (int)i){
+                changed |= (p_val[k] != v);
+                p_val[k++] = v;
+            }
+            else if(v != 0)
+                return false;
+        }
+    }
+    double* c_val = C.valuePtr();
+    for(uint i = 0; i < nc; i++){
+        int k = a_row_start[i];
+        for(uint j = 0; j < nq; j++){
+            double v = qp.A(i,j);
+            if(k < a_row_start[i+1] && a_cols[k] == (int)j){
+                changed |= (c_val[a_val_idx[k]] != v);
+                c_val[a_val_idx[k++]] = v;
+            }
+            else if(v != 0)
+                return false;
+        }
+    }
+
+    if(changed || kkt_changed){
+        double* kkt_val = kkt.valuePtr();
+        for(size_t k = 0; k < kkt_src.size(); k++)
+            kkt_val[k] = kkt_src[k] >= 0 ? p_val[kkt_src[k]] : c_val[-1-kkt_src[k]];
+        for(auto k : kkt_p_diag)
+            kkt_val[k] += sigma;
+        kkt_changed = true;
+    }
+
+    // Vectors
+    q = qp.g.size() == 0 ? base::VectorXd::Zero(nq) : qp.g;
+    l.setConstant(n_rows, -std::numeric_limits<double>::infinity());
+    u.setConstant(n_rows, std::numeric_limits<double>::infinity());
+    if(qp.lower_y.size() > 0)
+        l.head(nc) = qp.lower_y;
+    if(qp.upper_y.size() > 0)
+        u.head(nc) = qp.upper_y;
+    if(qp.lower_x.size() > 0)
+        l.tail(nq) = qp.lower_x;
+    if(qp.upper_x.size() > 0)
+        u.tail(nq) = qp.upper_x;
+    // Undefined bounds (NaN) are treated as unbounded
+    l = l.array().isNaN().select(-std::numeric_limits<double>::infinity(), l);
+    u = u.array().isNaN().select(std::numeric_limits<double>::infinity(), u);
+
+    return true;
+}
+
+void ADMMSolver::updateRho(){
+    // Larger step size for equality constraints, tiny step size for unconstrained rows (see OSQP paper)
+    const double inf = std::numeric_limits<double>::infinity();
+    double* kkt_val = kkt.valuePtr();
+    for(uint i = 0; i < n_rows; i++){
+        double rho_i = rho;
+        if(l(i) == -inf && u(i) == inf)
+            rho_i = 1e-6;
+        else if(l(i) == u(i))
+            rho_i = 1e3 * rho;
+        if(rho_i != rho_vec(i)){
+            rho_vec(i) = rho_i;
+            kkt_val[kkt_rho_diag[i]] = -1.0 / rho_i;
+            kkt_changed = true;
+        }
+    }
+}
+
+bool ADMMSolver::factorize(){
+    base::Time start = base::Time::now();
+    ldlt.factorize(kkt);
+    stats.factorization_time += (base::Time::now() - start).toSeconds();
+    n_factorizations++;
+    kkt_changed = ldlt.info() != Eigen::Success;
+    return !kkt_changed;
+}
+
+void ADMMSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output){
+
+    startSolve();
+
+    if(hierarchical_qp.size() != 1)
+        throw std::runtime_error("ADMMSolver::solve: Number of task hierarchies must be 1 for the current implementation");
+
+    const wbc::QuadraticProgram &qp = hierarchical_qp[0];
+
+    if(qp.H.rows() != qp.nq || qp.H.cols() != qp.nq)
+        throw std::runtime_error("Hessian matrix H should have size " + std::to_string(qp.nq) + "x" + std::to_string(qp.nq) +
+                                 " but has size " +  std::to_string(qp.H.rows()) + "x" + std::to_string(qp.H.cols()));
+    if(qp.A.rows() != qp.nc || qp.A.cols() != qp.nq)
+        throw std::runtime_error("Constraint matrix A should have size " + std::to_string(qp.nc) + "x" + std::to_string(qp.nq) +
+                                 " but has size " +  std::to_string(qp.A.rows()) + "x" + std::to_string(qp.A.cols()));
+
+    bool bounds = qp.lower_x.size() > 0 || qp.upper_x.size() > 0;
+    if(!configured || qp.nq != (int)nq || qp.nc != (int)nc || bounds != has_bounds){
+        extractPattern(qp);
+        configured = true;
+    }
+    if(!updateValues(qp)){
+        // Sparsity pattern has changed
+        extractPattern(qp);
+        updateValues(qp);
+    }
+
+    if(!warm_start){
+        x.setZero(nq);
+        y.setZero(n_rows);
+        z.setZero(n_rows);
+        rho = rho_init;
+    }
+    // The iterates are reset on reconfiguration and failure, so non-zero iterates mean that the solver continues from the previous solution
+    stats.warm_start = warm_start && (x.squaredNorm() > 0 || y.squaredNorm() > 0);
+    stats.setup_time = (base::Time::now() - solve_start).toSeconds();
+
+    base::Time iter_start = base::Time::now();
+    n_factorizations = 0;
+    updateRho();
+    // The factorization of the previous call can be reused if H, A and rho are unchanged
+    if(kkt_changed && !factorize()){
+        handleFailure(qp, qp_failed, "ADMMSolver failed: LDL factorization of the KKT matrix failed", solver_output);
+        return;
+    }
+
+    rhs.resize(nq + n_rows);
+    const uint adapt_interval = 25;
+    bool converged = false;
+    for(n_iter = 1; n_iter <= max_iter; n_iter++){
+
+        // Solve the KKT system: [P + sigma*I, C^T; C, -diag(1/rho)] * [x_tilde; nu] = [sigma*x - q; z - y/rho]
+        rhs.head(nq) = sigma * x - q;
+        rhs.tail(n_rows) = z - y.cwiseQuotient(rho_vec);
+        sol = ldlt.solve(rhs);
+        x_tilde = sol.head(nq);
+        z_tilde = z + (sol.tail(n_rows) - y).cwiseQuotient(rho_vec);
+
+        // Relaxation and projection onto the constraint set
+        x = alpha * x_tilde + (1 - alpha) * x;
+        z_relax = alpha * z_tilde + (1 - alpha) * z;
+        z = (z_relax + y.cwiseQuotient(rho_vec)).cwiseMax(l).cwiseMin(u);
+        y += rho_vec.cwiseProduct(z_relax - z);
+
+        // Residuals
+        Px = P.selfadjointView<Eigen::Lower>() * x;
+        Cx = C * x;
+        Cty = C.transpose() * y;
+        double prim_res = (Cx - z).lpNorm<Eigen::Infinity>();
+        double dual_res = (Px + q + Cty).lpNorm<Eigen::Infinity>();
+        double prim_scale = std::max(Cx.lpNorm<Eigen::Infinity>(), z.lpNorm<Eigen::Infinity>());
+        double dual_scale = std::max(std::max(Px.lpNorm<Eigen::Infinity>(), Cty.lpNorm<Eigen::Infinity>()), q.lpNorm<Eigen::Infinity>());
+        stats.primal_residual = prim_res;
+        stats.dual_residual = dual_res;
+        stats.n_iter = n_iter;
+
+        if(prim_res <= abs_tol + rel_tol * prim_scale && dual_res <= abs_tol + rel_tol * dual_scale){
+            converged = true;
+            break;
+        }
+
+        // Time budget exceeded: Return the current iterate, projected onto the bounds. Keep the solver state to continue from here in the next call
+        if(deadlineExceeded()){
+            stats.iteration_time = (base::Time::now() - iter_start).toSeconds() - stats.factorization_time;
+            base::VectorXd best_iterate = x;
+            if(has_bounds)
+                best_iterate = best_iterate.cwiseMax(l.tail(nq)).cwiseMin(u.tail(nq));
+            handleFailure(qp, qp_deadline_exceeded, "ADMMSolver: Time budget exceeded", solver_output, &best_iterate);
+            return;
+        }
+
+        // Adapt rho to balance primal and dual residuals. Refactorize only if rho changes significantly
+        if(adaptive_rho && n_iter % adapt_interval == 0){
+            double rho_new = rho * sqrt((prim_res / (prim_scale + 1e-10)) / (dual_res / (dual_scale + 1e-10) + 1e-10));
+            rho_new = std::min(std::max(rho_new, 1e-6), 1e6);
+            if(rho_new > 5 * rho || rho_new < rho / 5){
+                rho = rho_new;
+                updateRho();
+                if(!factorize()){
+                    handleFailure(qp, qp_failed, "ADMMSolver failed: LDL factorization of the KKT matrix failed", solver_output);
+                    return;
+                }
+            }
+        }
+    }
+
+    // Factorizations within the loop are counted as factorization time
+    stats.iteration_time = (base::Time::now() - iter_start).toSeconds() - stats.factorization_time;
+    if(!converged){
+        n_iter = max_iter;
+        // Don't warm start from a diverged solution
+        x.setZero(nq);
+        y.setZero(n_rows);
+        z.setZero(n_rows);
+        rho = rho_init;
+        handleFailure(qp, qp_failed, "ADMMSolver failed: Maximum Iterations reached", solver_output);
+        return;
+    }
+
+    solver_output = x;
+    finishSolve(solver_output);
+}
+
+}
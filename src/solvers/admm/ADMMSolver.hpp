@@ -0,0 +1,116 @@
+#ifndef WBC_SOLVERS_ADMM_SOLVER_HPP
+#define WBC_SOLVERS_ADMM_SOLVER_HPP
+
+#include "../../core/QPSolverFactory.hpp"
+#include "../../core/QPSolver.hpp"
+
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <vector>
+
+namespace wbc {
+
+class HierarchicalQP;
+class QuadraticProgram;
+
+/**
+ * @brief Sparse first-order QP solver based on the alternating direction method of multipliers (ADMM), following the OSQP algorithm in
+ * Stellato, B. et al. "OSQP: An Operator Splitting Solver for Quadratic Programs." Mathematical Programming Computation 12 (2020): 637–672.
+ * It solves problems of shape:
+ *  \f[
+ *        \begin{array}{ccc}
+ *        min(\mathbf{x}) & \frac{1}{2} \mathbf{x}^T\mathbf{H}\mathbf{x}+\mathbf{x}^T\mathbf{g}& \\
+ *             & & \\
+ *        s.t. & lb(\mathbf{Ax}) \leq \mathbf{Ax} \leq ub(\mathbf{Ax})& \\
+ *             & lb(\mathbf{x}) \leq \mathbf{x} \leq ub(\mathbf{x})& \\
+ *        \end{array}
+ *  \f]
+ *
+ * H and A are converted to compressed sparse column format. The sparsity pattern is extracted once, when the solver is configured. In subsequent
+ * calls of solve() only the numerical values are copied, and the sparse LDL^T factorization of the KKT matrix reuses its symbolic analysis. The numeric
+ * factorization is only recomputed if the values of H and A or the step sizes rho have changed. If a matrix entry outside the extracted pattern becomes
+ * non-zero, the pattern is extracted again. The solver is warm started from the primal/dual
+ * solution of the previous call and adapts the ADMM step size rho based on the ratio of primal and dual residuals.
+ *
+ * Note that, as a first-order method, the solver returns solutions of moderate accuracy (see setAbsTol() and setRelTol()). If a time budget is set
+ * (see QPSolver::setTimeBudget()) and exceeded, the current iterate, projected onto the bounds, is returned.
+ */
+class ADMMSolver : public QPSolver{
+private:
+    static QPSolverRegistry<ADMMSolver> reg;
+
+public:
+    typedef Eigen::SparseMatrix<double, Eigen::ColMajor> SparseMatrix;
+
+    ADMMSolver();
+    virtual ~ADMMSolver();
+
+    /**
+     * @brief solve Solve the given quadratic program
+     * @param hierarchical_qp Description of the hierarchical quadratic program to solve. Only one priority level is supported.
+     * @param solver_output solution of the quadratic program
+     */
+    virtual void solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output);
+
+    /** Set the maximum number of ADMM iterations. Default is 4000*/
+    void setMaxIter(uint val){max_iter = val;}
+    /** Set the absolute tolerance of the primal/dual residuals. Default is 1e-5*/
+    void setAbsTol(double val){abs_tol = val;}
+    /** Set the relative tolerance of the primal/dual residuals. Default is 1e-5*/
+    void setRelTol(double val){rel_tol = val;}
+    /** Set the initial ADMM step size. Has to be > 0. Default is 0.1*/
+    void setRho(double val);
+    /** Enable/disable adaption of rho. Default is true*/
+    void setAdaptiveRho(bool val){adaptive_rho = val;}
+    /** Enable/disable warm start from the previous solution. Default is true*/
+    void setWarmStart(bool val){warm_start = val;}
+
+    uint getMaxIter(){return max_iter;}
+    double getAbsTol(){return abs_tol;}
+    double getRelTol(){return rel_tol;}
+    double getRho(){return rho;}
+    bool getAdaptiveRho(){return adaptive_rho;}
+    bool getWarmStart(){return warm_start;}
+
+    /** Number of ADMM iterations of the last call to solve()*/
+    uint getNoOfIterations(){return n_iter;}
+    /** Number of numeric factorizations of the KKT matrix in the last call to solve(). Zero if H, A and rho are unchanged*/
+    uint getNoOfFactorizations(){return n_factorizations;}
+
+protected:
+    uint max_iter;
+    double abs_tol, rel_tol;
+    double rho, rho_init, sigma, alpha;
+    bool adaptive_rho, warm_start;
+    uint n_iter, n_factorizations;
+
+    uint nq, nc, n_rows;            /** Number of variables, rows of A and total number of constraint rows (rows of A + bounds)*/
+    bool has_bounds;
+    bool kkt_changed;               /** True if the values of the KKT matrix have changed since the last numeric factorization*/
+
+    // Sparse problem data. C = [A; I] stacks the constraint matrix and the bounds on x, P is the lower triangular part of H
+    SparseMatrix P, C, kkt;
+    std::vector<int> a_row_start;          /** Row-wise view on the pattern of A: Start of each row in a_cols/a_val_idx (nc+1 entries) */
+    std::vector<int> a_cols, a_val_idx;    /** Column and index into the values of C of each stored entry of A, sorted by row */
+    std::vector<int> kkt_src;              /** Source of each stored entry of the KKT matrix: index into P (>= 0), into C (< 0, encoded as -1-idx)*/
+    std::vector<int> kkt_p_diag, kkt_rho_diag; /** Position of the diagonal entries of the KKT matrix for the sigma and rho terms*/
+    Eigen::SimplicialLDLT<SparseMatrix, Eigen::Lower> ldlt;
+
+    base::VectorXd q, l, u, rho_vec;
+    base::VectorXd x, y, z, x_tilde, z_tilde, z_relax, rhs, sol;
+    base::VectorXd Px, Cx, Cty;
+
+    /** Build the sparsity pattern of P, C and the KKT matrix from the non-zeros of the given QP and run the symbolic analysis*/
+    void extractPattern(const QuadraticProgram &qp);
+    /** Copy the numerical values of H and A into the sparse matrices, in a single pass over the dense matrices along the cached pattern.
+     *  Returns false if a non-zero is outside of the current pattern*/
+    bool updateValues(const QuadraticProgram &qp);
+    /** Update the step sizes per constraint row and the corresponding entries of the KKT matrix*/
+    void updateRho();
+    /** Numerical LDL^T factorization of the KKT matrix. Returns false if the factorization failed*/
+    bool factorize();
+};
+
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include <base/Eigen.hpp>
 #include <Eigen/Core>
 #include <iostream>
+#include <limits>
 
 namespace wbc {
 
@@ -11,6 +12,10 @@ QPSolverRegistry<EiquadprogSolver> EiquadprogSolver::reg("eiquadprog");
 EiquadprogSolver::EiquadprogSolver()
 {
     _n_iter = 100;
+    _actual_n_iter = 0;
+    _warm_start = false;
+    _warm_start_successful = false;
+    _has_active_set = false;
 }
 
 EiquadprogSolver::~EiquadprogSolver()
@@ -20,6 +25,7 @@ EiquadprogSolver::~EiquadprogSolver()
 
 void EiquadprogSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::VectorXd& solver_output)
 {
+    startSolve();
 
     if(hierarchical_qp.size() != 1)
         throw std::runtime_error("EiquadprogSolver::solve: Constraints vector size must be 1 for the current implementation");
@@ -59,68 +65,209 @@ void EiquadprogSolver::solve(const wbc::HierarchicalQP& hierarchical_qp, base::V
         throw std::runtime_error("Gradient vector g should have size " + std::to_string(qp.nq) + "but has size " + std::to_string(qp.g.size()));
 
 
-    size_t n_con = qp.lower_x.size() + qp.upper_x.size() + qp.lower_y.size() + qp.upper_y.size();
     size_t n_var = qp.A.cols();
 
-    if(!configured) 
+    // Rebuild the constraint matrices only if the partition of the constraints changes, e.g., if a bound becomes (in-)finite
+    if(updatePartition(qp) || !configured || n_var != (size_t)_CI_mtx.cols())
     {
-        _solver.reset(n_var, 0, n_con);
+        size_t n_eq = _eq_rows.size();
+        size_t n_in = _lb_x_idx.size() + _ub_x_idx.size() + _lb_y_rows.size() + _ub_y_rows.size();
+
+        _solver.reset(n_var, n_eq, n_in);
         _solver.setMaxIter(_n_iter);
 
-        // hessian and gradient are ok (don#t need to be stacked)
-        // configuring constraints matrices
-        _CE_mtx.resize(0, n_var);
-        _ce0_vec.resize(0);
-        _CI_mtx.resize(n_con, n_var);
-        _ci0_vec.resize(n_con);
+        _CE_mtx.resize(n_eq, n_var);
+        _ce0_vec.resize(n_eq);
+        _CI_mtx.setZero(n_in, n_var);
+        _ci0_vec.resize(n_in);
+
+        // Bounds on x are constant rows of the constraint matrix
+        size_t ci_cnt = 0;
+        for(auto i : _lb_x_idx)
+            _CI_mtx(ci_cnt++, i) = 1;
+        for(auto i : _ub_x_idx)
+            _CI_mtx(ci_cnt++, i) = -1;
 
+        _has_active_set = false;
         configured = true;
     }
-    else 
-    {
-        if(n_var != _CI_mtx.cols())
-            throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
-        if(n_con != _CI_mtx.rows())
-            throw std::runtime_error("QP problem changed dynamically. Not supported at the moment.");
-    }
-
-    size_t ci_cnt = 0; // count of constraints already set
 
-    _CI_mtx.block(ci_cnt, 0, qp.lower_x.size(), n_var) = Eigen::MatrixXd::Identity(qp.lower_x.size(), n_var);
-    _ci0_vec.segment(ci_cnt, qp.lower_x.size()) = -qp.lower_x;
-    ci_cnt += qp.lower_x.size();
+    // Fill in the current values. Constraints have the form CE*x + ce0 = 0 and CI*x + ci0 >= 0
+    for(size_t i = 0; i < _eq_rows.size(); i++){
+        _CE_mtx.row(i) = qp.A.row(_eq_rows[i]);
+        _ce0_vec(i) = -qp.lower_y(_eq_rows[i]);
+    }
 
-    _CI_mtx.block(ci_cnt, 0, qp.upper_x.size(), n_var) = -Eigen::MatrixXd::Identity(qp.upper_x.size(), n_var);
-    _ci0_vec.segment(ci_cnt, qp.upper_x.size()) = qp.upper_x;
-    ci_cnt += qp.upper_x.size();
+    size_t ci_cnt = 0;
+    for(auto i : _lb_x_idx)
+        _ci0_vec(ci_cnt++) = -qp.lower_x(i);
+    for(auto i : _ub_x_idx)
+        _ci0_vec(ci_cnt++) = qp.upper_x(i);
+    for(auto i : _lb_y_rows){
+        _CI_mtx.row(ci_cnt) = qp.A.row(i);
+        _ci0_vec(ci_cnt++) = -qp.lower_y(i);
+    }
+    for(auto i : _ub_y_rows){
+        _CI_mtx.row(ci_cnt) = -qp.A.row(i);
+        _ci0_vec(ci_cnt++) = qp.upper_y(i);
+    }
 
-    _CI_mtx.block(ci_cnt, 0, qp.lower_y.size(), n_var) = qp.A;
-    _ci0_vec.segment(ci_cnt, qp.lower_y.size()) = -qp.lower_y;
-    ci_cnt += qp.lower_y.size();
+    base::Time iter_start = base::Time::now();
+    stats.setup_time = (iter_start - solve_start).toSeconds();
 
-    _CI_mtx.block(ci_cnt, 0, qp.upper_y.size(), n_var) = -qp.A;
-    _ci0_vec.segment(ci_cnt, qp.upper_y.size()) = qp.upper_y;
-    ci_cnt += qp.upper_y.size();
+    _warm_start_successful = _warm_start && solveWithActiveSet(qp, solver_output);
+    if(_warm_start_successful){
+        _actual_n_iter = 0;
+        stats.warm_start = true;
+        stats.iteration_time = (base::Time::now() - iter_start).toSeconds();
+        finishSolve(solver_output);
+        return;
+    }
 
     namespace eq = eiquadprog::solvers;
 
-    Eigen::VectorXd out(qp.nq);
+    _x.resize(qp.nq);
     
     eq::EiquadprogFast_status status = _solver.solve_quadprog(
-        qp.H, qp.g, _CE_mtx, _ce0_vec, _CI_mtx, _ci0_vec, out);
+        qp.H, qp.g, _CE_mtx, _ce0_vec, _CI_mtx, _ci0_vec, _x);
     
-    solver_output.resize(qp.nq);
-    solver_output = out;
+    solver_output = _x;
 
-    if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_UNBOUNDED)
-        throw std::runtime_error("Eiquadprog returned error status:unbounded.");
-    if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_MAX_ITER_REACHED)
-        throw std::runtime_error("Eiquadprog returned error status: max iterations reached.");
-    if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_REDUNDANT_EQUALITIES)
-        throw std::runtime_error("Eiquadprog returned error status: redundant equalities.");
-    if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_INFEASIBLE)
-        throw std::runtime_error("Eiquadprog returned error status: infeasible.");
+    if(status != eq::EiquadprogFast_status::EIQUADPROG_FAST_OPTIMAL)
+        _has_active_set = false;
 
     _actual_n_iter = _solver.getIteratios();
+    // Each iteration of the Goldfarb-Idnani method adds or drops a constraint from the active set
+    stats.n_iter = stats.n_active_set_changes = _actual_n_iter;
+    stats.iteration_time = (base::Time::now() - iter_start).toSeconds();
+
+    std::string error;
+    if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_UNBOUNDED)
+        error = "Eiquadprog returned error status:unbounded.";
+    else if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_MAX_ITER_REACHED)
+        error = "Eiquadprog returned error status: max iterations reached.";
+    else if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_REDUNDANT_EQUALITIES)
+        error = "Eiquadprog returned error status: redundant equalities.";
+    else if(status == eq::EiquadprogFast_status::EIQUADPROG_FAST_INFEASIBLE)
+        error = "Eiquadprog returned error status: infeasible.";
+    if(!error.empty()){
+        handleFailure(qp, qp_failed, error, solver_output);
+        return;
+    }
+
+    if(_warm_start)
+        updateActiveSet(solver_output);
+    finishSolve(solver_output);
+}
+
+QPSolver* EiquadprogSolver::createBatchSolver(){
+    EiquadprogSolver* solver = new EiquadprogSolver();
+    solver->setMaxNIter(_n_iter);
+    solver->setWarmStart(_warm_start);
+    return solver;
 }
+
+bool EiquadprogSolver::updatePartition(const wbc::QuadraticProgram& qp){
+
+    _eq_rows_new.clear();
+    _lb_x_idx_new.clear();
+    _ub_x_idx_new.clear();
+    _lb_y_rows_new.clear();
+    _ub_y_rows_new.clear();
+
+    for(int i = 0; i < qp.lower_x.size(); i++){
+        if(qp.lower_x(i) > -std::numeric_limits<double>::infinity())
+            _lb_x_idx_new.push_back(i);
+    }
+    for(int i = 0; i < qp.upper_x.size(); i++){
+        if(qp.upper_x(i) < std::numeric_limits<double>::infinity())
+            _ub_x_idx_new.push_back(i);
+    }
+    for(int i = 0; i < qp.A.rows(); i++){
+        bool has_lb = qp.lower_y.size() > 0 && qp.lower_y(i) > -std::numeric_limits<double>::infinity();
+        bool has_ub = qp.upper_y.size() > 0 && qp.upper_y(i) < std::numeric_limits<double>::infinity();
+        if(has_lb && has_ub && qp.lower_y(i) == qp.upper_y(i))
+            _eq_rows_new.push_back(i);
+        else{
+            if(has_lb)
+                _lb_y_rows_new.push_back(i);
+            if(has_ub)
+                _ub_y_rows_new.push_back(i);
+        }
+    }
+
+    bool changed = (_eq_rows_new != _eq_rows || _lb_x_idx_new != _lb_x_idx || _ub_x_idx_new != _ub_x_idx ||
+                    _lb_y_rows_new != _lb_y_rows || _ub_y_rows_new != _ub_y_rows);
+    if(changed){
+        _eq_rows.swap(_eq_rows_new);
+        _lb_x_idx.swap(_lb_x_idx_new);
+        _ub_x_idx.swap(_ub_x_idx_new);
+        _lb_y_rows.swap(_lb_y_rows_new);
+        _ub_y_rows.swap(_ub_y_rows_new);
+    }
+    return changed;
+}
+
+bool EiquadprogSolver::solveWithActiveSet(const wbc::QuadraticProgram& qp, base::VectorXd& solver_output){
+
+    const double tol = 1e-9;
+    const int n_var = qp.nq;
+    const int n_eq = _CE_mtx.rows();
+    const int n_act = _active_set.size();
+
+    // No previous solution available or too many active constraints for a unique solution
+    if(!_has_active_set || n_eq + n_act > n_var || qp.g.size() != n_var)
+        return false;
+
+    // Equality constrained QP with all active constraints C*x + c0 = 0. KKT conditions: H*x + g = C^T*lambda
+    // -> x = H^-1 * (C^T*lambda - g), (C*H^-1*C^T) * lambda = C*H^-1*g - c0
+    _C_act.resize(n_eq + n_act, n_var);
+    _c0_act.resize(n_eq + n_act);
+    _C_act.topRows(n_eq) = _CE_mtx;
+    _c0_act.head(n_eq) = _ce0_vec;
+    for(int i = 0; i < n_act; i++){
+        _C_act.row(n_eq + i) = _CI_mtx.row(_active_set[i]);
+        _c0_act(n_eq + i) = _ci0_vec(_active_set[i]);
+    }
+
+    _H_llt.compute(qp.H);
+    if(_H_llt.info() != Eigen::Success)
+        return false;
+    _Hinv_g = _H_llt.solve(qp.g);
+    if(n_eq + n_act > 0){
+        _Hinv_Ct = _H_llt.solve(_C_act.transpose());
+        _S.noalias() = _C_act * _Hinv_Ct;
+        _rhs.noalias() = _C_act * _Hinv_g;
+        _rhs -= _c0_act;
+        _lambda = _S.ldlt().solve(_rhs);
+        if(!_lambda.allFinite() || (_S*_lambda - _rhs).norm() > tol * (1 + _rhs.norm()))
+            return false;
+        solver_output.noalias() = _Hinv_Ct * _lambda;
+        solver_output -= _Hinv_g;
+    }
+    else
+        solver_output = -_Hinv_g;
+
+    // Dual feasibility: Multipliers of the active inequality constraints have to be non-negative
+    for(int i = 0; i < n_act; i++){
+        if(_lambda(n_eq + i) < -tol)
+            return false;
+    }
+
+    // Primal feasibility: All inequality constraints have to be fulfilled
+    if(_CI_mtx.rows() > 0 && ((_CI_mtx * solver_output + _ci0_vec).array() < -tol).any())
+        return false;
+
+    return true;
+}
+
+void EiquadprogSolver::updateActiveSet(const base::VectorXd& x){
+    _active_set.clear();
+    for(int i = 0; i < _CI_mtx.rows(); i++){
+        if(fabs(_CI_mtx.row(i).dot(x) + _ci0_vec(i)) < 1e-9)
+            _active_set.push_back(i);
+    }
+    _has_active_set = true;
+}
+
 }
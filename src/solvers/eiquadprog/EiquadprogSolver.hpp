@@ -7,10 +7,13 @@
 #include <base/Time.hpp>
 
 #include <eiquadprog/eiquadprog-fast.hpp>
+#include <Eigen/Cholesky>
+#include <vector>
 
 namespace wbc {
 
 class HierarchicalQP;
+class QuadraticProgram;
 
 /**
  * @brief The QPOASESSolver class is a wrapper for the qp-solver qpoases (see https://www.coin-or.org/qpOASES/doc/3.0/manual.pdf). It solves problems of shape:
@@ -22,6 +25,13 @@ class HierarchicalQP;
  *             & lb(\mathbf{x}) \leq \mathbf{x} \leq ub(\mathbf{x})& \\
  *        \end{array}
  *  \f]
+ *
+ * Rows of A with lb(Ax) = ub(Ax) are passed to eiquadprog as equality constraints, all other bounds as one inequality each. Infinite bounds are skipped.
+ * The constant parts of the constraint matrices (bounds on x) are only rewritten if the partition of the constraints changes.
+ *
+ * If warm start is enabled (see setWarmStart()), the solver first checks if the active set of the previous solution is still optimal: It solves the
+ * equality constrained QP with all active constraints and accepts the solution if it is primal and dual feasible. Only if this check fails, eiquadprog
+ * solves the QP from scratch. At high control frequencies, where the QP changes little between two cycles, this is the common case.
  */
 class EiquadprogSolver : public QPSolver{
 private:
@@ -45,20 +55,56 @@ public:
     /** Get the maximum number of working set recalculations to be performed during the initial homotopy*/
     uint getMaxNIter(){ return _n_iter; }
 
-    /** Get number of working set recalculations actually performed*/
+    /** Get number of working set recalculations actually performed. Zero if the solution has been obtained from the warm start*/
     int getNter(){ return _actual_n_iter; }
 
+    /** Enable/disable warm start from the active set of the previous solution. Default is false*/
+    void setWarmStart(bool enable){ _warm_start = enable; _has_active_set = false; }
+
+    /** Returns true if warm start is enabled*/
+    bool getWarmStart(){ return _warm_start; }
+
+    /** Returns true if the last solution has been obtained from the warm start, i.e., the active set of the previous solution was still optimal*/
+    bool isWarmStartSuccessful(){ return _warm_start_successful; }
+
 protected:
     eiquadprog::solvers::EiquadprogFast _solver;
     
     int _n_iter;
     int _actual_n_iter;
+    bool _warm_start;
+    bool _warm_start_successful;
+    bool _has_active_set;
 
     Eigen::MatrixXd _CE_mtx;
     Eigen::VectorXd _ce0_vec;
 
     Eigen::MatrixXd _CI_mtx;
     Eigen::VectorXd _ci0_vec;
+
+    // Partition of the constraints. Index vectors of the rows of A that are equality constraints, and the finite lower/upper bounds on x and Ax
+    std::vector<int> _eq_rows, _lb_x_idx, _ub_x_idx, _lb_y_rows, _ub_y_rows;
+    // Partition of the current QP, computed in updatePartition(). Kept as members, so that their memory is reused
+    std::vector<int> _eq_rows_new, _lb_x_idx_new, _ub_x_idx_new, _lb_y_rows_new, _ub_y_rows_new;
+    Eigen::VectorXd _x;
+
+    // Warm start
+    std::vector<int> _active_set;      /** Rows of _CI_mtx that have been active in the previous solution */
+    Eigen::LLT<Eigen::MatrixXd> _H_llt;
+    Eigen::MatrixXd _C_act, _Hinv_Ct, _S;
+    Eigen::VectorXd _c0_act, _Hinv_g, _lambda, _rhs;
+
+    /** New solver with the same settings, used by solveBatch()*/
+    virtual QPSolver* createBatchSolver();
+
+    /** Compute the partition of the constraints of the given QP. Returns true if it differs from the current partition*/
+    bool updatePartition(const wbc::QuadraticProgram& qp);
+
+    /** Try to solve the QP with the active set of the previous solution. Returns true if the solution is optimal */
+    bool solveWithActiveSet(const wbc::QuadraticProgram& qp, base::VectorXd& solver_output);
+
+    /** Store the inequality constraints that are active at the given solution*/
+    void updateActiveSet(const base::VectorXd& x);
 };
 
 }
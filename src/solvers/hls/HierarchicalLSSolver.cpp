@@ -12,7 +12,8 @@ QPSolverRegistry<HierarchicalLSSolver> HierarchicalLSSolver::reg("hls");
 HierarchicalLSSolver::HierarchicalLSSolver() :
     no_of_joints(0),
     min_eigenvalue(1e-9),
-    max_solver_output_norm(10){
+    max_solver_output_norm(10),
+    decomposition(hls_svd){
 }
 
 HierarchicalLSSolver::~HierarchicalLSSolver(){
@@ -55,6 +56,8 @@ bool HierarchicalLSSolver::configure(const std::vector<int>& n_constraints_per_p
 
 void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output){
 
+    startSolve();
+
     if(!configured){
         uint n_joints;
         std::vector<int> n_constraints_per_prio;
@@ -66,18 +69,77 @@ void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, bas
             throw std::runtime_error("Solver has not been configured yet!");
     }
 
+    prepareInput(hierarchical_qp);
+    base::Time iter_start = base::Time::now();
+    stats.setup_time = (iter_start - solve_start).toSeconds();
+
+    is_fixed.assign(no_of_joints, false);
+    x_fixed.setZero(no_of_joints);
+    solveHierarchy(hierarchical_qp, x_fixed, solver_output);
+    stats.n_iter = 1;
+
+    // Bounds on the solution vector are taken from the highest priority and are valid for the whole hierarchy. If a joint violates its bounds,
+    // it is fixed at the violated bound (its joint weight is treated as zero on all priorities) and the hierarchy is solved again with the remaining joints.
+    // This way, the bounds cost at most one additional solution per joint.
+    const QuadraticProgram& qp = hierarchical_qp[0];
+    if(qp.lower_x.size() == 0 && qp.upper_x.size() == 0){
+        stats.iteration_time = (base::Time::now() - iter_start).toSeconds();
+        finishSolve(solver_output);
+        return;
+    }
+    if(qp.lower_x.size() != no_of_joints || qp.upper_x.size() != no_of_joints)
+        throw std::invalid_argument("Invalid solver input. Size of lower_x and upper_x has to be 0 or " + to_string(no_of_joints) +
+                                    ", but is " + to_string(qp.lower_x.size()) + " and " + to_string(qp.upper_x.size()));
+
+    for(uint iter = 0; iter < no_of_joints; iter++){
+        bool bounds_violated = false;
+        for(uint i = 0; i < no_of_joints; i++){
+            if(is_fixed[i])
+                continue;
+            if(solver_output(i) < qp.lower_x(i))
+                x_fixed(i) = qp.lower_x(i);
+            else if(solver_output(i) > qp.upper_x(i))
+                x_fixed(i) = qp.upper_x(i);
+            else
+                continue;
+            is_fixed[i] = true;
+            bounds_violated = true;
+            stats.n_active_set_changes++;
+        }
+        if(!bounds_violated)
+            break;
+        solveHierarchy(hierarchical_qp, x_fixed, solver_output);
+        stats.n_iter++;
+    }
+    stats.iteration_time = (base::Time::now() - iter_start).toSeconds();
+    finishSolve(solver_output);
+}
+
+QPSolver* HierarchicalLSSolver::createBatchSolver(){
+    HierarchicalLSSolver* solver = new HierarchicalLSSolver();
+    solver->setMinEigenvalue(min_eigenvalue);
+    solver->setMaxSolverOutputNorm(max_solver_output_norm);
+    solver->setDecomposition(decomposition);
+    if(configured){
+        std::vector<int> n_constraints_per_prio;
+        for(const auto& p : priorities)
+            n_constraints_per_prio.push_back(p.n_constraint_variables);
+        solver->configure(n_constraints_per_prio, no_of_joints);
+        for(uint prio = 0; prio < priorities.size(); prio++){
+            solver->priorities[prio].joint_weight_mat = priorities[prio].joint_weight_mat;
+            solver->priorities[prio].constraint_weight_mat = priorities[prio].constraint_weight_mat;
+        }
+    }
+    return solver;
+}
+
+void HierarchicalLSSolver::prepareInput(const wbc::HierarchicalQP &hierarchical_qp){
+
     // Check valid input
     if(hierarchical_qp.size() != priorities.size())
         throw std::invalid_argument("Invalid solver input. Number of priorities in solver: " + std::to_string(priorities.size())
                                     + ", Size of input vector: " + std::to_string(hierarchical_qp.size()));
 
-    solver_output.setZero(no_of_joints);
-
-    // Init projection matrix as identity, so that the highest priority can look for a solution in whole configuration space
-    proj_mat.setIdentity();
-
-    //////// Loop through all priorities
-
     for(uint prio = 0; prio < priorities.size(); prio++){
 
         if(hierarchical_qp[prio].A.rows()        != priorities[prio].n_constraint_variables ||
@@ -96,6 +158,32 @@ void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, bas
             setConstraintWeights(hierarchical_qp[prio].Wy, prio);
         if(hierarchical_qp.Wq.size() != 0)
             setJointWeights(hierarchical_qp.Wq, prio);
+    }
+}
+
+bool HierarchicalLSSolver::equalJointWeights(){
+    for(uint prio = 1; prio < priorities.size(); prio++){
+        if(priorities[prio].joint_weight_mat.diagonal() != priorities[0].joint_weight_mat.diagonal())
+            return false;
+    }
+    return true;
+}
+
+void HierarchicalLSSolver::solveHierarchy(const wbc::HierarchicalQP &hierarchical_qp, const base::VectorXd& x_init, base::VectorXd &solver_output){
+
+    if(decomposition == hls_cod && equalJointWeights()){
+        solveHierarchyNullSpace(hierarchical_qp, x_init, solver_output);
+        return;
+    }
+
+    solver_output = x_init;
+
+    // Init projection matrix as identity, so that the highest priority can look for a solution in whole configuration space
+    proj_mat.setIdentity();
+
+    //////// Loop through all priorities
+
+    for(uint prio = 0; prio < priorities.size(); prio++){
 
         priorities[prio].y_comp.setZero();
 
@@ -112,10 +200,11 @@ void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, bas
         for(uint i = 0; i < priorities[prio].n_constraint_variables; i++)
             priorities[prio].A_proj_w.row(i) = priorities[prio].constraint_weight_mat(i,i) * priorities[prio].A_proj.row(i);
 
+        // Joints that have been fixed at their bounds get zero weight, i.e., they do not contribute to the solution anymore
         for(uint i = 0; i < no_of_joints; i++)
-            priorities[prio].A_proj_w.col(i) = priorities[prio].joint_weight_mat(i,i) * priorities[prio].A_proj_w.col(i);
+            priorities[prio].A_proj_w.col(i) = (is_fixed[i] ? 0 : priorities[prio].joint_weight_mat(i,i)) * priorities[prio].A_proj_w.col(i);
 
-        svd_eigen_decomposition(priorities[prio].A_proj_w, priorities[prio].U, s_vals, sing_vect_r, tmp);
+        svd_decomposition(priorities[prio].A_proj_w, priorities[prio].U, s_vals, sing_vect_r, tmp);
 
         // Compute damping factor based on
         // A.A. Maciejewski, C.A. Klein, “Numerical Filtering for the Operation of
@@ -149,7 +238,7 @@ void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, bas
             priorities[prio].u_t_weight_mat.col(i) = priorities[prio].u_t_weight_mat.col(i) * priorities[prio].constraint_weight_mat(i,i);
 
         for(uint i = 0; i < no_of_joints; i++)
-            Wq_V.row(i) = priorities[prio].joint_weight_mat(i,i) * sing_vect_r.row(i);
+            Wq_V.row(i) = (is_fixed[i] ? 0 : priorities[prio].joint_weight_mat(i,i)) * sing_vect_r.row(i);
 
         for(uint i = 0; i < no_of_joints; i++)
             Wq_V_s_vals_inv.col(i) = Wq_V.col(i) * s_vals_inv(i,i);
@@ -176,6 +265,117 @@ void HierarchicalLSSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, bas
     ///////////////
 }
 
+void HierarchicalLSSolver::solveHierarchyNullSpace(const wbc::HierarchicalQP &hierarchical_qp, const base::VectorXd& x_init, base::VectorXd &solver_output){
+
+    solver_output = x_init;
+
+    // Joint weights are the same on all priorities. Joints that have been fixed at their bounds get zero weight
+    joint_weights_eff = priorities[0].joint_weight_mat.diagonal();
+    for(uint i = 0; i < no_of_joints; i++){
+        if(is_fixed[i])
+            joint_weights_eff(i) = 0;
+    }
+
+    // Init null space basis as identity, so that the highest priority can look for a solution in whole configuration space
+    null_space_basis.setIdentity(no_of_joints, no_of_joints);
+
+    const double s_threshold = 1/max_solver_output_norm;
+
+    for(uint prio = 0; prio < priorities.size(); prio++){
+
+        PriorityData& p = priorities[prio];
+        const uint nc = p.n_constraint_variables;
+        const uint nz = null_space_basis.cols();
+
+        // Compensate y for part of the solution already met in higher priorities
+        p.y_comp = hierarchical_qp[prio].lower_y - hierarchical_qp[prio].A*solver_output;
+        p.sing_vals.setZero();
+
+        // Null space of the higher priorities is empty, nothing left to do
+        if(nz == 0){
+            p.damping = 0;
+            p.solution_prio.setZero();
+            continue;
+        }
+
+        // Weighted constraint matrix in null space coordinates: A_Z = Wy * A * Wq * Z. With x = Wq * Z * u, the solution of this
+        // priority is the minimum norm solution of A_Z * u = Wy * y_comp.
+        Wq_Z = joint_weights_eff.asDiagonal() * null_space_basis;
+        A_Z.noalias() = hierarchical_qp[prio].A * Wq_Z;
+        for(uint i = 0; i < nc; i++){
+            A_Z.row(i) *= p.constraint_weight_mat(i,i);
+        }
+        y_w = p.constraint_weight_mat.diagonal().cwiseProduct(p.y_comp);
+
+        // A priority is well-conditioned if A_Z has full row rank and its smallest singular value is above the damping threshold (see solveHierarchy()).
+        // In this case no damping is required and the solution can be computed from a QR decomposition of A_Z^T = Q * R * P^T.
+        // The smallest singular value of A_Z is bounded from below by 1/||R^-1||_F.
+        bool well_conditioned = false;
+        if(nc <= nz){
+            qr.compute(A_Z.transpose());
+            if(qr.rank() == nc){
+                R_inv.setIdentity(nc, nc);
+                qr.matrixR().topLeftCorner(nc, nc).triangularView<Eigen::Upper>().solveInPlace(R_inv);
+                well_conditioned = (1.0 / R_inv.norm()) >= s_threshold;
+            }
+        }
+
+        if(well_conditioned){
+            // A_Z = P * R^T * Q^T -> u = Q_1 * R^-T * P^T * y_w, null space of A_Z is spanned by Q_2
+            y_w = qr.colsPermutation().transpose() * y_w;
+            qr.matrixR().topLeftCorner(nc, nc).triangularView<Eigen::Upper>().transpose().solveInPlace(y_w);
+            u.setZero(nz);
+            u.head(nc) = y_w;
+            u = qr.householderQ() * u;
+
+            // Apply Q to Z directly instead of forming Q explicitly
+            V_Z = null_space_basis;
+            V_Z.applyOnTheRight(qr.householderQ());
+            null_space_basis_next = V_Z.rightCols(nz - nc);
+            p.damping = 0;
+        }
+        else{
+            // Near singularities: Damped least squares solution based on the SVD of A_Z, same as in solveHierarchy()
+            U_Z.resize(nc, nz);
+            s_vals_Z.resize(nz);
+            V_Z.resize(nz, nz);
+            tmp_Z.resize(nz);
+            svd_decomposition(A_Z, U_Z, s_vals_Z, V_Z, tmp_Z);
+
+            // If nc > nz, the projected constraint matrix in solveHierarchy() has at least one zero singular value
+            double s_min = (nc > nz) ? 0 : s_vals_Z.head(nc).minCoeff();
+            if(s_min <= s_threshold/2)
+                p.damping = s_threshold/2;
+            else if(s_min >= s_threshold)
+                p.damping = 0;
+            else
+                p.damping = sqrt(s_min*(s_threshold-s_min));
+
+            u.noalias() = U_Z.transpose() * y_w;
+            uint rank = 0;
+            for(uint i = 0; i < nz; i++){
+                if(i < nc)
+                    u(i) *= s_vals_Z(i) / (s_vals_Z(i) * s_vals_Z(i) + p.damping * p.damping);
+                else
+                    u(i) = 0;
+                if(s_vals_Z(i) >= min_eigenvalue)
+                    rank++;
+            }
+            u = V_Z * u;
+
+            // Singular values are sorted in descending order, so the null space is spanned by the last nz-rank right singular vectors
+            null_space_basis_next.noalias() = null_space_basis * V_Z.rightCols(nz - rank);
+            p.sing_vals.head(nz) = s_vals_Z;
+        }
+
+        // x = x + Wq * Z * u
+        p.solution_prio.noalias() = Wq_Z * u;
+        solver_output += p.solution_prio;
+
+        null_space_basis.swap(null_space_basis_next);
+    }
+}
+
 void HierarchicalLSSolver::setJointWeights(const base::VectorXd& weights){
     if(!configured)
         throw std::runtime_error("setJointWeights: Solver has not been configured yet!");
@@ -2,6 +2,7 @@
 #define WBC_SOLVERS_HIERARCHICAL_LS_SOLVER_HPP
 
 #include <base/Eigen.hpp>
+#include <Eigen/QR>
 #include <vector>
 #include "../../core/QPSolverFactory.hpp"
 #include "../../core/QPSolver.hpp"
@@ -10,6 +11,18 @@ namespace wbc{
 
 class HierarchicalQP;
 
+/**
+ * @brief Decomposition used by the HierarchicalLSSolver.
+ *  hls_svd: Singular value decomposition of the projected constraint matrix on each priority. The null space is propagated as n x n projection matrix.
+ *  hls_cod: The null space of the higher priorities is propagated as basis Z (n x k), so that each priority is solved in k <= n variables.
+ *   Well-conditioned priorities are solved using a column pivoting QR decomposition. An SVD is only computed for priorities that need damping, i.e.,
+ *   near singularities. Produces the same results as hls_svd. Falls back to hls_svd if the joint weights differ between the priorities.
+ */
+enum HLSDecomposition{
+    hls_svd = 0,
+    hls_cod = 1
+};
+
 /**
  * @brief Implementation of the hierarchical weighted damped least squares solver (HWLS), similar to
  * Schutter, J. et al. “Constraint-based Task Specification and Estimation for Sensor-Based Robot Systems in the Presence of Geometric Uncertainty.” The International Journal of Robotics Research 26 (2007): 433 - 455.
@@ -29,6 +42,11 @@ class HierarchicalQP;
  * of priority level i.
  * The solver ensures a hierarchy between the different tasks using nullspace projections. That is, the equation system with the highest priority will be solved fully if (n_rows <= n_cols),
  * the eqn. system of the next priority will be solved in the nullspace of the priovious priority, and so on. Additionally the solver can include weights in joint space and task space.
+ *
+ * Bounds on the solution vector (lower_x/upper_x of the first priority) are handled by saturation: Joints that violate their bounds are fixed at the
+ * bound value and the remaining joints are used to solve the hierarchy again, until all bounds are respected.
+ *
+ * See HLSDecomposition for the available decompositions.
  */
 class HierarchicalLSSolver : public QPSolver{
 private:
@@ -87,7 +105,8 @@ public:
 
     /**
      * @brief solve Solve the given quadratic program
-     * @param hierarchical_qp Description of the hierarchical quadratic program to solve.
+     * @param hierarchical_qp Description of the hierarchical quadratic program to solve. If lower_x/upper_x of the first priority are not empty,
+     *                        they will be used as bounds on the solution vector for the whole hierarchy.
      * @param solver_output solution of the quadratic program
      */
     virtual void solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output);
@@ -135,6 +154,14 @@ public:
     /** Return the maximum norm term.*/
     double getMaxSolverOutputNorm(){return max_solver_output_norm;}
 
+    /**
+     * @brief Set the decomposition used to solve the hierarchy. Default is hls_svd.
+     */
+    void setDecomposition(HLSDecomposition type){decomposition = type;}
+
+    /** Return the decomposition used to solve the hierarchy*/
+    HLSDecomposition getDecomposition(){return decomposition;}
+
     /**
      * @brief Has configure() been  called already?
      */
@@ -156,9 +183,38 @@ protected:
     //Properties
     double min_eigenvalue;    /** Precision for eigenvalue inversion. Inverse of an Eigenvalue smaller than this will be set to zero*/
     double max_solver_output_norm;   /** Maximum norm of (J#) * y */
+    HLSDecomposition decomposition;  /** Decomposition used to solve the hierarchy */
 
     //Helpers
     base::VectorXd tmp;
+    base::VectorXd x_fixed;                  /** Values of the joints that have been fixed at their bounds*/
+    std::vector<bool> is_fixed;              /** True for all joints that have been fixed at their bounds*/
+
+    // Helpers for hls_cod
+    base::MatrixXd null_space_basis;         /** Basis of the null space of all higher priorities*/
+    base::MatrixXd null_space_basis_next;    /** Basis of the null space including the current priority*/
+    base::MatrixXd Wq_Z;                     /** Column weight matrix times null space basis*/
+    base::MatrixXd A_Z;                      /** Weighted constraint matrix in null space coordinates*/
+    base::MatrixXd R_inv;                    /** Inverse of the triangular factor of the QR decomposition*/
+    base::MatrixXd U_Z, V_Z;                 /** Singular vectors of A_Z*/
+    base::VectorXd s_vals_Z, y_w, u, tmp_Z;
+    base::VectorXd joint_weights_eff;       /** Joint weights, zero for joints fixed at their bounds*/
+    Eigen::ColPivHouseholderQR<base::MatrixXd> qr;
+
+    /** New solver with the same settings, configuration and weights, used by solveBatch()*/
+    virtual QPSolver* createBatchSolver();
+
+    /** Check the input sizes of the given hierarchical QP and apply its weights*/
+    void prepareInput(const wbc::HierarchicalQP &hierarchical_qp);
+
+    /** Returns true if the joint weights are the same on all priorities*/
+    bool equalJointWeights();
+
+    /** Solve the hierarchy once, starting from x_init. Joints that are fixed at their bounds will not be modified*/
+    void solveHierarchy(const wbc::HierarchicalQP &hierarchical_qp, const base::VectorXd& x_init, base::VectorXd &solver_output);
+
+    /** Same as solveHierarchy(), but propagates the null space as a basis and uses QR decompositions for well-conditioned priorities (hls_cod)*/
+    void solveHierarchyNullSpace(const wbc::HierarchicalQP &hierarchical_qp, const base::VectorXd& x_init, base::VectorXd &solver_output);
 };
 }
 #endif
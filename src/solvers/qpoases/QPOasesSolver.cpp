@@ -10,7 +10,14 @@ namespace wbc{
 
 QPSolverRegistry<QPOASESSolver> QPOASESSolver::reg("qpoases");
 
-QPOASESSolver::QPOASESSolver(){
+QPOASESSolver::QPOASESSolver() :
+    configured_nq(0),
+    configured_nc(0),
+    use_sparse(false),
+    sparse_idx(0),
+    use_qpb(false),
+    check_constant_matrices(false),
+    matrices_updated(true){
     n_wsr = 1000;
     options.setToFast();
     options.printLevel = PL_NONE;
@@ -27,91 +34,242 @@ void QPOASESSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
 
     const wbc::QuadraticProgram &qp = hierarchical_qp[0];
 
+    startSolve();
+
+    // qpOASES problems have a fixed size, reconfigure if the size of the QP has changed
+    if(configured && (qp.nq != configured_nq || qp.nc != configured_nc))
+        configured = false;
     if(!configured){
-        sq_problem = SQProblem(qp.A.cols(), qp.A.rows());
-        sq_problem.setOptions(options);
+        // QPs without constraint matrix are solved as box-constrained QP, which is cheaper
+        use_qpb = qp.nc == 0;
+        if(use_qpb){
+            qpb_problem = QProblemB(qp.nq);
+            qpb_problem.setOptions(options);
+        }
+        else{
+            sq_problem = SQProblem(qp.A.cols(), qp.A.rows());
+            sq_problem.setOptions(options);
+        }
+        configured_nq = qp.nq;
+        configured_nc = qp.nc;
         configured = true;
     }
-
-    // Have to convert to row-major order matrices. Eigen uses column major by default and
-    // qpoases expects the data to be arranged in row-major
-    A = qp.A;
-    H = qp.H;
+    bool initialised = use_qpb ? qpb_problem.isInitialised() : sq_problem.isInitialised();
 
     // Joint space upper and lower bounds
-    real_t *lb_ptr = 0;
-    real_t *ub_ptr = 0;
+    const real_t *lb_ptr = 0;
+    const real_t *ub_ptr = 0;
     if(qp.lower_x.size() > 0){
         if(qp.lower_x.size() != qp.nq)
             throw std::runtime_error("Number of joints in quadratic program is " + std::to_string(qp.nq)
                                      + ", but lower bound has size " + std::to_string(qp.lower_x.size()));
 
-        lb_ptr = (real_t*)qp.lower_x.data();
+        lb_ptr = qp.lower_x.data();
     }
     if(qp.upper_x.size() > 0){
         if(qp.upper_x.size() != qp.nq)
             throw std::runtime_error("Number of joints in quadratic program is " + std::to_string(qp.nq)
                                      + ", but lower bound has size " + std::to_string(qp.upper_x.size()));
-        ub_ptr = (real_t*)qp.upper_x.data();
+        ub_ptr = qp.upper_x.data();
     }
 
     // Constraint space upper and lower bounds
-    real_t *lbA_ptr = 0;
-    real_t *ubA_ptr = 0;
+    const real_t *lbA_ptr = 0;
+    const real_t *ubA_ptr = 0;
     if(qp.lower_y.size() > 0){
         if(qp.lower_y.size() != qp.nc)
             throw std::runtime_error("Number of constraints in quadratic program is " + std::to_string(qp.nc)
                                      + ", but lower bound has size " + std::to_string(qp.lower_y.size()));
-         lbA_ptr = (real_t*)qp.lower_y.data();
+         lbA_ptr = qp.lower_y.data();
     }
     if(qp.upper_y.size() > 0){
         if(qp.upper_y.size() != qp.nc)
             throw std::runtime_error("Number of constraints in quadratic program is " + std::to_string(qp.nc)
                                      + ", but lower bound has size " + std::to_string(qp.upper_y.size()));
-         ubA_ptr = (real_t*)qp.upper_y.data();
+         ubA_ptr = qp.upper_y.data();
     }
 
     // Constraint matrix
-    if(A.rows() != qp.nc || A.cols() != qp.nq)
+    if(qp.A.rows() != qp.nc || qp.A.cols() != qp.nq)
         throw std::runtime_error("Constraint matrix A should have size " + std::to_string(qp.nc) + "x" + std::to_string(qp.nq) +
-                                 "but has size " +  std::to_string(A.rows()) + "x" + std::to_string(A.cols()));
-    real_t *A_ptr = A.data();
+                                 "but has size " +  std::to_string(qp.A.rows()) + "x" + std::to_string(qp.A.cols()));
+    // qpOASES expects row-major data, which is the storage order of the constraint matrix in QuadraticProgram. qpOASES never writes to A, so it can be
+    // passed without copying
+    const real_t *A_ptr = qp.A.data();
 
     // Hessian matrix:
-    if(H.rows() != qp.nq || H.cols() != qp.nq)
+    if(qp.H.rows() != qp.nq || qp.H.cols() != qp.nq)
         throw std::runtime_error("Hessian matrix H should have size " + std::to_string(qp.nq) + "x" + std::to_string(qp.nq) +
-                                 "but has size " +  std::to_string(H.rows()) + "x" + std::to_string(H.cols()));
-    real_t *H_ptr = (real_t*)H.data();
+                                 "but has size " +  std::to_string(qp.H.rows()) + "x" + std::to_string(qp.H.cols()));
+    // H is symmetric, so that row-major and column-major storage are identical
+    const real_t *H_ptr = qp.H.data();
 
     // Gradient vector
-    real_t *g_ptr = 0;
+    const real_t *g_ptr = 0;
     if(qp.g.size() > 0){
         if(qp.g.size() != qp.nq)
             throw std::runtime_error("Gradient vector g should have size " + std::to_string(qp.nq) + "but has size " + std::to_string(qp.g.size()));
-        g_ptr = (real_t*)qp.g.data();
+        g_ptr = qp.g.data();
+    }
+
+    // If H and A are unchanged, qpOASES can reuse the existing matrix factorization. qpOASES keeps pointers to H and A, so they
+    // are cached in this case, in order to remain valid, even if the memory of the given QP changes
+    matrices_updated = true;
+    if(check_constant_matrices){
+        if(initialised && H_cached == qp.H && A_cached == qp.A)
+            matrices_updated = false;
+        else{
+            H_cached = qp.H;
+            A_cached = qp.A;
+        }
+        H_ptr = H_cached.data();
+        A_ptr = A_cached.data();
+    }
+
+    // If regularisation is enabled, qpOASES adds to the diagonal of semidefinite Hessians in place. Pass a copy then, so that neither the given QP nor the
+    // cached Hessian are modified. If the matrices are unchanged, qpOASES keeps using the (already regularised) copy of the previous call
+    if(options.enableRegularisation == BT_TRUE && matrices_updated && !use_sparse){
+        H = qp.H;
+        H_ptr = H.data();
+    }
+
+    // Sparse matrices: Compressed column storage. The pattern is only rebuilt (exact zeros are not stored) if it does not cover the nonzeros of the QP anymore.
+    // The pattern of H always contains the full diagonal, even if it is zero (e.g. the torque and contact force block of AccelerationSceneTSID), since qpOASES
+    // can only regularise a sparse Hessian by adding to existing diagonal entries
+    if(use_sparse && matrices_updated){
+        sparse_idx = 1 - sparse_idx;
+        SparseMatrixCCS& H_ccs = H_sparse[sparse_idx];
+        SparseMatrixCCS& A_ccs = A_sparse[sparse_idx];
+        if(!H_sparse_qp[sparse_idx] || !updateSparseValues(qp.H, H_ccs, true)){
+            toSparse(qp.H, H_ccs, true);
+            H_sparse_qp[sparse_idx] = std::make_shared<SymSparseMat>(qp.nq, qp.nq, H_ccs.innerIndexPtr(), H_ccs.outerIndexPtr(), H_ccs.valuePtr());
+            H_sparse_qp[sparse_idx]->createDiagInfo();
+        }
+        if(!A_sparse_qp[sparse_idx] || !updateSparseValues(qp.A, A_ccs, false)){
+            toSparse(qp.A, A_ccs, false);
+            A_sparse_qp[sparse_idx] = std::make_shared<SparseMatrix>(qp.nc, qp.nq, A_ccs.innerIndexPtr(), A_ccs.outerIndexPtr(), A_ccs.valuePtr());
+        }
+    }
+    SymSparseMat* H_sp = H_sparse_qp[sparse_idx].get();
+    SparseMatrix* A_sp = A_sparse_qp[sparse_idx].get();
+
+    // If a time budget is set, qpOASES is interrupted when the remaining time is exceeded
+    real_t cputime = 0;
+    real_t *cputime_ptr = 0;
+    if(!time_budget.isNull()){
+        cputime = remainingTime();
+        if(cputime <= 0){
+            handleFailure(qp, qp_deadline_exceeded, "QPOASESSolver: Time budget exceeded", solver_output);
+            return;
+        }
+        cputime_ptr = &cputime;
     }
 
     actual_n_wsr = n_wsr;
-    if(!sq_problem.isInitialised()){
-        ret_val = sq_problem.init(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, 0);
-        if(ret_val != SUCCESSFUL_RETURN){
-            options.print();
-            qp.print();
-            throw std::runtime_error("SQ Problem initialization failed with error " + std::to_string(ret_val));
+    solver_output.resize(qp.nq);
+    base::Time iter_start = base::Time::now();
+    stats.setup_time = (iter_start - solve_start).toSeconds();
+    stats.warm_start = initialised;
+    if(use_qpb){
+        if(!initialised){
+            if(use_sparse)
+                ret_val = qpb_problem.init(H_sp, g_ptr, lb_ptr, ub_ptr, actual_n_wsr, cputime_ptr);
+            else
+                ret_val = qpb_problem.init(H_ptr, g_ptr, lb_ptr, ub_ptr, actual_n_wsr, cputime_ptr);
+        }
+        else if(!matrices_updated)
+            ret_val = qpb_problem.hotstart(g_ptr, lb_ptr, ub_ptr, actual_n_wsr, cputime_ptr);
+        else{
+            // QProblemB has no hotstart with new Hessian. Re-initialize and use previous solution and active set as initial guess
+            Bounds guessed_bounds;
+            qpb_problem.getBounds(guessed_bounds);
+            qpb_problem.getPrimalSolution(solver_output.data());
+            if(use_sparse)
+                ret_val = qpb_problem.init(H_sp, g_ptr, lb_ptr, ub_ptr, actual_n_wsr, cputime_ptr, solver_output.data(), 0, &guessed_bounds);
+            else
+                ret_val = qpb_problem.init(H_ptr, g_ptr, lb_ptr, ub_ptr, actual_n_wsr, cputime_ptr, solver_output.data(), 0, &guessed_bounds);
         }
     }
     else{
-        ret_val = sq_problem.hotstart(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, 0);
-        if(ret_val != SUCCESSFUL_RETURN){
+        if(!initialised){
+            if(use_sparse)
+                ret_val = sq_problem.init(H_sp, g_ptr, A_sp, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr);
+            else
+                ret_val = sq_problem.init(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr);
+        }
+        else if(!matrices_updated)
+            ret_val = sq_problem.QProblem::hotstart(g_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr);
+        else if(use_sparse)
+            ret_val = sq_problem.hotstart(H_sp, g_ptr, A_sp, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr);
+        else
+            ret_val = sq_problem.hotstart(H_ptr, g_ptr, A_ptr, lb_ptr, ub_ptr, lbA_ptr, ubA_ptr, actual_n_wsr, cputime_ptr);
+    }
+    // Each working set recalculation adds or removes one constraint from the active set
+    stats.iteration_time = (base::Time::now() - iter_start).toSeconds();
+    stats.n_iter = stats.n_active_set_changes = actual_n_wsr;
+    if(ret_val != SUCCESSFUL_RETURN){
+        if(time_budget.isNull()){
             options.print();
             qp.print();
-            throw std::runtime_error("SQ Problem hotstart failed with error " + std::to_string(ret_val));
         }
+        // If qpOASES has been interrupted due to the time limit, it reports the number of performed working set recalculations
+        bool interrupted = cputime_ptr && ret_val == RET_MAX_NWSR_REACHED && actual_n_wsr < n_wsr;
+        // After a failure, the working set of qpOASES is not usable for a hotstart anymore. Re-initialize the problem in the next call
+        if(!interrupted)
+            configured = false;
+        handleFailure(qp, interrupted ? qp_deadline_exceeded : qp_failed,
+                      std::string(use_qpb ? "QProblemB" : "SQ Problem") + (use_sparse ? " (sparse)" : "") +
+                      (initialised ? " hotstart" : " initialization") + " failed with error " + std::to_string(ret_val), solver_output);
+        return;
     }
 
-    solver_output.resize(qp.nq);
-    if(sq_problem.getPrimalSolution( solver_output.data() ) == RET_QP_NOT_SOLVED)
-        throw std::runtime_error("SQ Problem getPrimalSolution() returned " + std::to_string(RET_QP_NOT_SOLVED));
+    returnValue ret = use_qpb ? qpb_problem.getPrimalSolution(solver_output.data()) : sq_problem.getPrimalSolution(solver_output.data());
+    if(ret == RET_QP_NOT_SOLVED){
+        configured = false;
+        handleFailure(qp, qp_failed, "SQ Problem getPrimalSolution() returned " + std::to_string(RET_QP_NOT_SOLVED), solver_output);
+        return;
+    }
+    finishSolve(solver_output);
+}
+
+template<typename Dense> bool QPOASESSolver::updateSparseValues(const Dense& dense, SparseMatrixCCS& sparse, bool full_diagonal){
+
+    if(dense.rows() != sparse.rows() || dense.cols() != sparse.cols())
+        return false;
+
+    const sparse_int_t* outer = sparse.outerIndexPtr();
+    const sparse_int_t* inner = sparse.innerIndexPtr();
+    double* values = sparse.valuePtr();
+    for(sparse_int_t j = 0; j < sparse.cols(); j++){
+        sparse_int_t k = outer[j];
+        for(sparse_int_t i = 0; i < sparse.rows(); i++){
+            double v = dense(i,j);
+            if(k < outer[j+1] && inner[k] == i)
+                values[k++] = v;
+            else if(v != 0 || (full_diagonal && i == j))
+                return false;
+        }
+    }
+    return true;
+}
+
+template<typename Dense> void QPOASESSolver::toSparse(const Dense& dense, SparseMatrixCCS& sparse, bool full_diagonal){
+
+    sparse.resize(dense.rows(), dense.cols());
+    Eigen::Matrix<sparse_int_t, Eigen::Dynamic, 1> nnz_per_col(dense.cols());
+    for(sparse_int_t j = 0; j < dense.cols(); j++){
+        nnz_per_col[j] = 0;
+        for(sparse_int_t i = 0; i < dense.rows(); i++)
+            nnz_per_col[j] += (dense(i,j) != 0 || (full_diagonal && i == j));
+    }
+    sparse.reserve(nnz_per_col);
+    for(sparse_int_t j = 0; j < dense.cols(); j++){
+        for(sparse_int_t i = 0; i < dense.rows(); i++){
+            if(dense(i,j) != 0 || (full_diagonal && i == j))
+                sparse.insert(i,j) = dense(i,j);
+        }
+    }
+    sparse.makeCompressed();
 }
 
 returnValue QPOASESSolver::getReturnValue(){
@@ -121,6 +279,7 @@ returnValue QPOASESSolver::getReturnValue(){
 void QPOASESSolver::setOptions(const qpOASES::Options& opt){
     options = opt;
     sq_problem.setOptions(opt);
+    qpb_problem.setOptions(opt);
 }
 
 void QPOASESSolver::setOptionsPreset(const qpOASES::optionPresets& opt){
@@ -145,6 +304,7 @@ void QPOASESSolver::setOptionsPreset(const qpOASES::optionPresets& opt){
     }
     }
     sq_problem.setOptions(options);
+    qpb_problem.setOptions(options);
 }
 
 }
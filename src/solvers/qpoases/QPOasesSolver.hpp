@@ -3,8 +3,10 @@
 
 #include "../../core/QPSolverFactory.hpp"
 #include "../../core/QPSolver.hpp"
+#include "../../core/QuadraticProgram.hpp"
 #include <qpOASES.hpp>
 #include <base/Time.hpp>
+#include <Eigen/SparseCore>
 
 namespace qpOASES {
 enum optionPresets{qp_default, qp_reliable, qp_fast, qp_unset};
@@ -12,8 +14,6 @@ enum optionPresets{qp_default, qp_reliable, qp_fast, qp_unset};
 
 namespace wbc {
 
-class HierarchicalQP;
-
 /**
  * @brief The QPOASESSolver class is a wrapper for the qp-solver qpoases (see https://www.coin-or.org/qpOASES/doc/3.0/manual.pdf). It solves problems of shape:
  *  \f[
@@ -24,6 +24,14 @@ class HierarchicalQP;
  *             & lb(\mathbf{x}) \leq \mathbf{x} \leq ub(\mathbf{x})& \\
  *        \end{array}
  *  \f]
+ *
+ * By default, H and A are passed as dense matrices. A is passed directly from the given QuadraticProgram without copying (qpOASES keeps a pointer to it until
+ * the next call of solve()). H is passed without copying as well, unless Hessian regularisation is enabled in the options (e.g. by the default preset qp_fast),
+ * since qpOASES then modifies the diagonal of semidefinite Hessians in place. In this case, H is copied to a solver-owned buffer. For QPs with many structural zeros (e.g. AccelerationSceneTSID, where the constraint matrix contains
+ * large zero blocks), sparse matrices can be used instead, see setUseSparseMatrices().
+ *
+ * If H and A are constant, e.g. for a joint space posture task with fixed weights, only the gradient and the bounds have to be updated in each cycle and
+ * qpOASES can reuse its matrix factorization, see setCheckConstantMatrices(). QPs without constraint matrix (nc = 0) are solved as box-constrained QP (qpOASES::QProblemB).
  */
 class QPOASESSolver : public QPSolver{
 private:
@@ -56,15 +64,53 @@ public:
     void setOptionsPreset(const qpOASES::optionPresets& opt);
     /** Get Quadratic program*/
     const qpOASES::SQProblem& getSQProblem(){return sq_problem;}
+    /** If true, H and A will be passed to qpOASES as sparse matrices (compressed column storage), so that qpOASES can exploit their sparsity in
+     *  all matrix-vector products. Only pays off if H and A contain a significant number of zeros. Default is false.*/
+    void setUseSparseMatrices(bool sparse){use_sparse = sparse;}
+    /** Returns true if H and A are passed to qpOASES as sparse matrices*/
+    bool getUseSparseMatrices(){return use_sparse;}
+    /** If true, H and A are compared to the matrices of the previous call. If both are unchanged, the hotstart only updates gradient and bounds and reuses the
+     *  existing matrix factorization (QProblem::hotstart() instead of SQProblem::hotstart()). This requires a copy of H and A whenever they change,
+     *  so only enable it if they are expected to be constant most of the time. Default is false.*/
+    void setCheckConstantMatrices(bool check){check_constant_matrices = check;}
+    /** Returns true if H and A are checked for changes*/
+    bool getCheckConstantMatrices(){return check_constant_matrices;}
+    /** Returns false if H and A have been detected as unchanged in the last call of solve(), i.e., if the matrix factorization has been reused*/
+    bool getMatricesUpdated(){return matrices_updated;}
+    /** Get box-constrained quadratic program. Only used if the QP has no constraint matrix (nc = 0)*/
+    const qpOASES::QProblemB& getQProblemB(){return qpb_problem;}
 
 protected:
     qpOASES::Options options;
     qpOASES::SQProblem sq_problem;
+    qpOASES::QProblemB qpb_problem;
     int n_wsr, actual_n_wsr;
+    int configured_nq, configured_nc;      /** Size of the QP the qpOASES problem has been created for*/
     qpOASES::returnValue ret_val;
-    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> H;
-    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> A;
     base::Time stamp;
+
+    // Sparse matrices are double buffered, since qpOASES keeps pointers to the matrices of the previous call. The sparse matrices and their qpOASES
+    // wrappers are kept between calls. Only the values are updated, unless a nonzero appears outside of the stored sparsity pattern
+    typedef Eigen::SparseMatrix<double, Eigen::ColMajor, qpOASES::sparse_int_t> SparseMatrixCCS;
+
+    /** Copy the values of the dense matrix to the stored entries of the sparse matrix. Returns false, without completing the copy, if the dense matrix
+     *  has a different size or a nonzero that is not part of the sparsity pattern (or, if full_diagonal is true, a diagonal entry that is not part of the pattern).
+     *  Entries of the pattern that are zero in the dense matrix are stored as explicit zeros*/
+    template<typename Dense> static bool updateSparseValues(const Dense& dense, SparseMatrixCCS& sparse, bool full_diagonal);
+    /** Build the sparse matrix from the nonzeros of the dense matrix. If full_diagonal is true, all diagonal entries are stored, even if they are zero*/
+    template<typename Dense> static void toSparse(const Dense& dense, SparseMatrixCCS& sparse, bool full_diagonal);
+    bool use_sparse;
+    uint sparse_idx;
+    SparseMatrixCCS H_sparse[2], A_sparse[2];
+    std::shared_ptr<qpOASES::SymSparseMat> H_sparse_qp[2];
+    std::shared_ptr<qpOASES::SparseMatrix> A_sparse_qp[2];
+
+    // Box-constrained QP. Copies of H and A of the previous call, used to detect constant matrices
+    bool use_qpb, check_constant_matrices, matrices_updated;
+    base::MatrixXd H_cached;
+    // Copy of the Hessian, which is passed to qpOASES if Hessian regularisation is enabled
+    base::MatrixXd H;
+    MatrixXdRowMajor A_cached;
 };
 
 }
@@ -20,15 +20,54 @@ QPSwiftSolver::~QPSwiftSolver(){
         QP_CLEANUP_dense(my_qp);
 }
 
-void QPSwiftSolver::toQpSwift(const wbc::QuadraticProgram &qp){
-    A.setZero();
-    G.setZero();
-    h.setZero();
-    b.setZero();
+bool QPSwiftSolver::updatePartition(const wbc::QuadraticProgram &qp){
+    bool changed = (is_equality.size() != qp.lower_y.size());
+    is_equality.resize(qp.lower_y.size());
+    for(uint i = 0; i < qp.lower_y.size(); i++){
+        bool eq = (qp.lower_y[i] == qp.upper_y[i]);
+        if(eq != is_equality[i]){
+            is_equality[i] = eq;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void QPSwiftSolver::resizeProblem(const wbc::QuadraticProgram &qp){
+    // Count equality / inequality constraints
+    n_dec = qp.nq, n_ineq = 0, n_eq = 0, n_bounds = qp.lower_x.size();
+    for(uint i = 0; i < is_equality.size(); i++){
+        if(is_equality[i])
+            n_eq++;
+        else
+            n_ineq+=2; // Inequality constraints require 2 entries, one for the upper and one for the lower bound
+    }
+    n_ineq += 2*n_bounds; // Model bounds on the decision variables as inequality constraints here
+
+    A.setZero(n_eq,n_dec);
+    b.setZero(n_eq);
+    G.setZero(n_ineq,n_dec);
+    h.setZero(n_ineq);
+    P.resize(n_dec,n_dec);
+    c.resize(n_dec);
+
+    // Bounds on the decision variables are the last rows of G and do not change
+    int k = n_ineq - 2*n_bounds;
+    for(uint i = 0; i < n_bounds; i++){
+        G(k++,i) = 1.0;
+        G(k++,i) = -1.0;
+    }
+
+    LOG_DEBUG_S << "n_dec:    " << n_dec    << std::endl;
+    LOG_DEBUG_S << "n_eq:     " << n_eq     << std::endl;
+    LOG_DEBUG_S << "n_ineq:   " << n_ineq   << std::endl;
+    LOG_DEBUG_S << "n_bounds: " << n_bounds << std::endl;
+}
 
+void QPSwiftSolver::toQpSwift(const wbc::QuadraticProgram &qp){
     int j = 0, k = 0;
     for(uint i = 0; i < qp.lower_y.size(); i++){
-        if(qp.lower_y[i] == qp.upper_y[i]){ // Equality constraints
+        if(is_equality[i]){ // Equality constraints
             A.row(j) = qp.A.row(i);
             b[j++]   = qp.lower_y[i];
         }
@@ -41,13 +80,16 @@ void QPSwiftSolver::toQpSwift(const wbc::QuadraticProgram &qp){
     }
     // Map bounds to Inequality constraints
     for(uint i = 0; i < n_bounds; i++){
-        G(k,i) = 1.0;
         h[k++] = qp.upper_x[i];
-        G(k,i) = -1.0;
         h[k++] = -qp.lower_x[i];
     }
     P = qp.H;
     c = qp.g;
+
+    // qpSWIFT provides no interface to update the numeric data of an existing problem, so the workspace has to be set up again.
+    // Free the previous one first.
+    if(my_qp)
+        QP_CLEANUP_dense(my_qp);
     my_qp = QP_SETUP_dense(n_dec,                   // Number decision variables
                            n_ineq,                  // Number inequality constraints
                            n_eq,                    // Number equality constraints
@@ -60,53 +102,35 @@ void QPSwiftSolver::toQpSwift(const wbc::QuadraticProgram &qp){
                            NULL,
                            COLUMN_MAJOR_ORDERING);
 
-
+    my_qp->options->maxit = max_iter;
+    my_qp->options->reltol = rel_tol;
+    my_qp->options->abstol = abs_tol;
+    my_qp->options->sigma = sigma;
+    my_qp->options->verbose = verbose_level;
 }
 
 void QPSwiftSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::VectorXd &solver_output){
 
+    startSolve();
+
     if(hierarchical_qp.size() != 1)
         throw std::runtime_error("QPSwiftSolver::solve: Number of task hierarchies must be 1 for the current implementation");
 
     const wbc::QuadraticProgram &qp = hierarchical_qp[0];
 
-    if(!configured){        
-        // Count equality / inequality constraints
-        n_dec = qp.nq, n_ineq = 0, n_eq = 0, n_bounds = qp.lower_x.size();
-        for(uint i = 0; i < qp.lower_y.size(); i++){
-            if(qp.lower_y[i] == qp.upper_y[i])
-                n_eq++;
-            else
-                n_ineq+=2; // Inequality constraints require 2 entries, one for the upper and one for the lower bound
-        }
-        n_ineq += 2*n_bounds; // Model bounds on the decision variables as inequality constraints here
-
-        A.resize(n_eq,n_dec);
-        b.resize(n_eq);
-        G.resize(n_ineq,n_dec);
-        h.resize(n_ineq);
-        P.resize(n_dec,n_dec);
-        c.resize(n_dec);
-        solver_output.resize(n_dec);
-
-        LOG_DEBUG_S << "n_dec:    " << n_dec    << std::endl;
-        LOG_DEBUG_S << "n_eq:     " << n_eq     << std::endl;
-        LOG_DEBUG_S << "n_ineq:   " << n_ineq   << std::endl;
-        LOG_DEBUG_S << "n_bounds: " << n_bounds << std::endl;
-
-        toQpSwift(qp);
-
-        my_qp->options->maxit = max_iter;
-        my_qp->options->reltol = rel_tol;
-        my_qp->options->abstol = abs_tol;
-        my_qp->options->sigma = sigma;
-        my_qp->options->verbose = verbose_level;
-        LOG_DEBUG_S << "Setup Time     : " << my_qp->stats->tsetup * 1000.0 << " ms" << std::endl;
+    // Re-detect the equality/inequality partition only if the pattern of lower_y == upper_y has changed
+    if(updatePartition(qp) || !configured || n_dec != (int)qp.nq || n_bounds != (int)qp.lower_x.size()){
+        resizeProblem(qp);
         configured = true;
     }
 
     toQpSwift(qp);
+    stats.setup_time = (base::Time::now() - solve_start).toSeconds();
     qp_int exit_code = QP_SOLVE(my_qp);
+    stats.setup_time += my_qp->stats->tsetup;
+    stats.iteration_time = my_qp->stats->tsolve;
+    stats.factorization_time = my_qp->stats->ldl_numeric;
+    stats.n_iter = my_qp->stats->IterationCount;
 
     switch(exit_code){
     case QP_OPTIMAL:{
@@ -124,18 +148,23 @@ void QPSwiftSolver::solve(const wbc::HierarchicalQP &hierarchical_qp, base::Vect
         LOG_DEBUG_S << "LDL Time       : " << my_qp->stats->ldl_numeric * 1000.0 << " ms" << std::endl;
         LOG_DEBUG_S << "Diff	       : " << (my_qp->stats->kkt_time - my_qp->stats->ldl_numeric) * 1000.0 << " ms" << std::endl;
         LOG_DEBUG_S << "Iterations     : " << my_qp->stats->IterationCount << std::endl;
-        throw std::runtime_error("QPSwiftSolver failed: Maximum Iterations reached");
+        handleFailure(qp, qp_failed, "QPSwiftSolver failed: Maximum Iterations reached", solver_output);
+        return;
     }
     case QP_FATAL:{
-        throw std::runtime_error("QPSwiftSolver failed: Unknown error");
+        handleFailure(qp, qp_failed, "QPSwiftSolver failed: Unknown error", solver_output);
+        return;
     }
     case QP_KKTFAIL:{
-        throw std::runtime_error("QPSwiftSolver failed:LDL Factorization failed");
+        handleFailure(qp, qp_failed, "QPSwiftSolver failed:LDL Factorization failed", solver_output);
+        return;
     }
     }
 
+    solver_output.resize(n_dec);
     for(uint i = 0; i < n_dec; i++)
         solver_output[i] = my_qp->x[i];
+    finishSolve(solver_output);
 }
 
 }
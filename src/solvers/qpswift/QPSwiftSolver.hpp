@@ -4,6 +4,7 @@
 #include "../../core/QPSolverFactory.hpp"
 #include "../../core/QPSolver.hpp"
 #include <qpSWIFT/qpSWIFT.h>
+#include <vector>
 
 namespace wbc {
 class QuadraticProgram;
@@ -29,7 +30,13 @@ protected:
     double abs_tol;     /** Absolute Tolerance */
     double sigma;       /** sigma desired */
     uint verbose_level; /** Verbose Levels, 0 - Print,  >0 - Print Everything */
+    std::vector<bool> is_equality; /** Partition of the constraints: true for all rows of the constraint matrix with lower_y == upper_y*/
 
+    /** Detect the partition into equality/inequality constraints. Returns true if it has changed since the last call*/
+    bool updatePartition(const QuadraticProgram &qp);
+    /** Resize the qpSWIFT problem matrices according to the current partition and write the (constant) bound rows*/
+    void resizeProblem(const QuadraticProgram &qp);
+    /** Write the numeric data of the given QP into the problem matrices and set up the qpSWIFT workspace*/
     void toQpSwift(const QuadraticProgram &qp);
 public:
     QPSwiftSolver();
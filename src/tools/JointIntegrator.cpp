@@ -18,77 +18,124 @@ void JointIntegrator::integrate(const base::samples::Joints& joint_state, base::
         }
     }
     else{
-         for(uint i = 0; i < cmd.size(); i++){
-             try{
-             switch(cmdMode(cmd[i]))
-             {
-                 case base::JointState::SPEED:
-                     cmd[i].position = joint_state[cmd.names[i]].position;
-                     break;
-                 case base::JointState::ACCELERATION:
-                     cmd[i].position = joint_state[cmd.names[i]].position;
-                     cmd[i].speed = joint_state[cmd.names[i]].speed;
-                     break;
-                 default:
-                     throw std::runtime_error("Invalid control mode");
-                 }
-             }
-             catch(base::samples::Joints::InvalidName e){
-                 LOG_ERROR_S << "Joint " << cmd.names[i] << " is in command vector, but not in joint state"<<std::endl;
-                 throw e;
-             }
-         }
-         initialized = true;
+        classify(cmd);
+        gather(cmd);
+        // Name lookups are only required if joint state and command have a different joint order
+        bool same_order = joint_state.names == cmd.names;
+        for(uint k = 0; k < joint_order.size(); k++){
+            uint i = joint_order[k];
+            try{
+                const base::JointState& js = same_order ? joint_state[i] : joint_state[cmd.names[i]];
+                position[k] = js.position;
+                if(k >= n_speed)
+                    speed[k] = js.speed;
+            }
+            catch(base::samples::Joints::InvalidName e){
+                LOG_ERROR_S << "Joint " << cmd.names[i] << " is in command vector, but not in joint state"<<std::endl;
+                throw e;
+            }
+        }
+        scatter(cmd);
+        initialized = true;
     }
-    prev_cmd = cmd;
+    prev_position.swap(position);
+    prev_speed.swap(speed);
 }
 
 void JointIntegrator::integrateRectangular(base::commands::Joints &cmd, double cycle_time){
-    for(uint i = 0; i < cmd.size(); i++)
-    {
-        double h = cycle_time;
-        double q_prev = prev_cmd[i].position;
-        double q_dot_prev = prev_cmd[i].speed;
-        double q_dot = cmd[i].speed;
-        double q_dotdot = cmd[i].acceleration;
-
-        switch(cmdMode(cmd[i]))
-        {
-        case base::JointState::SPEED:
-            cmd[i].position = q_prev + q_dot*h;
-            break;
-        case base::JointState::ACCELERATION:
-            cmd[i].speed = q_dot_prev + q_dotdot*h;
-            cmd[i].position = q_prev + cmd[i].speed*h;
-            break;
-        default:
-            throw std::runtime_error("Invalid control mode");
-        }
-    }
+    gather(cmd);
+    const uint n_acc = joint_order.size() - n_speed;
+    const double h = cycle_time;
+
+    position.head(n_speed) = prev_position.head(n_speed) + speed.head(n_speed)*h;
+
+    speed.tail(n_acc) = prev_speed.tail(n_acc) + acceleration.tail(n_acc)*h;
+    position.tail(n_acc) = prev_position.tail(n_acc) + speed.tail(n_acc)*h;
+    scatter(cmd);
 }
 
 void JointIntegrator::integrateTrapezoidal(base::commands::Joints &cmd, double cycle_time){
-    for(uint i = 0; i < cmd.size(); i++)
-    {
-        double h = cycle_time/2;
-        double q_prev = prev_cmd[i].position;
-        double qd_prev = prev_cmd[i].speed;
-        double qd = cmd[i].speed;
-        double qdd = cmd[i].acceleration;
-        double qdd_prev = cmd[i].acceleration;
-
-        switch(cmdMode(cmd[i]))
-        {
-        case base::JointState::SPEED:
-            cmd[i].position = q_prev + (qd+qd_prev)*h;
-            break;
-        case base::JointState::ACCELERATION:
-            cmd[i].speed = qd_prev + (qdd_prev+qdd)*h;
-            cmd[i].position = q_prev + (cmd[i].speed+qd_prev)*h;
-            break;
-        default:
+    gather(cmd);
+    const uint n_acc = joint_order.size() - n_speed;
+    const double h = cycle_time/2;
+
+    position.head(n_speed) = prev_position.head(n_speed) + (speed.head(n_speed) + prev_speed.head(n_speed))*h;
+
+    // The commanded acceleration is assumed to be constant within one cycle
+    speed.tail(n_acc) = prev_speed.tail(n_acc) + acceleration.tail(n_acc)*cycle_time;
+    position.tail(n_acc) = prev_position.tail(n_acc) + (speed.tail(n_acc) + prev_speed.tail(n_acc))*h;
+    scatter(cmd);
+}
+
+void JointIntegrator::classify(const base::commands::Joints &cmd){
+    std::vector<uint> order;
+    for(uint i = 0; i < cmd.size(); i++){
+        if(cmdMode(cmd[i]) == base::JointState::SPEED)
+            order.push_back(i);
+        else if(cmdMode(cmd[i]) != base::JointState::ACCELERATION)
             throw std::runtime_error("Invalid control mode");
+    }
+    n_speed = order.size();
+    for(uint i = 0; i < cmd.size(); i++){
+        if(cmdMode(cmd[i]) == base::JointState::ACCELERATION)
+            order.push_back(i);
+    }
+
+    if(initialized){
+        // Keep the previous state of each joint, but in the new order
+        base::VectorXd pos(cmd.size()), vel(cmd.size());
+        for(uint k = 0; k < joint_order.size(); k++){
+            pos[joint_order[k]] = prev_position[k];
+            vel[joint_order[k]] = prev_speed[k];
         }
+        for(uint k = 0; k < order.size(); k++){
+            prev_position[k] = pos[order[k]];
+            prev_speed[k] = vel[order[k]];
+        }
+    }
+    else{
+        prev_position.resize(cmd.size());
+        prev_speed.resize(cmd.size());
+    }
+    joint_order = order;
+    position.resize(cmd.size());
+    speed.resize(cmd.size());
+    acceleration.resize(cmd.size());
+}
+
+void JointIntegrator::gather(const base::commands::Joints &cmd){
+    if(!initialized && joint_order.size() != cmd.size())
+        throw std::runtime_error("JointIntegrator: Integrator has not been initialized, call integrate() first");
+    if(cmd.size() != joint_order.size())
+        throw std::runtime_error("JointIntegrator: Number of joints in command is " + std::to_string(cmd.size()) +
+                                 " but should be " + std::to_string(joint_order.size()) + ". Call reinit() if the joints have changed");
+    for(uint k = 0; k < joint_order.size(); k++){
+        const base::JointState& j = cmd[joint_order[k]];
+        position[k] = j.position;
+        speed[k] = j.speed;
+        acceleration[k] = j.acceleration;
+    }
+    if(!modesValid()){
+        classify(cmd);
+        gather(cmd);
+    }
+}
+
+bool JointIntegrator::modesValid() const{
+    const uint n_acc = joint_order.size() - n_speed;
+    return position.array().isNaN().all() &&
+           !speed.head(n_speed).array().isNaN().any() &&
+           speed.tail(n_acc).array().isNaN().all() &&
+           !acceleration.tail(n_acc).array().isNaN().any();
+}
+
+void JointIntegrator::scatter(base::commands::Joints &cmd) const{
+    for(uint k = 0; k < n_speed; k++)
+        cmd[joint_order[k]].position = position[k];
+    for(uint k = n_speed; k < joint_order.size(); k++){
+        base::JointState& j = cmd[joint_order[k]];
+        j.position = position[k];
+        j.speed = speed[k];
     }
 }
 
@@ -2,6 +2,8 @@
 #define JOINT_INTEGRATOR_HPP
 
 #include <base/commands/Joints.hpp>
+#include <base/Eigen.hpp>
+#include <vector>
 
 enum IntegrationMethod{
     NONE = -1,
@@ -13,12 +15,27 @@ namespace wbc {
 
 /**
  * @brief The JointIntegrator class implements different numerical integrators
+ *
+ * The integrator state is stored in contiguous vectors, in which the velocity controlled joints come first, followed by the acceleration controlled joints.
+ * The joints are classified by control mode only on initialization (and if the control mode of a joint changes), so that each integration step is a gather
+ * of the commanded values, one Eigen array operation per control mode and a scatter of the results. Current and previous state are swapped instead of copied.
  */
 class JointIntegrator{
     bool initialized;
-    base::commands::Joints prev_cmd;
+    uint n_speed;                       /** Number of velocity controlled joints*/
+    std::vector<uint> joint_order;      /** Command indices of the joints in the order of the state vectors*/
+    base::VectorXd position, speed, acceleration, prev_position, prev_speed;
+
+    /** Sort the joints by control mode. Keeps the previous state of the joints if already initialized. Throws if a joint has an invalid control mode*/
+    void classify(const base::commands::Joints &cmd);
+    /** Copy the commanded values to the state vectors. Reclassifies the joints if their control mode has changed*/
+    void gather(const base::commands::Joints &cmd);
+    /** Write the integrated values to the command*/
+    void scatter(base::commands::Joints &cmd) const;
+    /** Check if the gathered values match the control modes of the joints*/
+    bool modesValid() const;
 public:
-    JointIntegrator() : initialized(false){}
+    JointIntegrator() : initialized(false), n_speed(0){}
     /**
      * @brief Performs numerical from acceleration/velocity to positions
      * @param cmd Input joint command, wil be modified by the method
@@ -26,7 +43,9 @@ public:
      */
     void integrate(const base::samples::Joints& joint_state, base::commands::Joints &cmd, double cycle_time, IntegrationMethod method = TRAPEZOIDAL);
     /**
-     * @brief Performs numerical from acceleration/velocity to positions using rectangular method
+     * @brief Performs numerical from acceleration/velocity to positions using rectangular method. For acceleration controlled joints, the velocity is integrated first
+     *  and the new velocity is used to integrate the position, i.e. this is the semi-implicit (symplectic) Euler method
+     *  \f$\dot{q}_k = \dot{q}_{k-1} + \ddot{q}_k h\f$, \f$q_k = q_{k-1} + \dot{q}_k h\f$. For velocity controlled joints, it is the explicit Euler method.
      * @param cmd Input joint command, wil be modified by the method
      * @param cycle_time Period between two consecutive calls in seconds
      */
@@ -0,0 +1,90 @@
+#ifndef WBC_TOOLS_RING_BUFFER_HPP
+#define WBC_TOOLS_RING_BUFFER_HPP
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+namespace wbc {
+
+/**
+ * @brief Fixed-size ring buffer that keeps the last N entries. There must be a single writer (push()), which never blocks and never allocates.
+ *  Readers (latest()) may run concurrently in other threads: They copy the requested entries and afterwards discard those which might have been overwritten
+ *  by the writer in the meantime. Thus, the writer is never delayed by readers, but a reader may get fewer entries than requested if the writer is fast.
+ *  T should be a plain data type, since it is copied while it may be written.
+ */
+template <typename T> class RingBuffer{
+    // One slot more than the capacity, which is reserved for the entry that is currently written
+    std::vector<T> buffer;
+    // Number of entries the writer has started to write (n_started) and finished writing (n_written)
+    std::atomic<uint64_t> n_started, n_written;
+
+public:
+    RingBuffer(size_t capacity = 0) : buffer(capacity > 0 ? capacity + 1 : 0), n_started(0), n_written(0){}
+
+    /** Copy the entries of another buffer. Not thread-safe, i.e. there must be no concurrent push() on other.*/
+    RingBuffer(const RingBuffer& other) : buffer(other.buffer), n_started(other.n_written.load()), n_written(other.n_written.load()){}
+
+    /** Copy the entries of another buffer. Not thread-safe, i.e. there must be no concurrent push() or latest() on this buffer and no concurrent push() on other.*/
+    RingBuffer& operator=(const RingBuffer& other){
+        buffer = other.buffer;
+        n_started.store(other.n_written.load());
+        n_written.store(other.n_written.load());
+        return *this;
+    }
+
+    /** Change the capacity and clear the buffer. Not thread-safe.*/
+    void resize(size_t capacity){
+        buffer.assign(capacity > 0 ? capacity + 1 : 0, T());
+        n_started.store(0);
+        n_written.store(0);
+    }
+
+    /** Maximum number of entries*/
+    size_t capacity() const {return buffer.empty() ? 0 : buffer.size() - 1;}
+
+    /** Total number of entries that have been pushed since the last resize()*/
+    uint64_t totalCount() const {return n_written.load(std::memory_order_acquire);}
+
+    /** Add an entry and overwrite the oldest one if the buffer is full. Does nothing if the capacity is zero.*/
+    void push(const T& item){
+        if(buffer.empty())
+            return;
+        uint64_t n = n_written.load(std::memory_order_relaxed);
+        // Mark the slot as being written before overwriting it. The fence keeps the write below from becoming visible before the mark
+        n_started.store(n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        buffer[n % buffer.size()] = item;
+        n_written.store(n + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy the latest entries, oldest first. May be called concurrently to push().
+     * @param out Output vector
+     * @param n Maximum number of entries to copy
+     * @return Number of copied entries
+     */
+    size_t latest(std::vector<T>& out, size_t n) const{
+        const uint64_t n_slots = buffer.size();
+        const uint64_t head = n_written.load(std::memory_order_acquire);
+        const uint64_t count = std::min(std::min((uint64_t)n, head), (uint64_t)capacity());
+        out.resize(count);
+        for(uint64_t i = 0; i < count; i++)
+            out[i] = buffer[(head - count + i) % n_slots];
+
+        // The writer might have overwritten the oldest entries during the copy, including the slot it is currently writing. The fence makes sure
+        // that the marks of all writes which might have affected the copied entries are visible here
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t started_after = n_started.load(std::memory_order_relaxed);
+        const uint64_t first_valid = started_after > n_slots ? started_after - n_slots : 0;
+        const uint64_t first = head - count;
+        if(first_valid > first)
+            out.erase(out.begin(), out.begin() + std::min(first_valid - first, count));
+        return out.size();
+    }
+};
+
+} // namespace wbc
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef WBC_TOOLS_SE3_TOOLS_HPP
+#define WBC_TOOLS_SE3_TOOLS_HPP
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+#include <cmath>
+#include <stdexcept>
+
+/**
+ * Fixed-size helper functions for rotations and pose errors, which are used in the control loop of the controllers and scenes.
+ * All functions work directly on quaternions and rotation matrices, without intermediate conversions to angle-axis. Except for resizing the output of
+ * poseErrors(), they do not allocate memory.
+ */
+
+namespace wbc{
+
+/**
+ * @brief Logarithmic map of SO(3): Rotation vector (axis * angle) of the rotation given by the quaternion, with angle in [0,pi]. The quaternion
+ *  does not have to be normalized.
+ */
+inline Eigen::Vector3d rotationLog(const Eigen::Quaterniond& q){
+    // q and -q are the same rotation. Use the one with w >= 0, which gives the shortest rotation
+    const double sign = q.w() < 0 ? -1.0 : 1.0;
+    const double s = q.vec().norm();
+    // angle/sin(angle/2) = 2*atan2(s,w)/s, which approaches 2/w for small angles
+    const double factor = s < 1e-8 ? 2.0 / (sign * q.w()) : 2.0 * std::atan2(s, sign * q.w()) / s;
+    return (sign * factor) * q.vec();
+}
+
+/**
+ * @brief Rotation error between the orientations a and b, i.e., the rotation vector of a*b^-1. This is the angular part of base::operator-(Pose,Pose).
+ */
+inline Eigen::Vector3d rotationError(const Eigen::Quaterniond& a, const Eigen::Quaterniond& b){
+    return rotationLog(a * b.conjugate());
+}
+
+/**
+ * @brief Pose error (linear, angular) between the poses a and b, see base::operator-(Pose,Pose)
+ */
+inline Eigen::Matrix<double,6,1> poseError(const Eigen::Vector3d& pos_a, const Eigen::Quaterniond& rot_a, const Eigen::Vector3d& pos_b, const Eigen::Quaterniond& rot_b){
+    Eigen::Matrix<double,6,1> err;
+    err.head<3>() = pos_a - pos_b;
+    err.tail<3>() = rotationError(rot_a, rot_b);
+    return err;
+}
+
+/**
+ * @brief Batched pose error, see poseError().
+ * @param a Poses a, one per column: Position (x,y,z) and orientation quaternion (x,y,z,w)
+ * @param b Poses b, same format and size as a
+ * @param err Pose errors (linear, angular), one per column. Will be resized to the number of poses
+ */
+inline void poseErrors(const Eigen::MatrixXd& a, const Eigen::MatrixXd& b, Eigen::MatrixXd& err){
+    if(a.rows() != 7 || b.rows() != 7 || a.cols() != b.cols())
+        throw std::invalid_argument("poseErrors: Poses have to be of size 7 x n");
+    err.resize(6, a.cols());
+    err.topRows<3>() = a.topRows<3>() - b.topRows<3>();
+    for(Eigen::Index j = 0; j < a.cols(); j++)
+        err.col(j).tail<3>() = rotationError(Eigen::Map<const Eigen::Quaterniond>(a.col(j).data() + 3),
+                                             Eigen::Map<const Eigen::Quaterniond>(b.col(j).data() + 3));
+}
+
+/**
+ * @brief Rotate linear and angular part of one or more 6D vectors (e.g. twists, wrenches, spatial accelerations) with the same rotation matrix.
+ *  Both parts are rotated in a single 3x3 times 3x(2n) matrix product.
+ * @param rot Rotation matrix
+ * @param in 6D vectors, one per column. Has to be stored contiguously
+ * @param out Rotated vectors, same size as in. Has to be stored contiguously and must not alias in
+ */
+template<typename In, typename Out> inline void rotateVector6(const Eigen::Matrix3d& rot, const Eigen::MatrixBase<In>& in, Eigen::MatrixBase<Out>& out){
+    typedef Eigen::Map<const Eigen::Matrix<double, 3, Eigen::Dynamic> > ConstMap3Xd;
+    typedef Eigen::Map<Eigen::Matrix<double, 3, Eigen::Dynamic> > Map3Xd;
+    Map3Xd(out.derived().data(), 3, 2*in.cols()).noalias() = rot * ConstMap3Xd(in.derived().data(), 3, 2*in.cols());
+}
+
+/**
+ * @brief Rotate 6D weight vectors, see rotateVector6(). Since weights can only assume positive values, the absolute values are taken after rotation.
+ */
+template<typename In, typename Out> inline void rotateWeights6(const Eigen::Matrix3d& rot, const Eigen::MatrixBase<In>& in, Eigen::MatrixBase<Out>& out){
+    rotateVector6(rot, in, out);
+    out.derived() = out.derived().cwiseAbs();
+}
+
+}
+
+#endif
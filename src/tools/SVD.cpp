@@ -1,4 +1,6 @@
 #include "SVD.hpp"
+#include <Eigen/QR>
+#include <limits>
 
 namespace wbc {
 
@@ -250,4 +252,141 @@ int svd_eigen_decomposition(const base::MatrixXd& A,
             return (0);
 }
 
+/** Apply the plane rotation [c s; -s c] to the columns x and y of length n*/
+static inline void rotateColumns(double* x, double* y, const int n, const double c, const double s){
+    for(int i = 0; i < n; i++){
+        const double xi = x[i];
+        const double yi = y[i];
+        x[i] = c*xi - s*yi;
+        y[i] = s*xi + c*yi;
+    }
+}
+
+/** One-sided Jacobi (Hestenes) on the square matrix Y: Rotate pairs of columns until all columns are mutually orthogonal.
+ *  On return Y contains the orthogonalized columns, V the accumulated rotations, i.e., Y_in * V = Y_out. Returns the number of sweeps.
+ *  Columns are contiguous in the column-major storage, so the inner loops run over plain arrays and can be vectorized by the compiler.*/
+static int jacobiSweeps(base::MatrixXd& Y, base::MatrixXd& V, base::VectorXd& col_norms, int maxiter, double epsilon){
+    const int n = Y.cols();
+    const double tol = std::numeric_limits<double>::epsilon() * std::max(n, 1);
+
+    V.setIdentity(n, n);
+    double* y = Y.data();
+    double* v = V.data();
+
+    int its;
+    for(its = 0; its < maxiter; its++){
+        for(int j = 0; j < n; j++)
+            col_norms(j) = Y.col(j).squaredNorm();
+
+        bool rotated = false;
+        for(int p = 0; p < n-1; p++){
+            double* yp = y + p*n;
+            for(int q = p+1; q < n; q++){
+                double* yq = y + q*n;
+                const double alpha = col_norms(p);
+                const double beta = col_norms(q);
+                if(alpha <= epsilon || beta <= epsilon)
+                    continue;
+                double gamma = 0;
+                for(int i = 0; i < n; i++)
+                    gamma += yp[i]*yq[i];
+                if(fabs(gamma) <= tol * sqrt(alpha*beta))
+                    continue;
+
+                // Rotation angle that makes columns p and q orthogonal
+                const double zeta = (beta - alpha) / (2.0 * gamma);
+                const double t = SIGN(1.0, zeta) / (fabs(zeta) + sqrt(1.0 + zeta*zeta));
+                const double c = 1.0 / sqrt(1.0 + t*t);
+                rotateColumns(yp, yq, n, c, c*t);
+                rotateColumns(v + p*n, v + q*n, n, c, c*t);
+                col_norms(p) = alpha - t*gamma;
+                col_norms(q) = beta + t*gamma;
+                rotated = true;
+            }
+        }
+        if(!rotated)
+            break;
+    }
+    return its;
+}
+
+int svd_jacobi_decomposition(const base::MatrixXd& A,
+                             base::MatrixXd& U,
+                             base::VectorXd& S,
+                             base::MatrixXd& V,
+                             base::VectorXd& tmp,
+                             int maxiter,
+                             double epsilon){
+    const int rows = A.rows();
+    const int cols = A.cols();
+    const bool wide = rows < cols;
+    const int k = std::min(rows, cols);
+
+    // Precondition with a column pivoting QR decomposition of B = A (rows >= cols) or B = A^T (rows < cols): B * P = Q * R.
+    // The Jacobi iteration then only has to orthogonalize the k x k triangular factor, which is small for the wide matrices in
+    // whole-body control and converges in few sweeps, since the pivoting sorts the rows/columns of R by magnitude.
+    Eigen::ColPivHouseholderQR<base::MatrixXd> qr(wide ? base::MatrixXd(A.transpose()) : A);
+    base::MatrixXd Y = qr.matrixQR().topLeftCorner(k,k).triangularView<Eigen::Upper>();
+    base::MatrixXd W;
+    if(wide)
+        Y.transposeInPlace();
+
+    // Y * W = U_Y * S_Y, with orthogonal W
+    int its = jacobiSweeps(Y, W, tmp, maxiter, epsilon);
+
+    // Singular values are the column norms, left singular vectors of Y are the normalized columns
+    S.setZero();
+    for(int j = 0; j < k; j++){
+        S(j) = Y.col(j).norm();
+        if(S(j) > epsilon)
+            Y.col(j) /= S(j);
+        else
+            Y.col(j).setZero();
+    }
+
+    U.setZero();
+    if(wide){
+        // A^T * P = Q * R, R^T = Y -> R^T * W = U_Y * S_Y -> A = (P * U_Y) * S_Y * (Q_1 * W)^T
+        U.topLeftCorner(rows,rows) = qr.colsPermutation() * Y;
+        V = qr.householderQ();
+        V.leftCols(rows) = V.leftCols(rows) * W;
+    }
+    else{
+        // A * P = Q * R, R = Y -> R * W = U_Y * S_Y -> A = (Q_1 * U_Y) * S_Y * (P * W)^T
+        U.topLeftCorner(k,k) = Y;
+        U.applyOnTheLeft(qr.householderQ());
+        V = qr.colsPermutation() * W;
+    }
+
+    //Sort singular values:
+    for(int i = 0; i < k; i++){
+        int i_max;
+        S.segment(i, k-i).maxCoeff(&i_max);
+        i_max += i;
+        if(i_max != i){
+            std::swap(S(i), S(i_max));
+            U.col(i).swap(U.col(i_max));
+            V.col(i).swap(V.col(i_max));
+        }
+    }
+
+    if(its == maxiter)
+        return (-2);
+    else
+        return (0);
+}
+
+int svd_decomposition(const base::MatrixXd& A,
+                      base::MatrixXd& U,
+                      base::VectorXd& S,
+                      base::MatrixXd& V,
+                      base::VectorXd& tmp,
+                      int maxiter,
+                      double epsilon){
+    if(A.cols() >= SVD_JACOBI_MIN_ASPECT_RATIO * A.rows())
+        return svd_jacobi_decomposition(A, U, S, V, tmp, maxiter, epsilon);
+    else
+        return svd_eigen_decomposition(A, U, S, V, tmp, maxiter, epsilon);
+}
+
 } // namespace wbc
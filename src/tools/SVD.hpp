@@ -27,6 +27,9 @@
 
 #include <base/Eigen.hpp>
 
+/** Min. ratio cols/rows for which svd_decomposition() uses svd_jacobi_decomposition()*/
+#define SVD_JACOBI_MIN_ASPECT_RATIO 3
+
 namespace wbc{
 
 inline double PYTHAG(double a,double b) {
@@ -58,6 +61,35 @@ int svd_eigen_decomposition(const base::MatrixXd& A,
                             int maxiter=150,
                             double epsilon=1e-300);
 
+/**
+ * @brief Singular value decomposition A = U * S * V^T based on one-sided Jacobi rotations. Same interface and output as svd_eigen_decomposition(), i.e.,
+ *  U has to be of size rows x cols, S of size cols, V of size cols x cols and tmp of size cols. Singular values are sorted in descending order.
+ *  The matrix is first reduced to a k x k triangular factor (k = min(rows,cols)) by a column pivoting QR decomposition. The Jacobi rotations then
+ *  operate on complete, contiguous matrix columns, so that the inner loops can be vectorized by the compiler. This is faster than svd_eigen_decomposition()
+ *  if k is small compared to max(rows,cols), e.g., for a few task space rows and many joints, but slower for square and near-square matrices of any size.
+ * @return 0 on success, -2 if the maximum number of sweeps has been reached
+ */
+int svd_jacobi_decomposition(const base::MatrixXd& A,
+                             base::MatrixXd& U,
+                             base::VectorXd& S,
+                             base::MatrixXd& V,
+                             base::VectorXd& tmp,
+                             int maxiter=150,
+                             double epsilon=1e-300);
+
+/**
+ * @brief Singular value decomposition with the same interface as svd_eigen_decomposition(). Selects the faster implementation at runtime based on the matrix shape:
+ *  svd_jacobi_decomposition() for wide matrices with cols >= SVD_JACOBI_MIN_ASPECT_RATIO * rows, e.g., a few task space rows and many joints,
+ *  and svd_eigen_decomposition() otherwise. The Jacobi kernel is slower for square and near-square matrices, e.g. 6x7 or 12x12 (see benchmarks/tools/benchmark_svd).
+ */
+int svd_decomposition(const base::MatrixXd& A,
+                      base::MatrixXd& U,
+                      base::VectorXd& S,
+                      base::MatrixXd& V,
+                      base::VectorXd& tmp,
+                      int maxiter=150,
+                      double epsilon=1e-300);
+
 }
 
 #endif // SVD_DECOMPOSITION_HPP
@@ -0,0 +1,55 @@
+#ifndef WBC_TOOLS_TRIPLE_BUFFER_HPP
+#define WBC_TOOLS_TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace wbc {
+
+/**
+ * @brief Wait-free triple buffer to pass the latest value of some data from a single writer thread to a single reader thread. The writer fills the write buffer
+ *  (writeBuffer()) and publishes it (publish()), the reader picks up the latest published value (update()) and reads it (readBuffer()). Neither side ever blocks
+ *  or allocates memory. Values that are published while the reader is not picking them up are overwritten, i.e., the reader always gets the newest value.
+ */
+template <typename T> class TripleBuffer{
+    // Index of the buffer that is neither written nor read, plus a flag that indicates that it contains a value which has not been picked up yet
+    static const uint8_t new_data = 4;
+    T buffers[3];
+    std::atomic<uint8_t> shared;
+    uint8_t write_idx, read_idx;
+
+public:
+    TripleBuffer() : shared(1), write_idx(0), read_idx(2){}
+
+    /** Initialize all three buffers with the given value. Not thread-safe.*/
+    void init(const T& value){
+        for(T& b : buffers)
+            b = value;
+        shared.store(1);
+        write_idx = 0;
+        read_idx = 2;
+    }
+
+    /** Buffer to be filled by the writer. Will not be accessed by the reader until publish() is called.*/
+    T& writeBuffer(){return buffers[write_idx];}
+
+    /** Publish the write buffer. Afterwards, writeBuffer() returns another buffer with undefined content.*/
+    void publish(){
+        write_idx = shared.exchange(write_idx | new_data, std::memory_order_acq_rel) & 3;
+    }
+
+    /** Pick up the latest published value, if there is one. Returns true if readBuffer() has changed.*/
+    bool update(){
+        if(!(shared.load(std::memory_order_relaxed) & new_data))
+            return false;
+        read_idx = shared.exchange(read_idx, std::memory_order_acq_rel) & 3;
+        return true;
+    }
+
+    /** Latest value that has been picked up by update()*/
+    const T& readBuffer() const {return buffers[read_idx];}
+};
+
+} // namespace wbc
+
+#endif
@@ -0,0 +1,87 @@
+#include "WorkerPool.hpp"
+#include <stdexcept>
+
+namespace wbc {
+
+WorkerPool::WorkerPool(uint n_workers) :
+    job(0),
+    generation(0),
+    n_pending(0),
+    stop(false){
+
+    if(n_workers == 0)
+        throw std::invalid_argument("WorkerPool: Number of workers has to be > 0");
+
+    errors.resize(n_workers);
+    for(uint i = 1; i < n_workers; i++)
+        threads.push_back(std::thread(&WorkerPool::workerLoop, this, i));
+}
+
+WorkerPool::~WorkerPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    start_cond.notify_all();
+    for(auto &t : threads)
+        t.join();
+}
+
+void WorkerPool::workerLoop(uint worker){
+
+    uint last_generation = 0;
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cond.wait(lock, [&]{return stop || generation != last_generation;});
+            if(stop)
+                return;
+            last_generation = generation;
+        }
+
+        try{
+            (*job)(worker);
+        }
+        catch(...){
+            errors[worker] = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            n_pending--;
+        }
+        done_cond.notify_one();
+    }
+}
+
+void WorkerPool::run(const std::function<void(uint)>& fn){
+
+    std::fill(errors.begin(), errors.end(), nullptr);
+
+    if(!threads.empty()){
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &fn;
+        n_pending = threads.size();
+        generation++;
+    }
+    start_cond.notify_all();
+
+    // The calling thread is worker 0
+    try{
+        fn(0);
+    }
+    catch(...){
+        errors[0] = std::current_exception();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cond.wait(lock, [&]{return n_pending == 0;});
+    }
+
+    for(auto &e : errors)
+        if(e)
+            std::rethrow_exception(e);
+}
+
+} // namespace wbc
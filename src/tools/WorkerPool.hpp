@@ -0,0 +1,50 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace wbc {
+
+/**
+ * @brief Persistent pool of worker threads. All workers execute the same function, which receives the worker index as argument, e.g.,
+ *  to select its share of the work and its own workspace. The calling thread acts as worker 0, so that a pool of size n spawns n-1 threads.
+ *  The threads are created once in the constructor and sleep between two calls of run().
+ */
+class WorkerPool{
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors;
+    const std::function<void(uint)>* job;
+    std::mutex mutex;
+    std::condition_variable start_cond, done_cond;
+    uint generation;
+    uint n_pending;
+    bool stop;
+
+    void workerLoop(uint worker);
+public:
+    /**
+     * @brief Create the worker pool
+     * @param n_workers Number of workers including the calling thread. Has to be > 0.
+     */
+    WorkerPool(uint n_workers);
+    ~WorkerPool();
+
+    /**
+     * @brief Execute the given function on all workers and block until all workers are done. If one of the workers throws,
+     *  the exception is rethrown in the calling thread after all workers have finished.
+     * @param fn Function to execute, argument is the worker index in [0,size()-1]
+     */
+    void run(const std::function<void(uint)>& fn);
+
+    /** @brief Number of workers, including the calling thread*/
+    uint size(){return threads.size() + 1;}
+};
+
+} // namespace wbc
+
+#endif
@@ -2,6 +2,8 @@
 #include <iostream>
 
 #include "controllers/JointTorquePIDController.hpp"
+#include "controllers/CartesianForcePIDController.hpp"
+#include "controllers/PIDControllerBank.hpp"
 #include <base/samples//RigidBodyStateSE3.hpp>
 
 using namespace std;
@@ -87,3 +89,87 @@ BOOST_AUTO_TEST_CASE(joint_torque_controller_test){
     }
 }
 
+
+BOOST_AUTO_TEST_CASE(pid_controller_bank_test){
+
+    // Without saturation and derivative filter, the bank has to give the same output as PIDController
+    PIDCtrlParams params(6);
+    params.p_gain = base::VectorXd::Random(6).cwiseAbs();
+    params.i_gain = base::VectorXd::Random(6).cwiseAbs();
+    params.d_gain = base::VectorXd::Random(6).cwiseAbs() * 0.01;
+    params.windup.setConstant(0.5);
+    base::VectorXd dead_zone = base::VectorXd::Constant(6, 0.01);
+
+    PIDController controller(6);
+    controller.setPID(params);
+    controller.setDeadZone(dead_zone);
+    PIDControllerBank6 bank;
+    bank.setPID(params);
+    bank.setDeadZone(dead_zone);
+    PIDControllerBankX bank_dyn(6);
+    bank_dyn.setPID(params);
+    bank_dyn.setDeadZone(dead_zone);
+
+    BOOST_CHECK_THROW(PIDControllerBank3(6), std::invalid_argument);
+    BOOST_CHECK_THROW(bank.setMaxCtrlOutput(base::VectorXd(3)), std::runtime_error);
+    BOOST_CHECK_THROW(bank_dyn.update(base::VectorXd::Zero(3), base::VectorXd::Zero(3), 0.01), std::invalid_argument);
+
+    // PIDController only accepts typed input, use a CartesianForcePIDController, which wraps the raw data
+    CartesianForcePIDController force_controller;
+    force_controller.setPID(params);
+    force_controller.setDeadZone(dead_zone);
+
+    const double dt = 0.01;
+    base::samples::Wrench setpoint, feedback;
+    for(int i = 0; i < 100; i++){
+        base::Vector6d ref = base::Vector6d::Random(), act = base::Vector6d::Random() * 0.1;
+        setpoint.force = ref.segment(0,3);
+        setpoint.torque = ref.segment(3,3);
+        feedback.force = act.segment(0,3);
+        feedback.torque = act.segment(3,3);
+        base::samples::RigidBodyStateSE3 expected = force_controller.update(setpoint, feedback, dt);
+        base::Vector6d out = bank.update(ref, act, dt);
+        base::VectorXd out_dyn = bank_dyn.update(ref, act, dt);
+        BOOST_CHECK((out.segment(0,3) - expected.twist.linear).norm() < 1e-9);
+        BOOST_CHECK((out.segment(3,3) - expected.twist.angular).norm() < 1e-9);
+        BOOST_CHECK((out - out_dyn).norm() < 1e-12);
+    }
+
+    // Saturation per channel and anti-windup: Integral does not grow while the channel is saturated
+    PIDCtrlParams params_i(3);
+    params_i.i_gain.setConstant(1);
+    PIDControllerBank3 bank_i;
+    bank_i.setPID(params_i);
+    bank_i.setMaxCtrlOutput(base::Vector3d(0.1, 0.1, 0.1));
+    for(int i = 0; i < 100; i++){
+        base::Vector3d out = bank_i.update(base::Vector3d(1, -1, 0), base::Vector3d::Zero(), dt);
+        BOOST_CHECK(out.cwiseAbs().maxCoeff() <= 0.1);
+    }
+    BOOST_CHECK(bank_i.getIntegral().cwiseAbs().maxCoeff() <= 0.1 + 1e-9);
+    BOOST_CHECK(fabs(bank_i.getControlOutput()(0) - 0.1) < 1e-9);
+    BOOST_CHECK(fabs(bank_i.getControlOutput()(1) + 0.1) < 1e-9);
+    BOOST_CHECK(bank_i.getControlOutput()(2) == 0);
+
+    // Windup is clamped per channel: A saturated integral does not shrink the integral of the other channels (unlike PIDController)
+    PIDCtrlParams params_w(3);
+    params_w.windup.setConstant(0.05);
+    PIDControllerBank3 bank_w;
+    bank_w.setPID(params_w);
+    for(int i = 0; i < 10; i++)
+        bank_w.update(base::Vector3d(1, 0.2, 0), base::Vector3d::Zero(), dt);
+    BOOST_CHECK(fabs(bank_w.getIntegral()(0) - 0.05) < 1e-9);
+    BOOST_CHECK(fabs(bank_w.getIntegral()(1) - 0.02) < 1e-9);
+    BOOST_CHECK(bank_w.getIntegral()(2) == 0);
+
+    // Derivative filter: Step in the control error gives a smaller, decaying derivative
+    PIDControllerBank3 bank_d;
+    BOOST_CHECK_THROW(bank_d.setDerivativeFilter(base::Vector3d(-1, 0, 0)), std::invalid_argument);
+    bank_d.setDerivativeFilter(base::Vector3d(0.1, 0.1, 0));
+    bank_d.update(base::Vector3d(1, 1, 1), base::Vector3d::Zero(), dt);
+    BOOST_CHECK(fabs(bank_d.getDerivative()(0) - 1.0 / dt * dt / (0.1 + dt)) < 1e-9);
+    BOOST_CHECK(fabs(bank_d.getDerivative()(2) - 1.0 / dt) < 1e-9);
+    double prev = bank_d.getDerivative()(0);
+    bank_d.update(base::Vector3d(1, 1, 1), base::Vector3d::Zero(), dt);
+    BOOST_CHECK(bank_d.getDerivative()(0) < prev && bank_d.getDerivative()(0) > 0);
+    BOOST_CHECK(bank_d.getDerivative()(2) == 0);
+}
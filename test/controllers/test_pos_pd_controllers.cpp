@@ -5,6 +5,7 @@
 #include "controllers/CartesianPosPDController.hpp"
 #include "controllers/JointPosPDController.hpp"
 #include <controllers/ControllerTools.hpp>
+#include <tools/SE3Tools.hpp>
 #include <base/samples/RigidBodyStateSE3.hpp>
 
 using namespace std;
@@ -177,3 +178,132 @@ BOOST_AUTO_TEST_CASE(jnt_pos_pd_controller){
     }
 }
 
+
+BOOST_AUTO_TEST_CASE(pos_pd_controller_rollout){
+    // The rollout has to give the same control output as calling update() for each sample
+    srand(0);
+    const int n = 50, n_gains = 3;
+    base::MatrixXd p_gains = base::MatrixXd::Random(6, n_gains).cwiseAbs();
+    base::MatrixXd d_gains = base::MatrixXd::Random(6, n_gains).cwiseAbs();
+    base::MatrixXd ff_gains = base::MatrixXd::Random(6, n_gains).cwiseAbs();
+
+    CartesianPosPDController ctrl;
+    ctrl.setMaxCtrlOutput(base::VectorXd::Constant(6, 0.5));
+    ctrl.setDeadZone(base::VectorXd::Constant(6, 0.01));
+
+    PosPDTrajectory traj;
+    traj.ref_pos.resize(7, n);
+    traj.pos.resize(7, n);
+    traj.ref_vel = traj.vel = traj.ref_acc = base::MatrixXd::Random(6, n);
+    traj.vel.setRandom();
+    traj.vel.col(3).setConstant(std::numeric_limits<double>::quiet_NaN());
+    traj.ref_acc.col(5)(2) = std::numeric_limits<double>::quiet_NaN();
+    std::vector<base::samples::RigidBodyStateSE3> setpoints(n), feedbacks(n);
+    for(int j = 0; j < n; j++){
+        setpoints[j].pose.position = traj.ref_pos.col(j).head<3>() = base::Vector3d::Random();
+        feedbacks[j].pose.position = traj.pos.col(j).head<3>() = base::Vector3d::Random();
+        setpoints[j].pose.orientation = Eigen::Quaterniond(Eigen::Vector4d::Random()).normalized();
+        feedbacks[j].pose.orientation = Eigen::Quaterniond(Eigen::Vector4d::Random()).normalized();
+        traj.ref_pos.col(j).tail<4>() = setpoints[j].pose.orientation.coeffs();
+        traj.pos.col(j).tail<4>() = feedbacks[j].pose.orientation.coeffs();
+        setpoints[j].twist.linear = traj.ref_vel.col(j).head<3>();
+        setpoints[j].twist.angular = traj.ref_vel.col(j).tail<3>();
+        feedbacks[j].twist.linear = traj.vel.col(j).head<3>();
+        feedbacks[j].twist.angular = traj.vel.col(j).tail<3>();
+        setpoints[j].acceleration.linear = traj.ref_acc.col(j).head<3>();
+        setpoints[j].acceleration.angular = traj.ref_acc.col(j).tail<3>();
+    }
+
+    std::vector<base::MatrixXd> out_vel, out_acc;
+    ctrl.rollout(traj, p_gains, d_gains, ff_gains, out_vel, out_acc);
+    BOOST_CHECK(out_vel.size() == n_gains && out_acc.size() == n_gains);
+    for(int g = 0; g < n_gains; g++){
+        ctrl.setPGain(p_gains.col(g));
+        ctrl.setDGain(d_gains.col(g));
+        ctrl.setFFGain(ff_gains.col(g));
+        for(int j = 0; j < n; j++){
+            base::samples::RigidBodyStateSE3 out = ctrl.update(setpoints[j], feedbacks[j]);
+            base::Vector6d vel, acc;
+            vel << out.twist.linear, out.twist.angular;
+            acc << out.acceleration.linear, out.acceleration.angular;
+            BOOST_CHECK((out_vel[g].col(j) - vel).norm() < 1e-9);
+            BOOST_CHECK((out_acc[g].col(j) - acc).norm() < 1e-9);
+        }
+    }
+
+    // Joint space, current gains of the controller, no velocity/acceleration
+    std::vector<std::string> joint_names = {"joint_a", "joint_b", "joint_c"};
+    JointPosPDController jnt_ctrl(joint_names);
+    jnt_ctrl.setPGain(base::Vector3d(1, 2, 3));
+    jnt_ctrl.setMaxCtrlOutput(base::Vector3d(1, 1, 1));
+    PosPDTrajectory jnt_traj;
+    jnt_traj.ref_pos = base::MatrixXd::Random(3, n);
+    jnt_traj.pos = base::MatrixXd::Random(3, n);
+    base::MatrixXd jnt_out_vel, jnt_out_acc;
+    jnt_ctrl.rollout(jnt_traj, jnt_out_vel, jnt_out_acc);
+    base::commands::Joints setpoint;
+    base::samples::Joints feedback;
+    setpoint.resize(3);
+    feedback.resize(3);
+    setpoint.names = feedback.names = joint_names;
+    for(int j = 0; j < n; j++){
+        for(int i = 0; i < 3; i++){
+            setpoint[i].position = jnt_traj.ref_pos(i,j);
+            feedback[i].position = jnt_traj.pos(i,j);
+        }
+        base::commands::Joints out = jnt_ctrl.update(setpoint, feedback);
+        for(int i = 0; i < 3; i++)
+            BOOST_CHECK(fabs(out[i].speed - jnt_out_vel(i,j)) < 1e-9);
+    }
+
+    // Invalid input
+    jnt_traj.vel = base::MatrixXd::Zero(3, n - 1);
+    BOOST_CHECK_THROW(jnt_ctrl.rollout(jnt_traj, jnt_out_vel, jnt_out_acc), std::runtime_error);
+    jnt_traj.vel.resize(0,0);
+    jnt_traj.pos(0,0) = std::numeric_limits<double>::quiet_NaN();
+    BOOST_CHECK_THROW(jnt_ctrl.rollout(jnt_traj, jnt_out_vel, jnt_out_acc), std::runtime_error);
+    BOOST_CHECK_THROW(ctrl.rollout(jnt_traj, jnt_out_vel, jnt_out_acc), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(pose_error){
+
+    /**
+     * Check if the pose error computed from the quaternions matches the error computed via rotation matrix and angle axis representation
+     */
+
+    srand(time(NULL));
+    for(int i = 0; i < 1000; i++){
+        base::Pose a, b;
+        a.position.setRandom();
+        b.position.setRandom();
+        a.orientation = base::Quaterniond(base::Vector4d::Random()).normalized();
+        // Include small rotations and quaternions with negative w
+        if(i % 2 == 0)
+            b.orientation = a.orientation * base::Quaterniond(Eigen::AngleAxisd(1e-3 * (double)rand()/RAND_MAX, base::Vector3d::Random().normalized()));
+        else
+            b.orientation = base::Quaterniond(base::Vector4d::Random()).normalized();
+        if(i % 3 == 0)
+            b.orientation.coeffs() *= -1;
+
+        base::Matrix3d rot_mat = b.orientation.toRotationMatrix().transpose() * a.orientation.toRotationMatrix();
+        Eigen::AngleAxisd angle_axis;
+        angle_axis.fromRotationMatrix(rot_mat);
+        // Axis is not unique for rotations of pi
+        if(angle_axis.angle() > M_PI - 1e-3)
+            continue;
+        base::Vector3d angular = b.orientation.toRotationMatrix() * (angle_axis.axis() * angle_axis.angle());
+
+        base::Twist diff = a - b;
+        BOOST_CHECK((diff.linear - (a.position - b.position)).norm() < 1e-12);
+        BOOST_CHECK((diff.angular - angular).norm() < 1e-9);
+    }
+
+    // Rotation of 6D vectors and weights
+    base::Matrix3d rot = base::Quaterniond(base::Vector4d::Random()).normalized().toRotationMatrix();
+    base::VectorXd in = base::VectorXd::Random(6), out(6), weights(6);
+    wbc::rotateVector6(rot, in, out);
+    wbc::rotateWeights6(rot, in, weights);
+    BOOST_CHECK((out.segment(0,3) - rot * in.segment(0,3)).norm() < 1e-12);
+    BOOST_CHECK((out.segment(3,3) - rot * in.segment(3,3)).norm() < 1e-12);
+    BOOST_CHECK((weights - out.cwiseAbs()).norm() < 1e-12);
+}
@@ -308,3 +308,162 @@ BOOST_AUTO_TEST_CASE(joint_limit_avoidance)
     }
 }
 
+
+BOOST_AUTO_TEST_CASE(joint_limit_avoidance_gradient)
+{
+    // The control output has to be the same as the gradient of a 1D radial field located at the closer joint limit
+    srand(0);
+    const uint dim = 40;
+    base::JointLimits limits;
+    base::VectorXd influence_distance(dim), p_gain(dim);
+    for(uint i = 0; i < dim; i++){
+        base::JointLimitRange range;
+        range.min.position = -1.0 - (double)rand() / RAND_MAX;
+        range.max.position = 1.0 + (double)rand() / RAND_MAX;
+        limits.names.push_back("joint_" + std::to_string(i));
+        limits.elements.push_back(range);
+        influence_distance(i) = 0.1 + 0.5 * (double)rand() / RAND_MAX;
+        p_gain(i) = (double)rand() / RAND_MAX;
+    }
+
+    JointLimitAvoidanceController controller(limits, influence_distance);
+    controller.setPGain(p_gain);
+
+    // Feedback contains additional joints in a different order
+    base::samples::Joints feedback;
+    for(int i = dim - 1; i >= 0; i--){
+        feedback.names.push_back("joint_" + std::to_string(i));
+        feedback.elements.push_back(base::JointState());
+        feedback.names.push_back("other_joint_" + std::to_string(i));
+        feedback.elements.push_back(base::JointState());
+    }
+
+    for(uint n = 0; n < 100; n++){
+        for(uint i = 0; i < dim; i++)
+            feedback["joint_" + std::to_string(i)].position = limits[i].min.position + (limits[i].max.position - limits[i].min.position) * (double)rand() / RAND_MAX;
+        base::commands::Joints control_out = controller.update(feedback);
+
+        for(uint i = 0; i < dim; i++){
+            double pos = feedback["joint_" + std::to_string(i)].position;
+            RadialPotentialField field(1);
+            field.influence_distance = influence_distance(i);
+            field.pot_field_center.setConstant(1, fabs(limits[i].max.position - pos) < fabs(pos - limits[i].min.position) ? limits[i].max.position : limits[i].min.position);
+            base::VectorXd pos_vect(1);
+            pos_vect << pos;
+            field.update(pos_vect);
+            BOOST_CHECK(fabs(control_out[i].speed - p_gain(i) * field.gradient(0)) < 1e-9);
+            BOOST_CHECK(fabs(controller.getFields()[i]->gradient(0) - field.gradient(0)) < 1e-9);
+            BOOST_CHECK(controller.getFields()[i]->pot_field_center(0) == field.pot_field_center(0));
+        }
+    }
+
+    // Missing joint in feedback
+    feedback.names[0] = "unknown_joint";
+    BOOST_CHECK_THROW(controller.update(feedback), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(spatial_index)
+{
+    // Many radial fields and a planar field. The spatial index has to give the same control output as the evaluation of all fields
+    srand(0);
+    std::vector<PotentialFieldPtr> fields;
+    for(uint i = 0; i < 500; i++){
+        PotentialFieldPtr field = std::make_shared<RadialPotentialField>(3, "radial_field_" + std::to_string(i));
+        field->influence_distance = 0.1 + 0.2 * (double)rand() / RAND_MAX;
+        field->pot_field_center = base::Vector3d::Random();
+        fields.push_back(field);
+    }
+    PlanarPotentialFieldPtr plane = std::make_shared<PlanarPotentialField>("planar_field");
+    plane->influence_distance = 0.5;
+    plane->pot_field_center << 0, 0, -1.2;
+    plane->n = base::Vector3d(0, 0, 1);
+    fields.push_back(plane);
+
+    CartesianPotentialFieldsController controller, controller_indexed;
+    controller.setFields(fields);
+    controller.setPGain(base::Vector3d(1, 1, 1));
+    controller_indexed.setSpatialIndex(true);
+    BOOST_CHECK(controller_indexed.getSpatialIndex());
+    controller_indexed.setFields(fields);
+    controller_indexed.setPGain(base::Vector3d(1, 1, 1));
+
+    base::samples::RigidBodyStateSE3 feedback;
+    for(uint i = 0; i < 100; i++){
+        feedback.pose.position = base::Vector3d::Random();
+        base::Vector3d expected = controller.update(feedback).twist.linear;
+        base::Vector3d actual = controller_indexed.update(feedback).twist.linear;
+        BOOST_CHECK((expected - actual).norm() < 1e-9);
+        BOOST_CHECK(controller_indexed.getActiveFields().size() < fields.size());
+
+        // Move one field and increase its influence distance, so that the index has to be rebuilt
+        uint idx = rand() % 500;
+        fields[idx]->pot_field_center = base::Vector3d::Random();
+        if(i % 10 == 0)
+            fields[idx]->influence_distance = 0.5;
+        controller_indexed.updateField(idx);
+    }
+
+    // Gradients of fields that have been evaluated before, but are out of range now, are reset
+    feedback.pose.position << 10, 10, 10;
+    controller_indexed.update(feedback);
+    for(auto f : fields){
+        if(f != plane)
+            BOOST_CHECK(base::isnotnan(f->gradient) && f->gradient.norm() == 0);
+    }
+
+    // Fields that have never been evaluated by the indexed controller have a zero gradient as well
+    for(uint i = 0; i < fields.size(); i++)
+        fields[i] = std::make_shared<RadialPotentialField>(3, "radial_field_" + std::to_string(i));
+    for(auto f : fields){
+        f->influence_distance = 0.1;
+        f->pot_field_center = base::Vector3d::Random();
+    }
+    controller_indexed.setFields(fields);
+    feedback.pose.position << 0, 0, 0;
+    controller_indexed.update(feedback);
+    for(auto f : fields){
+        BOOST_CHECK(base::isnotnan(f->gradient));
+        if(f->pot_field_center.norm() > f->influence_distance)
+            BOOST_CHECK(f->gradient.norm() == 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(range_filter)
+{
+    // Skipping radial fields out of range has to give the same gradients as the update() of each individual field
+    srand(0);
+    std::vector<PotentialFieldPtr> fields;
+    for(uint i = 0; i < 300; i++){
+        PotentialFieldPtr field = std::make_shared<RadialPotentialField>(3, "radial_field_" + std::to_string(i));
+        field->influence_distance = 0.1 + (double)rand() / RAND_MAX;
+        field->pot_field_center = base::Vector3d::Random();
+        fields.push_back(field);
+    }
+    for(uint i = 0; i < 10; i++){
+        PlanarPotentialFieldPtr plane = std::make_shared<PlanarPotentialField>("planar_field_" + std::to_string(i));
+        plane->influence_distance = 0.5 + (double)rand() / RAND_MAX;
+        plane->pot_field_center = base::Vector3d::Random() * 3;
+        plane->n = base::Vector3d::Random();
+        fields.push_back(plane);
+    }
+
+    CartesianPotentialFieldsController controller;
+    controller.setFields(fields);
+    controller.setPGain(base::Vector3d(1, 1, 1));
+
+    base::samples::RigidBodyStateSE3 feedback;
+    for(uint i = 0; i < 100; i++){
+        feedback.pose.position = base::Vector3d::Random();
+        base::Vector3d actual = controller.update(feedback).twist.linear;
+
+        base::Vector3d expected;
+        expected.setZero();
+        for(auto f : fields){
+            base::VectorXd gradient = f->gradient, distance = f->distance;
+            expected += f->update(feedback.pose.position);
+            BOOST_CHECK((gradient - f->gradient).norm() < 1e-9);
+            BOOST_CHECK((distance - f->distance).norm() < 1e-12);
+        }
+        BOOST_CHECK((expected - actual).norm() < 1e-9);
+    }
+}
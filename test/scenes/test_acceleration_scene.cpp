@@ -2,6 +2,8 @@
 #include "robot_models/kdl/RobotModelKDL.hpp"
 #include "core/RobotModelConfig.hpp"
 #include "scenes/AccelerationScene.hpp"
+#include "scenes/AccelerationSceneTSID.hpp"
+#include "scenes/AccelerationSceneReduced.hpp"
 #include "solvers/qpoases/QPOasesSolver.hpp"
 
 using namespace std;
@@ -91,3 +93,126 @@ BOOST_AUTO_TEST_CASE(simple_test){
         BOOST_CHECK(fabs(ydd[i+3] - ref.acceleration.angular[i]) < 1e5);
     }
 }
+
+BOOST_AUTO_TEST_CASE(tsid_formulation_test){
+
+    /**
+     * Check if the torque-eliminated formulation of AccelerationSceneTSID yields the same result as the full formulation, with dense and sparse solver input
+     */
+
+    ConstraintConfig cart_constraint("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+
+    shared_ptr<RobotModelKDL> robot_model = make_shared<RobotModelKDL>();
+    RobotModelConfig config;
+    config.file = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->jointNames();
+    for(auto n : robot_model->jointNames()){
+        base::JointState js;
+        js.position = 0.1;
+        js.speed = 0.1;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+
+    shared_ptr<QPOASESSolver> solver = std::make_shared<QPOASESSolver>();
+    solver->setMaxNoWSR(1000);
+    AccelerationSceneTSID wbc_scene(robot_model, solver);
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_constraint}), true);
+
+    base::samples::RigidBodyStateSE3 ref;
+    ref.acceleration.linear = base::Vector3d(0.1,0.2,0.3);
+    ref.acceleration.angular = base::Vector3d(0.1,0,0);
+
+    vector<base::commands::Joints> outputs;
+    // The sparse full formulation has a zero diagonal in the torque block of the Hessian, which has to be regularised by qpOASES
+    TSIDFormulation formulations[4] = {tsid_full, tsid_torque_eliminated, tsid_torque_eliminated, tsid_full};
+    for(int k = 0; k < 4; k++){
+        wbc_scene.setFormulation(formulations[k]);
+        solver->setUseSparseMatrices(k >= 2);
+        BOOST_CHECK_NO_THROW(wbc_scene.setReference(cart_constraint.name, ref));
+        HierarchicalQP qp;
+        BOOST_CHECK_NO_THROW(qp = wbc_scene.update());
+        if(formulations[k] == tsid_torque_eliminated)
+            BOOST_CHECK(qp[0].nq == robot_model->noOfJoints());
+        BOOST_CHECK_NO_THROW(outputs.push_back(wbc_scene.solve(qp)));
+    }
+
+    for(int k = 1; k < 4; k++){
+        for(uint i = 0; i < robot_model->noOfJoints(); i++){
+            BOOST_CHECK(fabs(outputs[0][i].acceleration - outputs[k][i].acceleration) < 1e-4);
+            BOOST_CHECK(fabs(outputs[0][i].effort - outputs[k][i].effort) < 1e-4);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(reduced_scene_test){
+
+    /**
+     * Check if AccelerationSceneReduced yields the same result as AccelerationSceneTSID and fulfills the rigid contact constraints
+     */
+
+    ConstraintConfig cart_constraint("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+
+    shared_ptr<RobotModelKDL> robot_model = make_shared<RobotModelKDL>();
+    RobotModelConfig config;
+    config.file = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    config.contact_points.names.push_back("kuka_lbr_l_link_6");
+    config.contact_points.elements.push_back(1);
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->jointNames();
+    for(auto n : robot_model->jointNames()){
+        base::JointState js;
+        js.position = 0.1;
+        js.speed = 0.1;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+
+    base::samples::RigidBodyStateSE3 ref;
+    ref.acceleration.linear = base::Vector3d(0.1,0.2,0.3);
+    ref.acceleration.angular = base::Vector3d(0.1,0,0);
+
+    vector<base::commands::Joints> outputs;
+    vector<uint> n_vars;
+    for(int k = 0; k < 2; k++){
+        shared_ptr<QPOASESSolver> solver = std::make_shared<QPOASESSolver>();
+        solver->setMaxNoWSR(1000);
+        WbcScenePtr wbc_scene;
+        if(k == 0)
+            wbc_scene = make_shared<AccelerationSceneTSID>(robot_model, solver);
+        else
+            wbc_scene = make_shared<AccelerationSceneReduced>(robot_model, solver);
+        BOOST_CHECK_EQUAL(wbc_scene->configure({cart_constraint}), true);
+        BOOST_CHECK_NO_THROW(wbc_scene->setReference(cart_constraint.name, ref));
+        HierarchicalQP qp;
+        BOOST_CHECK_NO_THROW(qp = wbc_scene->update());
+        n_vars.push_back(qp[0].nq);
+        BOOST_CHECK_NO_THROW(outputs.push_back(wbc_scene->solve(qp)));
+    }
+
+    // The contact Jacobian of link 6 has full rank, so the reduced QP has 6 variables less
+    BOOST_CHECK_EQUAL(n_vars[0] - n_vars[1], 6);
+
+    uint nj = robot_model->noOfJoints();
+    base::VectorXd qdd(nj);
+    for(uint i = 0; i < nj; i++){
+        BOOST_CHECK(fabs(outputs[0][i].acceleration - outputs[1][i].acceleration) < 1e-4);
+        BOOST_CHECK(fabs(outputs[0][i].effort - outputs[1][i].effort) < 1e-4);
+        qdd[i] = outputs[1][i].acceleration;
+    }
+
+    // Rigid contact: J_c * qdd = -Jdot_c * qd
+    const std::string contact = "kuka_lbr_l_link_6";
+    const base::Acceleration& bias = robot_model->spatialAccelerationBias(robot_model->worldFrame(), contact);
+    base::Vector6d residual = robot_model->spaceJacobian(robot_model->worldFrame(), contact)*qdd;
+    residual.segment(0,3) += bias.linear;
+    residual.segment(3,3) += bias.angular;
+    BOOST_CHECK(residual.norm() < 1e-4);
+}
@@ -2,8 +2,10 @@
 #include "robot_models/kdl/RobotModelKDL.hpp"
 #include "core/RobotModelConfig.hpp"
 #include "scenes/VelocityScene.hpp"
+#include "core/ScenePipeline.hpp"
 #include "solvers/hls/HierarchicalLSSolver.hpp"
 #include <tools/URDFTools.hpp>
+#include <thread>
 
 using namespace std;
 using namespace wbc;
@@ -104,10 +106,389 @@ BOOST_AUTO_TEST_CASE(simple_test){
     }
 }
 
+BOOST_AUTO_TEST_CASE(joint_limits_test){
 
+    /**
+     * Check if the WBC velocity scene respects the joint position and velocity limits, if enabled
+     */
+
+    shared_ptr<RobotModelKDL> robot_model = make_shared<RobotModelKDL>();
+    RobotModelConfig config;
+    config.file = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    vector<string> joint_names = URDFTools::jointNamesFromURDF(config.file);
+    config.joint_names = config.actuated_joint_names = joint_names;
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    // Move the first joint close to its upper position limit
+    const base::JointLimits& limits = robot_model->jointLimits();
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->jointNames();
+    for(auto n : robot_model->jointNames()){
+        base::JointState js;
+        js.position = 0.5;
+        joint_state.elements.push_back(js);
+    }
+    joint_state[limits.names[0]].position = limits[0].max.position - 1e-4;
+    joint_state.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+
+    QPSolverPtr solver = std::make_shared<HierarchicalLSSolver>();
+    (std::dynamic_pointer_cast<HierarchicalLSSolver>(solver))->setMaxSolverOutputNorm(1000);
+    ConstraintConfig cart_constraint("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    VelocityScene wbc_scene(robot_model, solver);
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_constraint}), true);
+    BOOST_CHECK_THROW(wbc_scene.setCycleTime(0), std::invalid_argument);
+    wbc_scene.setCycleTime(0.01);
+    wbc_scene.setJointLimitsEnabled(true);
+    BOOST_CHECK(wbc_scene.getJointLimitsEnabled());
+
+    base::samples::RigidBodyStateSE3 ref;
+    ref.twist.linear = base::Vector3d(1,1,1);
+    ref.twist.angular = base::Vector3d(1,1,1);
+    BOOST_CHECK_NO_THROW(wbc_scene.setReference(cart_constraint.name, ref));
+
+    BOOST_CHECK_NO_THROW(wbc_scene.update());
+    HierarchicalQP hqp;
+    wbc_scene.getHierarchicalQP(hqp);
+    BOOST_CHECK(hqp[0].lower_x.size() == robot_model->noOfJoints());
+    BOOST_CHECK(hqp[0].upper_x.size() == robot_model->noOfJoints());
+    BOOST_CHECK_NO_THROW(wbc_scene.solve(hqp));
+    base::commands::Joints solver_output = wbc_scene.getSolverOutput();
+
+    for(uint i = 0; i < limits.size(); i++){
+        double speed = solver_output[limits.names[i]].speed;
+        double pos = joint_state[limits.names[i]].position;
+        BOOST_CHECK(speed <= limits[i].max.speed + 1e-6);
+        BOOST_CHECK(speed >= limits[i].min.speed - 1e-6);
+        BOOST_CHECK(pos + speed * 0.01 <= limits[i].max.position + 1e-6);
+        BOOST_CHECK(pos + speed * 0.01 >= limits[i].min.position - 1e-6);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_evaluation_test){
+
+    /**
+     * Check if parallel evaluation of the constraints yields the same optimization problem as serial evaluation
+     */
+
+    shared_ptr<RobotModelKDL> robot_model = make_shared<RobotModelKDL>();
+    RobotModelConfig config;
+    config.file = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    vector<string> joint_names = URDFTools::jointNamesFromURDF(config.file);
+    config.joint_names = config.actuated_joint_names = joint_names;
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->jointNames();
+    for(auto n : robot_model->jointNames()){
+        base::JointState js;
+        js.position = 0.5;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+
+    QPSolverPtr solver = std::make_shared<HierarchicalLSSolver>();
+    vector<ConstraintConfig> wbc_config;
+    wbc_config.push_back(ConstraintConfig("cart_ctrl_tcp",    0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp",    "kuka_lbr_l_link_0", 1));
+    wbc_config.push_back(ConstraintConfig("cart_ctrl_link_4", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_link_4", "kuka_lbr_l_link_0", 1));
+    wbc_config.push_back(ConstraintConfig("cart_ctrl_link_5", 1, "kuka_lbr_l_link_0", "kuka_lbr_l_link_5", "kuka_lbr_l_link_3", 1));
+    wbc_config.push_back(ConstraintConfig("cart_ctrl_link_6", 1, "kuka_lbr_l_link_0", "kuka_lbr_l_link_6", "kuka_lbr_l_tcp",    1));
+    VelocityScene wbc_scene(robot_model, solver);
+    BOOST_CHECK_EQUAL(wbc_scene.configure(wbc_config), true);
+
+    base::samples::RigidBodyStateSE3 ref;
+    for(auto cfg : wbc_config){
+        for(int i = 0; i < 3; i++){
+            ref.twist.linear[i] = ((double)rand())/RAND_MAX;
+            ref.twist.angular[i] = ((double)rand())/RAND_MAX;
+        }
+        BOOST_CHECK_NO_THROW(wbc_scene.setReference(cfg.name, ref));
+    }
+
+    HierarchicalQP hqp_serial, hqp_parallel;
+    BOOST_CHECK_NO_THROW(wbc_scene.update());
+    wbc_scene.getHierarchicalQP(hqp_serial);
+
+    BOOST_CHECK_THROW(wbc_scene.setNumberOfThreads(0), std::invalid_argument);
+    wbc_scene.setNumberOfThreads(3);
+    BOOST_CHECK(wbc_scene.getNumberOfThreads() == 3);
+    BOOST_CHECK_NO_THROW(wbc_scene.update());
+    wbc_scene.getHierarchicalQP(hqp_parallel);
+
+    for(uint prio = 0; prio < hqp_serial.size(); prio++){
+        BOOST_CHECK(hqp_serial[prio].A.isApprox(hqp_parallel[prio].A));
+        BOOST_CHECK(hqp_serial[prio].lower_y.isApprox(hqp_parallel[prio].lower_y));
+        BOOST_CHECK(hqp_serial[prio].Wy.isApprox(hqp_parallel[prio].Wy));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pipeline_test){
+
+    /**
+     * Check if the pipelined execution of the velocity scene returns the solution of the previous cycle
+     */
+
+    shared_ptr<RobotModelKDL> robot_model = make_shared<RobotModelKDL>();
+    RobotModelConfig config;
+    config.file = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    vector<string> joint_names = URDFTools::jointNamesFromURDF(config.file);
+    config.joint_names = config.actuated_joint_names = joint_names;
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->jointNames();
+    for(auto n : robot_model->jointNames()){
+        base::JointState js;
+        js.position = 0.5;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+
+    QPSolverPtr solver = std::make_shared<HierarchicalLSSolver>();
+    (std::dynamic_pointer_cast<HierarchicalLSSolver>(solver))->setMaxSolverOutputNorm(1000);
+    ConstraintConfig cart_constraint("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    shared_ptr<VelocityScene> wbc_scene = make_shared<VelocityScene>(robot_model, solver);
+    BOOST_CHECK_EQUAL(wbc_scene->configure({cart_constraint}), true);
+
+    ScenePipeline pipeline(wbc_scene);
+    BOOST_CHECK(pipeline.isPipelined());
+    BOOST_CHECK(pipeline.getLatencyCycles() == 1);
+
+    // Use a different reference in each cycle and check that the solution of cycle k is returned in cycle k+1
+    vector<base::VectorXd> refs;
+    vector<base::VectorXd> outputs;
+    for(int k = 0; k < 5; k++){
+        base::samples::RigidBodyStateSE3 ref;
+        ref.twist.linear = base::Vector3d(0.1*k,0,0);
+        ref.twist.angular = base::Vector3d(0,0,0.1*k);
+        BOOST_CHECK_NO_THROW(wbc_scene->setReference(cart_constraint.name, ref));
+        refs.push_back(ref.twist.linear);
+
+        base::commands::Joints output;
+        BOOST_CHECK_NO_THROW(output = pipeline.step());
+        base::VectorXd qd(output.size());
+        for(uint i = 0; i < output.size(); i++)
+            qd[i] = output[i].speed;
+        outputs.push_back(qd);
+    }
+
+    base::MatrixXd jac = robot_model->spaceJacobian(cart_constraint.ref_frame, cart_constraint.tip);
+    // First cycle: Pipeline is empty, so the current QP is solved directly
+    for(int i = 0; i < 3; i++)
+        BOOST_CHECK(fabs((jac*outputs[0])[i] - refs[0][i]) < 1e-5);
+    for(int k = 1; k < 5; k++){
+        base::VectorXd yd = jac*outputs[k];
+        for(int i = 0; i < 3; i++)
+            BOOST_CHECK(fabs(yd[i] - refs[k-1][i]) < 1e-5);
+    }
+
+    // Sequential mode
+    pipeline.setPipelined(false);
+    BOOST_CHECK(pipeline.getLatencyCycles() == 0);
+    base::commands::Joints output = pipeline.step();
+    base::VectorXd qd(output.size());
+    for(uint i = 0; i < output.size(); i++)
+        qd[i] = output[i].speed;
+    base::VectorXd yd = jac*qd;
+    for(int i = 0; i < 3; i++)
+        BOOST_CHECK(fabs(yd[i] - refs[4][i]) < 1e-5);
+}
+
+BOOST_AUTO_TEST_CASE(reference_channel_test){
+
+    /**
+     * Check if references, weights and activations published from another thread are applied to the constraints in update()
+     */
+
+    shared_ptr<RobotModelKDL> robot_model = make_shared<RobotModelKDL>();
+    RobotModelConfig config;
+    config.file = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    vector<string> joint_names = URDFTools::jointNamesFromURDF(config.file);
+    config.joint_names = config.actuated_joint_names = joint_names;
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->jointNames();
+    for(auto n : robot_model->jointNames()){
+        base::JointState js;
+        js.position = 0.5;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+
+    QPSolverPtr solver = std::make_shared<HierarchicalLSSolver>();
+    ConstraintConfig cart_constraint("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    VelocityScene wbc_scene(robot_model, solver);
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_constraint}), true);
+
+    uint id = 0;
+    BOOST_CHECK_NO_THROW(id = wbc_scene.getConstraintId(cart_constraint.name));
+    BOOST_CHECK_THROW(wbc_scene.getConstraintId("unknown"), std::invalid_argument);
+    BOOST_CHECK_THROW(wbc_scene.publishReference(id+1, base::samples::RigidBodyStateSE3()), std::out_of_range);
+    BOOST_CHECK_THROW(wbc_scene.publishReference(id, base::samples::Joints()), std::runtime_error);
+    BOOST_CHECK_THROW(wbc_scene.publishTaskActivation(id, 2.0), std::invalid_argument);
+
+    // Publish references while the control thread is updating the scene
+    const int n_refs = 1000;
+    std::thread publisher([&](){
+        for(int k = 1; k <= n_refs; k++){
+            base::samples::RigidBodyStateSE3 ref;
+            ref.twist.linear = base::Vector3d(0.001*k,0,0);
+            ref.twist.angular = base::Vector3d(0,0,0.001*k);
+            wbc_scene.publishReference(id, ref);
+        }
+        wbc_scene.publishTaskWeights(id, base::VectorXd::Constant(6, 0.5));
+        wbc_scene.publishTaskActivation(id, 0.3);
+    });
+    for(int k = 0; k < 100; k++)
+        BOOST_CHECK_NO_THROW(wbc_scene.update());
+    publisher.join();
+
+    // After the next update, the constraint has to contain the newest published values
+    BOOST_CHECK_NO_THROW(wbc_scene.update());
+    ConstraintPtr constraint = wbc_scene.getConstraint(cart_constraint.name);
+    for(int i = 0; i < 3; i++){
+        BOOST_CHECK(fabs(constraint->y_ref[i] - (i == 0 ? 0.001*n_refs : 0)) < 1e-9);
+        BOOST_CHECK(fabs(constraint->y_ref[i+3] - (i == 2 ? 0.001*n_refs : 0)) < 1e-9);
+    }
+    BOOST_CHECK(constraint->weights == base::VectorXd::Constant(6, 0.5));
+    BOOST_CHECK(constraint->activation == 0.3);
+
+    // Values which have not been published again must not be overwritten
+    BOOST_CHECK_NO_THROW(wbc_scene.setTaskActivation(cart_constraint.name, 1.0));
+    base::samples::RigidBodyStateSE3 ref;
+    ref.twist.linear = base::Vector3d(0.2,0,0);
+    ref.twist.angular = base::Vector3d(0,0,0);
+    BOOST_CHECK_NO_THROW(wbc_scene.publishReference(id, ref));
+    BOOST_CHECK_NO_THROW(wbc_scene.update());
+    BOOST_CHECK(fabs(constraint->y_ref[0] - 0.2) < 1e-9);
+    BOOST_CHECK(constraint->activation == 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(constraint_id_test){
+
+    /**
+     * Check if the constraint ID setters are equivalent to the setters with constraint name and if the IDs match the constraints status
+     */
+
+    shared_ptr<RobotModelKDL> robot_model = make_shared<RobotModelKDL>();
+    RobotModelConfig config;
+    config.file = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    vector<string> joint_names = URDFTools::jointNamesFromURDF(config.file);
+    config.joint_names = config.actuated_joint_names = joint_names;
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
 
+    QPSolverPtr solver = std::make_shared<HierarchicalLSSolver>();
+    ConstraintConfig cart_constraint("cart_pos_ctrl_left", 1, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    ConstraintConfig jnt_constraint("jnt_pos_ctrl", 0, joint_names, vector<double>(joint_names.size(), 1), 1);
+    VelocityScene wbc_scene(robot_model, solver);
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_constraint, jnt_constraint}), true);
 
+    BOOST_CHECK(wbc_scene.hasConstraint(cart_constraint.name));
+    BOOST_CHECK(!wbc_scene.hasConstraint("unknown"));
+    BOOST_CHECK_THROW(wbc_scene.getConstraint("unknown"), std::invalid_argument);
+    BOOST_CHECK_THROW(wbc_scene.getConstraint(2), std::out_of_range);
 
+    uint cart_id = wbc_scene.getConstraintId(cart_constraint.name);
+    uint jnt_id = wbc_scene.getConstraintId(jnt_constraint.name);
+    BOOST_CHECK(wbc_scene.getConstraint(cart_id) == wbc_scene.getConstraint(cart_constraint.name));
+    BOOST_CHECK(wbc_scene.getConstraint(jnt_id) == wbc_scene.getConstraint(jnt_constraint.name));
+    BOOST_CHECK(wbc_scene.getConstraintsStatus().names[cart_id] == cart_constraint.name);
+    BOOST_CHECK(wbc_scene.getConstraintsStatus().names[jnt_id] == jnt_constraint.name);
 
+    base::samples::RigidBodyStateSE3 ref;
+    ref.twist.linear = base::Vector3d(0.1,0.2,0.3);
+    ref.twist.angular = base::Vector3d(0,0,0.1);
+    BOOST_CHECK_NO_THROW(wbc_scene.setReference(cart_id, ref));
+    BOOST_CHECK_THROW(wbc_scene.setReference(jnt_id, ref), std::runtime_error);
+    BOOST_CHECK(wbc_scene.getConstraint(cart_id)->y_ref.segment(0,3) == ref.twist.linear);
 
+    BOOST_CHECK_NO_THROW(wbc_scene.setTaskWeights(cart_id, base::VectorXd::Constant(6, 0.5)));
+    BOOST_CHECK(wbc_scene.getConstraint(cart_constraint.name)->weights == base::VectorXd::Constant(6, 0.5));
+    BOOST_CHECK_NO_THROW(wbc_scene.setTaskActivation(jnt_id, 0.3));
+    BOOST_CHECK(wbc_scene.getConstraint(jnt_constraint.name)->activation == 0.3);
+    BOOST_CHECK_THROW(wbc_scene.setTaskActivation(jnt_id, 2.0), std::invalid_argument);
+}
 
+BOOST_AUTO_TEST_CASE(constraints_status_test){
+
+    /**
+     * Check if the constraints status contains the selected fields only and if it can be computed from a snapshot in another thread
+     */
+
+    shared_ptr<RobotModelKDL> robot_model = make_shared<RobotModelKDL>();
+    RobotModelConfig config;
+    config.file = "../../../models/kuka/urdf/kuka_iiwa.urdf";
+    vector<string> joint_names = URDFTools::jointNamesFromURDF(config.file);
+    config.joint_names = config.actuated_joint_names = joint_names;
+    BOOST_CHECK_EQUAL(robot_model->configure(config), true);
+
+    base::samples::Joints joint_state;
+    joint_state.names = robot_model->jointNames();
+    for(auto n : robot_model->jointNames()){
+        base::JointState js;
+        js.position = 0.5;
+        js.speed = 0.1;
+        joint_state.elements.push_back(js);
+    }
+    joint_state.time = base::Time::now();
+    BOOST_CHECK_NO_THROW(robot_model->update(joint_state));
+
+    QPSolverPtr solver = std::make_shared<HierarchicalLSSolver>();
+    (std::dynamic_pointer_cast<HierarchicalLSSolver>(solver))->setMaxSolverOutputNorm(1000);
+    ConstraintConfig cart_constraint("cart_pos_ctrl_left", 0, "kuka_lbr_l_link_0", "kuka_lbr_l_tcp", "kuka_lbr_l_link_0", 1);
+    VelocityScene wbc_scene(robot_model, solver);
+    BOOST_CHECK_EQUAL(wbc_scene.configure({cart_constraint}), true);
+    BOOST_CHECK(wbc_scene.getConstraintsStatus()[0].config.name == cart_constraint.name);
+
+    base::samples::RigidBodyStateSE3 ref;
+    ref.twist.linear = base::Vector3d(0.1,0.2,0.3);
+    ref.twist.angular = base::Vector3d(0,0,0.1);
+    BOOST_CHECK_NO_THROW(wbc_scene.setReference(cart_constraint.name, ref));
+    HierarchicalQP qp;
+    BOOST_CHECK_NO_THROW(qp = wbc_scene.update());
+    BOOST_CHECK_NO_THROW(wbc_scene.solve(qp));
+
+    // All fields (default): y and y_solution have to be the same as with the full Jacobian
+    ConstraintsStatus status = wbc_scene.updateConstraintsStatus();
+    base::commands::Joints solver_output = wbc_scene.getSolverOutput();
+    base::VectorXd qd(solver_output.size()), qd_robot(solver_output.size());
+    for(uint i = 0; i < solver_output.size(); i++){
+        qd[i] = solver_output[i].speed;
+        qd_robot[i] = 0.1;
+    }
+    base::MatrixXd jac = robot_model->spaceJacobian(cart_constraint.ref_frame, cart_constraint.tip);
+    BOOST_CHECK(status[0].config.name == cart_constraint.name);
+    BOOST_CHECK((status[0].y_solution - jac*qd).norm() < 1e-9);
+    BOOST_CHECK((status[0].y - jac*qd_robot).norm() < 1e-9);
+    BOOST_CHECK((status[0].y_ref.segment(0,3) - ref.twist.linear).norm() < 1e-9);
+    BOOST_CHECK(status[0].weights.size() == 6);
+
+    // Compute the status from a snapshot in another thread
+    ConstraintsStatusSnapshot snapshot;
+    wbc_scene.snapshotConstraintsStatus(snapshot);
+    ConstraintsStatus status_async = wbc_scene.getConstraintsStatus();
+    std::thread worker([&](){snapshot.evaluate(status_async);});
+    worker.join();
+    BOOST_CHECK((status_async[0].y_solution - status[0].y_solution).norm() < 1e-12);
+    BOOST_CHECK((status_async[0].y - status[0].y).norm() < 1e-12);
+
+    // Selected fields only: The other fields keep their previous values
+    wbc_scene.setConstraintsStatusFields(STATUS_Y_SOLUTION);
+    BOOST_CHECK_NO_THROW(wbc_scene.setTaskWeights(cart_constraint.name, base::VectorXd::Constant(6, 0.5)));
+    ref.twist.linear = base::Vector3d(0.3,0.2,0.1);
+    BOOST_CHECK_NO_THROW(wbc_scene.setReference(cart_constraint.name, ref));
+    BOOST_CHECK_NO_THROW(qp = wbc_scene.update());
+    BOOST_CHECK_NO_THROW(wbc_scene.solve(qp));
+    const ConstraintsStatus& status_reduced = wbc_scene.updateConstraintsStatus();
+    BOOST_CHECK(status_reduced[0].weights == status[0].weights);
+    BOOST_CHECK(status_reduced[0].y_ref == status[0].y_ref);
+    BOOST_CHECK(status_reduced[0].y == status[0].y);
+    solver_output = wbc_scene.getSolverOutput();
+    for(uint i = 0; i < solver_output.size(); i++)
+        qd[i] = solver_output[i].speed;
+    BOOST_CHECK((status_reduced[0].y_solution - jac*qd).norm() < 1e-9);
+}
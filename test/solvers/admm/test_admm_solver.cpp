@@ -0,0 +1,218 @@
+#include <boost/test/unit_test.hpp>
+#include <iostream>
+#include <limits>
+#include "core/QuadraticProgram.hpp"
+#include "solvers/admm/ADMMSolver.hpp"
+
+using namespace wbc;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE(solver_admm_with_constraints)
+{
+    const int NO_JOINTS = 6;
+    const int NO_CONSTRAINTS = 6;
+
+    // Solve the problem min(||x||), subject Ax=b --> encode the task as constraint
+    // Standard form of QP is x^T*H*x + x^T*g --> Choose H = I  and g = 0
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_CONSTRAINTS, NO_JOINTS);
+
+    qp.lower_x.resize(0);
+    qp.upper_x.resize(0);
+    qp.H.setIdentity();
+    qp.g.setZero();
+
+    base::Matrix6d A;
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+         0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+         0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+         0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    qp.A = A;
+    base::Vector6d y;
+    y << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+    qp.lower_y = qp.upper_y = y;
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ADMMSolver solver;
+    solver.setAbsTol(1e-8);
+    solver.setRelTol(1e-8);
+    BOOST_CHECK(solver.getAbsTol() == 1e-8);
+
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+
+    base::VectorXd x_expected = A.partialPivLu().solve(y);
+    for(uint i = 0; i < NO_JOINTS; i++)
+        BOOST_CHECK(fabs(solver_output(i) - x_expected(i)) < 1e-4);
+
+    // Warm start: Solving the same problem again should converge immediately
+    uint n_iter = solver.getNoOfIterations();
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoOfIterations() <= n_iter);
+    for(uint i = 0; i < NO_JOINTS; i++)
+        BOOST_CHECK(fabs(solver_output(i) - x_expected(i)) < 1e-4);
+
+    // The KKT matrix is only refactorized if H, A or rho change
+    solver.setAdaptiveRho(false);
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoOfFactorizations() == 0);
+    hqp[0].H(0,0) = 2;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getNoOfFactorizations() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(solver_admm_bounds_and_pattern_change)
+{
+    const int NO_JOINTS = 4;
+
+    // min 0.5*||x - x_ref||^2 s.t. -0.5 <= x <= 0.5 and x0 + x1 <= 0.2. Solution is the projection of x_ref onto the feasible set
+    wbc::QuadraticProgram qp;
+    qp.resize(1, NO_JOINTS);
+    base::VectorXd x_ref(NO_JOINTS);
+    x_ref << 1.0, -1.0, 0.3, 0.0;
+    qp.H.setIdentity();
+    qp.g = -x_ref;
+    qp.A << 1, 1, 0, 0;
+    qp.lower_y[0] = -std::numeric_limits<double>::infinity();
+    qp.upper_y[0] = 0.2;
+    qp.lower_x.setConstant(-0.5);
+    qp.upper_x.setConstant(0.5);
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ADMMSolver solver;
+    solver.setAbsTol(1e-7);
+    solver.setRelTol(1e-7);
+    base::VectorXd solver_output;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+
+    base::VectorXd x_expected(NO_JOINTS);
+    x_expected << 0.5, -0.5, 0.3, 0.0;
+    for(uint i = 0; i < NO_JOINTS; i++)
+        BOOST_CHECK(fabs(solver_output(i) - x_expected(i)) < 1e-4);
+
+    // Introduce new non-zeros in A and H, which are not part of the previous sparsity pattern
+    qp.A << 1, 1, 1, 1;
+    qp.upper_y[0] = 0.0;
+    qp.H(3,2) = qp.H(2,3) = 0.5;
+    hqp[0] = qp;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+
+    // Feasibility
+    base::VectorXd Ax = qp.A * solver_output;
+    BOOST_CHECK(Ax(0) <= 1e-4);
+    for(uint i = 0; i < NO_JOINTS; i++){
+        BOOST_CHECK(solver_output(i) >= -0.5 - 1e-4);
+        BOOST_CHECK(solver_output(i) <= 0.5 + 1e-4);
+    }
+    // At the solution, x0 and x1 are at their bounds and the inequality is active. Stationarity on the free variables x2,x3
+    // (H*x - x_ref + lambda*A^T = 0) yields x2 = -x3 = 0.3 with multiplier lambda = 0.15
+    x_expected << 0.5, -0.5, 0.3, -0.3;
+    for(uint i = 0; i < NO_JOINTS; i++)
+        BOOST_CHECK(fabs(solver_output(i) - x_expected(i)) < 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE(solver_admm_time_budget)
+{
+    const int NO_JOINTS = 4;
+
+    wbc::QuadraticProgram qp;
+    qp.resize(1, NO_JOINTS);
+    base::VectorXd x_ref(NO_JOINTS);
+    x_ref << 1.0, -1.0, 0.3, 0.0;
+    qp.H.setIdentity();
+    qp.g = -x_ref;
+    qp.A << 1, 1, 1, 1;
+    qp.lower_y[0] = -std::numeric_limits<double>::infinity();
+    qp.upper_y[0] = 0.0;
+    qp.lower_x.setConstant(-0.5);
+    qp.upper_x.setConstant(0.5);
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    // Without time budget, solver failures throw
+    ADMMSolver solver;
+    solver.setMaxIter(1);
+    base::VectorXd solver_output;
+    BOOST_CHECK_THROW(solver.solve(hqp, solver_output), std::runtime_error);
+
+    // With time budget, solver failures return the fallback solution, i.e., the solution of the last call projected onto the bounds (zero here)
+    solver.setTimeBudget(base::Time::fromSeconds(1));
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getStatus() == qp_failed);
+    BOOST_CHECK(solver_output.size() == NO_JOINTS);
+    BOOST_CHECK(solver_output.norm() == 0);
+
+    solver.setMaxIter(4000);
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getStatus() == qp_solved);
+    BOOST_CHECK(solver.getNoOfCalls() == 2);
+    BOOST_CHECK(solver.getNoOfDeadlineMisses() == 0);
+
+    // Exceed the time budget: The current iterate, projected onto the bounds, is returned
+    solver.setWarmStart(false);
+    solver.setAbsTol(1e-12);
+    solver.setRelTol(1e-12);
+    solver.setAdaptiveRho(false);
+    solver.setTimeBudget(base::Time::fromMicroseconds(1));
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getStatus() == qp_deadline_exceeded);
+    BOOST_CHECK(solver.getNoOfDeadlineMisses() == 1);
+    for(uint i = 0; i < NO_JOINTS; i++){
+        BOOST_CHECK(solver_output(i) >= -0.5);
+        BOOST_CHECK(solver_output(i) <= 0.5);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(solver_admm_stats)
+{
+    const int NO_JOINTS = 4;
+
+    wbc::QuadraticProgram qp;
+    qp.resize(1, NO_JOINTS);
+    base::VectorXd x_ref(NO_JOINTS);
+    x_ref << 1.0, -1.0, 0.3, 0.0;
+    qp.H.setIdentity();
+    qp.g = -x_ref;
+    qp.A << 1, 1, 1, 1;
+    qp.lower_y[0] = -std::numeric_limits<double>::infinity();
+    qp.upper_y[0] = 0.0;
+    qp.lower_x.setConstant(-0.5);
+    qp.upper_x.setConstant(0.5);
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    ADMMSolver solver;
+    solver.setStatsHistorySize(3);
+    base::VectorXd solver_output;
+    std::vector<SolverStats> history;
+    BOOST_CHECK(solver.getStatsHistory(history, 10) == 0);
+
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    SolverStats stats = solver.getStats();
+    BOOST_CHECK(stats.status == qp_solved);
+    BOOST_CHECK(!stats.warm_start);
+    BOOST_CHECK(stats.n_iter == solver.getNoOfIterations());
+    BOOST_CHECK(stats.primal_residual < 1e-3);
+    BOOST_CHECK(stats.dual_residual < 1e-3);
+    BOOST_CHECK(stats.factorization_time > 0);
+    BOOST_CHECK(stats.total_time >= stats.setup_time + stats.factorization_time + stats.iteration_time - 1e-9);
+
+    // Only the last 3 calls are kept, oldest first
+    for(int i = 0; i < 4; i++)
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getStats().warm_start);
+    BOOST_CHECK(solver.getStatsHistory(history, 10) == 3);
+    BOOST_CHECK(history[0].time < history[1].time || history[0].time == history[1].time);
+    BOOST_CHECK(history[2].n_iter == solver.getStats().n_iter);
+    BOOST_CHECK(solver.getStatsHistory(history, 2) == 2);
+    BOOST_CHECK(history[1].time == solver.getStats().time);
+}
@@ -1,6 +1,7 @@
 #include <boost/test/unit_test.hpp>
 #include <iostream>
 #include <sys/time.h>
+#include <limits>
 #include "core/QuadraticProgram.hpp"
 #include "solvers/eiquadprog/EiquadprogSolver.hpp"
 
@@ -144,3 +145,107 @@ BOOST_AUTO_TEST_CASE(solver_qp_oases_with_constraints)
 
     //cout<<"\n............................."<<endl;
 }
+
+BOOST_AUTO_TEST_CASE(solver_eiquadprog_warm_start)
+{
+    /**
+     * Solve a sequence of slowly changing QPs with active bounds, with and without warm start. Both have to give the same solution.
+     */
+
+    const int NO_JOINTS = 6;
+    const int NO_CONSTRAINTS = 3;
+
+    base::MatrixXd A(NO_CONSTRAINTS, NO_JOINTS);
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963;
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_CONSTRAINTS, NO_JOINTS);
+    qp.H.setIdentity();
+    qp.g.setZero();
+    qp.A = A;
+    qp.lower_x.setConstant(-0.4);
+    qp.upper_x.setConstant(0.4);
+    qp.upper_x(1) = std::numeric_limits<double>::infinity();
+
+    EiquadprogSolver solver, solver_warm;
+    BOOST_CHECK(solver_warm.getWarmStart() == false);
+    solver_warm.setWarmStart(true);
+    BOOST_CHECK(solver_warm.getWarmStart() == true);
+
+    int n_warm = 0;
+    for(int k = 0; k < 20; k++){
+        base::Vector3d y(0.5 + 0.001*k, 0.1, 0.1);
+        qp.lower_y = y;
+        qp.upper_y = y;
+        wbc::HierarchicalQP hqp;
+        hqp << qp;
+
+        base::VectorXd output, output_warm;
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, output));
+        BOOST_CHECK_NO_THROW(solver_warm.solve(hqp, output_warm));
+        if(solver_warm.isWarmStartSuccessful())
+            n_warm++;
+
+        BOOST_CHECK((output - output_warm).norm() < 1e-6);
+        BOOST_CHECK((A*output_warm - y).norm() < 1e-6);
+        for(int i = 0; i < NO_JOINTS; i++){
+            BOOST_CHECK(output_warm(i) >= qp.lower_x(i) - 1e-6);
+            BOOST_CHECK(output_warm(i) <= qp.upper_x(i) + 1e-6);
+        }
+    }
+
+    // The active set changes only rarely
+    BOOST_CHECK(n_warm > 10);
+}
+
+BOOST_AUTO_TEST_CASE(solver_eiquadprog_batch)
+{
+    /**
+     * Solve a batch of QPs with different references in parallel. The solutions have to be the same as the ones of single solver calls.
+     */
+
+    const int NO_JOINTS = 6;
+    const int NO_CONSTRAINTS = 3;
+    const int NO_PROBLEMS = 10;
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_CONSTRAINTS, NO_JOINTS);
+    qp.H.setIdentity();
+    qp.g.setZero();
+    qp.A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+            0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+            0.249, 0.632, 0.711,  0.13, 0.426, 0.963;
+    qp.lower_x.setConstant(-0.4);
+    qp.upper_x.setConstant(0.4);
+
+    std::vector<wbc::HierarchicalQP> hqps(NO_PROBLEMS);
+    for(int i = 0; i < NO_PROBLEMS; i++){
+        qp.lower_y = qp.upper_y = base::Vector3d(0.3 + 0.015*i, 0.1, 0.1);
+        hqps[i] << qp;
+    }
+
+    EiquadprogSolver solver, solver_batch;
+    solver_batch.setWarmStart(true);
+    solver_batch.setNumberOfThreads(3);
+    BOOST_CHECK(solver_batch.getNumberOfThreads() == 3);
+
+    std::vector<base::VectorXd> outputs;
+    for(int k = 0; k < 2; k++){
+        BOOST_CHECK_NO_THROW(solver_batch.solveBatch(hqps, outputs));
+        BOOST_CHECK(outputs.size() == NO_PROBLEMS);
+        for(int i = 0; i < NO_PROBLEMS; i++){
+            base::VectorXd output;
+            BOOST_CHECK_NO_THROW(solver.solve(hqps[i], output));
+            BOOST_CHECK((output - outputs[i]).norm() < 1e-6);
+        }
+    }
+    // Each problem is warm started from its own previous solution
+    for(int i = 0; i < NO_PROBLEMS; i++)
+        BOOST_CHECK(solver_batch.getBatchSolver(i)->getStats().warm_start);
+
+    // All problems must have the same shape
+    hqps[1][0].resize(NO_CONSTRAINTS+1, NO_JOINTS);
+    BOOST_CHECK_THROW(solver_batch.solveBatch(hqps, outputs), std::invalid_argument);
+}
@@ -1,6 +1,7 @@
 #include <boost/test/unit_test.hpp>
 #include "solvers/hls/HierarchicalLSSolver.hpp"
 #include "core/QuadraticProgram.hpp"
+#include "tools/SVD.hpp"
 #include <iostream>
 #include <sys/time.h>
 
@@ -71,3 +72,186 @@ BOOST_AUTO_TEST_CASE(solver_hls)
 
     //cout<<"\n............................."<<endl;
 }
+
+BOOST_AUTO_TEST_CASE(solver_hls_bounds)
+{
+    const uint NO_JOINTS = 6;
+    const uint NO_CONSTRAINTS = 3;
+
+    HierarchicalLSSolver solver;
+    vector<int> ny_per_prio(1,NO_CONSTRAINTS);
+    BOOST_CHECK_EQUAL(solver.configure(ny_per_prio, NO_JOINTS), true);
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_CONSTRAINTS, NO_JOINTS);
+    base::Vector3d y;
+    y << 0.833, 0.096, 0.078;
+    qp.lower_y = y;
+    qp.upper_y = y;
+
+    base::MatrixXd A(NO_CONSTRAINTS, NO_JOINTS);
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963;
+    qp.A = A;
+
+    // Unconstrained solution
+    wbc::HierarchicalQP hqp;
+    hqp.Wq.setOnes(NO_JOINTS);
+    qp.lower_x.resize(0);
+    qp.upper_x.resize(0);
+    hqp << qp;
+    base::VectorXd solver_output;
+    solver.solve(hqp, solver_output);
+
+    // Restrict the joint with the largest absolute value to half of its unconstrained value
+    uint idx;
+    solver_output.cwiseAbs().maxCoeff(&idx);
+    qp.lower_x.setConstant(NO_JOINTS, -1000);
+    qp.upper_x.setConstant(NO_JOINTS, 1000);
+    if(solver_output(idx) > 0)
+        qp.upper_x(idx) = solver_output(idx) / 2;
+    else
+        qp.lower_x(idx) = solver_output(idx) / 2;
+    hqp[0] = qp;
+    solver.solve(hqp, solver_output);
+
+    for(uint i = 0; i < NO_JOINTS; i++){
+        BOOST_CHECK(solver_output(i) >= qp.lower_x(i) - 1e-9);
+        BOOST_CHECK(solver_output(i) <= qp.upper_x(i) + 1e-9);
+    }
+    Eigen::VectorXd test = A*solver_output;
+    for(uint j = 0; j < NO_CONSTRAINTS; j++)
+        BOOST_CHECK(fabs(test(j) - y(j)) < 1e-9);
+
+    // Invalid bounds size
+    qp.lower_x.resize(NO_JOINTS-1);
+    hqp[0] = qp;
+    BOOST_CHECK_THROW(solver.solve(hqp, solver_output), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(solver_hls_cod)
+{
+    /**
+     * Check if the null space basis / QR based decomposition yields the same result as the SVD based decomposition
+     */
+
+    const uint NO_JOINTS = 20;
+    vector<int> ny_per_prio = {6, 6, 12};
+
+    srand(12345);
+    wbc::HierarchicalQP hqp;
+    hqp.Wq = base::VectorXd::Random(NO_JOINTS).cwiseAbs();
+    for(uint prio = 0; prio < ny_per_prio.size(); prio++){
+        wbc::QuadraticProgram qp;
+        qp.resize(ny_per_prio[prio], NO_JOINTS);
+        qp.A = base::MatrixXd::Random(ny_per_prio[prio], NO_JOINTS);
+        qp.lower_y = qp.upper_y = base::VectorXd::Random(ny_per_prio[prio]);
+        qp.Wy.setOnes(ny_per_prio[prio]);
+        qp.lower_x.resize(0);
+        qp.upper_x.resize(0);
+        hqp << qp;
+    }
+
+    // Singular second priority: Duplicate row
+    hqp[1].A.row(1) = hqp[1].A.row(0);
+    hqp[1].lower_y(1) = hqp[1].upper_y(1) = hqp[1].lower_y(0);
+
+    HierarchicalLSSolver solver_svd, solver_cod;
+    BOOST_CHECK_EQUAL(solver_svd.configure(ny_per_prio, NO_JOINTS), true);
+    BOOST_CHECK_EQUAL(solver_cod.configure(ny_per_prio, NO_JOINTS), true);
+    BOOST_CHECK(solver_svd.getDecomposition() == hls_svd);
+    solver_cod.setDecomposition(hls_cod);
+    BOOST_CHECK(solver_cod.getDecomposition() == hls_cod);
+
+    base::VectorXd output_svd, output_cod;
+    solver_svd.solve(hqp, output_svd);
+    solver_cod.solve(hqp, output_cod);
+    for(uint i = 0; i < NO_JOINTS; i++)
+        BOOST_CHECK(fabs(output_svd(i) - output_cod(i)) < 1e-6);
+
+    // Highest priority is well-conditioned and has to be fulfilled exactly
+    Eigen::VectorXd test = hqp[0].A*output_cod;
+    for(int j = 0; j < ny_per_prio[0]; j++)
+        BOOST_CHECK(fabs(test(j) - hqp[0].lower_y(j)) < 1e-9);
+
+    // Same with bounds
+    hqp[0].lower_x.setConstant(NO_JOINTS, -1000);
+    hqp[0].upper_x.setConstant(NO_JOINTS, 1000);
+    hqp[0].upper_x(0) = output_svd(0) - 0.1;
+    solver_svd.solve(hqp, output_svd);
+    solver_cod.solve(hqp, output_cod);
+    for(uint i = 0; i < NO_JOINTS; i++)
+        BOOST_CHECK(fabs(output_svd(i) - output_cod(i)) < 1e-6);
+    BOOST_CHECK(output_cod(0) <= hqp[0].upper_x(0) + 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(svd_jacobi)
+{
+    /**
+     * Compare the Jacobi based SVD with the default implementation for wide, tall and rank deficient matrices
+     */
+
+    srand(12345);
+    vector<pair<int,int>> sizes = {{6,7}, {6,40}, {12,40}, {40,12}, {30,30}};
+    for(auto size : sizes){
+        const int rows = size.first, cols = size.second;
+        base::MatrixXd A = base::MatrixXd::Random(rows, cols);
+        A.row(1) = A.row(0); // rank deficient
+
+        base::MatrixXd U(rows, cols), V(cols, cols), U_ref(rows, cols), V_ref(cols, cols);
+        base::VectorXd S(cols), S_ref(cols), tmp(cols);
+        BOOST_CHECK(svd_eigen_decomposition(A, U_ref, S_ref, V_ref, tmp) == 0);
+        BOOST_CHECK(svd_jacobi_decomposition(A, U, S, V, tmp) == 0);
+
+        BOOST_CHECK((S - S_ref).norm() < 1e-9);
+        BOOST_CHECK((V.transpose()*V - base::MatrixXd::Identity(cols, cols)).norm() < 1e-9);
+        BOOST_CHECK((U*S.asDiagonal()*V.transpose() - A).norm() < 1e-9);
+        for(int i = 1; i < cols; i++)
+            BOOST_CHECK(S(i) <= S(i-1));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(solver_hls_batch)
+{
+    const uint NO_JOINTS = 6;
+    const uint NO_PROBLEMS = 10;
+
+    base::MatrixXd A(3, NO_JOINTS);
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963;
+
+    // Two priorities, same shape for all problems, different references
+    std::vector<wbc::HierarchicalQP> hqps(NO_PROBLEMS);
+    for(uint i = 0; i < NO_PROBLEMS; i++){
+        wbc::QuadraticProgram qp0, qp1;
+        qp0.resize(2, NO_JOINTS);
+        qp0.A = A.topRows(2);
+        qp0.lower_y = qp0.upper_y = base::Vector2d(0.1*i, 0.2);
+        qp0.Wy.setOnes(2);
+        qp0.lower_x.resize(0);
+        qp0.upper_x.resize(0);
+        qp1.resize(1, NO_JOINTS);
+        qp1.A = A.bottomRows(1);
+        qp1.lower_y = qp1.upper_y = base::VectorXd::Constant(1, -0.1*i);
+        qp1.Wy.setOnes(1);
+        hqps[i].Wq.setOnes(NO_JOINTS);
+        hqps[i] << qp0;
+        hqps[i] << qp1;
+    }
+
+    HierarchicalLSSolver solver, solver_batch;
+    solver_batch.setNumberOfThreads(4);
+
+    std::vector<base::VectorXd> outputs;
+    BOOST_CHECK_NO_THROW(solver_batch.solveBatch(hqps, outputs));
+    BOOST_CHECK(outputs.size() == NO_PROBLEMS);
+    for(uint i = 0; i < NO_PROBLEMS; i++){
+        base::VectorXd output;
+        BOOST_CHECK_NO_THROW(solver.solve(hqps[i], output));
+        BOOST_CHECK((output - outputs[i]).norm() < 1e-9);
+        BOOST_CHECK(solver_batch.getBatchSolver(i)->getNoOfCalls() == 1);
+    }
+    BOOST_CHECK_THROW(solver_batch.getBatchSolver(NO_PROBLEMS), std::out_of_range);
+}
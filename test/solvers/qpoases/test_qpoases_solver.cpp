@@ -151,3 +151,122 @@ BOOST_AUTO_TEST_CASE(solver_qp_oases_with_constraints)
 
     cout<<"\n............................."<<endl;
 }
+
+BOOST_AUTO_TEST_CASE(solver_qp_oases_constant_matrices)
+{
+    const int NO_JOINTS = 6;
+    const int NO_CONSTRAINTS = 6;
+
+    // Solve min(||x - x_ref||) subject Ax=b for different x_ref. H and A are constant, only the gradient changes, so that
+    // the solver should reuse the matrix factorization after the first call
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_CONSTRAINTS, NO_JOINTS);
+
+    qp.lower_x.resize(0);
+    qp.upper_x.resize(0);
+    qp.H.setIdentity();
+    base::Matrix6d A;
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963,
+         0.682, 0.123, 0.998, 0.716, 0.961, 0.901,
+         0.891, 0.019, 0.716, 0.534, 0.725, 0.633,
+         0.315, 0.551, 0.462, 0.221, 0.638, 0.244;
+    qp.A = A;
+    base::Vector6d y;
+    y << 0.833, 0.096, 0.078, 0.971, 0.883, 0.366;
+    qp.lower_y = y;
+    qp.upper_y = y;
+
+    QPOASESSolver solver;
+    solver.setCheckConstantMatrices(true);
+    BOOST_CHECK(solver.getCheckConstantMatrices() == true);
+
+    base::VectorXd solver_output;
+    for(int i = 0; i < 3; i++){
+        qp.g.setConstant(-0.1*i);
+        wbc::HierarchicalQP hqp;
+        hqp << qp;
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK(solver.getMatricesUpdated() == (i == 0));
+
+        Eigen::VectorXd test = A*solver_output;
+        for(uint j = 0; j < NO_CONSTRAINTS; j++)
+            BOOST_CHECK(fabs(test(j) - y(j)) < 1e-9);
+    }
+
+    // Changing A has to trigger a matrix update
+    qp.A.row(0) *= 2;
+    qp.lower_y(0) = qp.upper_y(0) = 2*y(0);
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+    BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+    BOOST_CHECK(solver.getMatricesUpdated() == true);
+    Eigen::VectorXd test = A*solver_output;
+    for(uint j = 0; j < NO_CONSTRAINTS; j++)
+        BOOST_CHECK(fabs(test(j) - y(j)) < 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(solver_qp_oases_box_constraints)
+{
+    const int NO_JOINTS = 6;
+
+    // QP without constraint matrix: min(||x - x_ref||) subject to lb <= x <= ub. Solution is x_ref clipped to the bounds
+    wbc::QuadraticProgram qp;
+    qp.resize(0, NO_JOINTS);
+    qp.H.setIdentity();
+    base::VectorXd x_ref(NO_JOINTS);
+    x_ref << 0.1, -0.2, 0.7, -0.9, 0.0, 0.4;
+    qp.g = -x_ref;
+    qp.lower_x.setConstant(-0.5);
+    qp.upper_x.setConstant(0.5);
+
+    QPOASESSolver solver;
+    solver.setCheckConstantMatrices(true);
+    base::VectorXd solver_output;
+    for(int i = 0; i < 2; i++){
+        wbc::HierarchicalQP hqp;
+        hqp << qp;
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        for(uint j = 0; j < NO_JOINTS; j++)
+            BOOST_CHECK(fabs(solver_output(j) - std::min(std::max(x_ref(j), -0.5), 0.5)) < 1e-9);
+        x_ref *= -1;
+        qp.g = -x_ref;
+    }
+    BOOST_CHECK(solver.getMatricesUpdated() == false);
+}
+
+BOOST_AUTO_TEST_CASE(solver_qp_oases_recover_from_failure)
+{
+    // With a time budget, a failed solve does not throw. The next feasible QP has to be solved again, i.e., the solver must not hotstart from the failed working set
+
+    wbc::QuadraticProgram qp;
+    qp.resize(1, 2);
+    qp.H.setIdentity();
+    qp.g.setZero();
+    qp.A << 1, 1;
+    qp.lower_x.setConstant(-1);
+    qp.upper_x.setConstant(1);
+
+    wbc::HierarchicalQP hqp;
+    hqp << qp;
+
+    QPOASESSolver solver;
+    solver.setTimeBudget(base::Time::fromSeconds(1));
+    base::VectorXd solver_output;
+
+    // x1 + x2 = 0.5 is feasible, x1 + x2 = 5 is not (|x| <= 1)
+    double y[4] = {0.5, 5, 0.5, -0.5};
+    QPSolverStatus expected_status[4] = {qp_solved, qp_failed, qp_solved, qp_solved};
+    for(int i = 0; i < 4; i++){
+        hqp[0].lower_y.setConstant(y[i]);
+        hqp[0].upper_y.setConstant(y[i]);
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK_EQUAL(solver.getStatus(), expected_status[i]);
+        if(expected_status[i] == qp_solved){
+            BOOST_CHECK(fabs(solver_output(0) - y[i]/2) < 1e-6);
+            BOOST_CHECK(fabs(solver_output(1) - y[i]/2) < 1e-6);
+        }
+    }
+}
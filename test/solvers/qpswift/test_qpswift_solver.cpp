@@ -145,3 +145,48 @@ BOOST_AUTO_TEST_CASE(solver_qp_swift_with_constraints)
 
     //cout<<"\n............................."<<endl;
 }
+
+BOOST_AUTO_TEST_CASE(solver_qp_swift_partition_change)
+{
+    /**
+     * Solve the same solver instance repeatedly, while the partition of the constraints into equalities/inequalities changes
+     */
+
+    const int NO_JOINTS = 6;
+    const int NO_CONSTRAINTS = 3;
+
+    base::MatrixXd A(NO_CONSTRAINTS, NO_JOINTS);
+    A << 0.642, 0.706, 0.565,  0.48,  0.59, 0.917,
+         0.553, 0.087,  0.43,  0.71, 0.148,  0.87,
+         0.249, 0.632, 0.711,  0.13, 0.426, 0.963;
+    base::Vector3d y(0.833, 0.096, 0.078);
+
+    wbc::QuadraticProgram qp;
+    qp.resize(NO_CONSTRAINTS, NO_JOINTS);
+    qp.H.setIdentity();
+    qp.g.setZero();
+    qp.A = A;
+    qp.lower_x.setConstant(-1000);
+    qp.upper_x.setConstant(1000);
+
+    QPSwiftSolver solver;
+    base::VectorXd solver_output;
+    for(int k = 0; k < 4; k++){
+        qp.lower_y = qp.upper_y = y;
+        // Every second cycle, turn the first constraint into an inequality
+        if(k % 2 == 1){
+            qp.lower_y(0) = y(0) - 0.1;
+            qp.upper_y(0) = y(0) + 0.1;
+        }
+        wbc::HierarchicalQP hqp;
+        hqp << qp;
+        BOOST_CHECK_NO_THROW(solver.solve(hqp, solver_output));
+        BOOST_CHECK(solver_output.size() == NO_JOINTS);
+
+        Eigen::VectorXd test = A*solver_output;
+        for(uint j = 0; j < NO_CONSTRAINTS; j++){
+            BOOST_CHECK(test(j) >= qp.lower_y(j) - 1e-5);
+            BOOST_CHECK(test(j) <= qp.upper_y(j) + 1e-5);
+        }
+    }
+}
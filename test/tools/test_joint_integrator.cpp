@@ -0,0 +1,165 @@
+#include <boost/test/unit_test.hpp>
+#include <tools/JointIntegrator.hpp>
+#include <map>
+
+using namespace std;
+using namespace wbc;
+
+/** Scalar reference implementation of the integration methods, one joint at a time*/
+struct ReferenceIntegrator{
+    map<string,double> q, qd;
+
+    void init(const base::samples::Joints& joint_state, const base::commands::Joints& cmd){
+        for(uint i = 0; i < cmd.size(); i++){
+            const base::JointState& js = joint_state[cmd.names[i]];
+            q[cmd.names[i]] = js.position;
+            qd[cmd.names[i]] = cmd[i].hasSpeed() ? cmd[i].speed : js.speed;
+        }
+    }
+    void integrate(const base::commands::Joints& cmd, double h, IntegrationMethod method){
+        for(uint i = 0; i < cmd.size(); i++){
+            const string& n = cmd.names[i];
+            double qd_new = cmd[i].hasSpeed() ? cmd[i].speed : qd[n] + cmd[i].acceleration*h;
+            if(method == TRAPEZOIDAL)
+                q[n] += (qd_new + qd[n])*h/2;
+            else
+                q[n] += qd_new*h;
+            qd[n] = qd_new;
+        }
+    }
+    void check(const base::commands::Joints& cmd){
+        for(uint i = 0; i < cmd.size(); i++){
+            BOOST_CHECK_CLOSE(cmd[i].position, q[cmd.names[i]], 1e-9);
+            if(!cmd[i].hasAcceleration())
+                continue;
+            BOOST_CHECK_CLOSE(cmd[i].speed, qd[cmd.names[i]], 1e-9);
+        }
+    }
+};
+
+/** Command with the given control modes (true: velocity, false: acceleration) and random values*/
+base::commands::Joints randomCommand(const vector<string>& names, const vector<bool>& speed_mode){
+    base::commands::Joints cmd;
+    cmd.resize(names.size());
+    cmd.names = names;
+    for(uint i = 0; i < names.size(); i++){
+        if(speed_mode[i])
+            cmd[i].speed = (double)rand()/RAND_MAX - 0.5;
+        else
+            cmd[i].acceleration = (double)rand()/RAND_MAX - 0.5;
+    }
+    return cmd;
+}
+
+/** Joint state with random position and velocity, in reversed order of the given names*/
+base::samples::Joints randomJointState(const vector<string>& names){
+    base::samples::Joints joint_state;
+    joint_state.resize(names.size());
+    for(uint i = 0; i < names.size(); i++){
+        joint_state.names[i] = names[names.size()-1-i];
+        joint_state[i].position = (double)rand()/RAND_MAX;
+        joint_state[i].speed = (double)rand()/RAND_MAX - 0.5;
+    }
+    return joint_state;
+}
+
+BOOST_AUTO_TEST_CASE(mixed_modes){
+    // Velocity and acceleration controlled joints interleaved, joint state in a different order than the command
+    srand(0);
+    const double h = 0.01;
+    vector<string> names = {"j0", "j1", "j2", "j3", "j4"};
+    vector<bool> speed_mode = {true, false, true, false, false};
+    base::samples::Joints joint_state = randomJointState(names);
+
+    for(IntegrationMethod method : {RECTANGULAR, TRAPEZOIDAL}){
+        JointIntegrator integrator;
+        ReferenceIntegrator ref;
+        for(int i = 0; i < 50; i++){
+            base::commands::Joints cmd = randomCommand(names, speed_mode);
+            if(i == 0)
+                ref.init(joint_state, cmd);
+            else
+                ref.integrate(cmd, h, method);
+            integrator.integrate(joint_state, cmd, h, method);
+            ref.check(cmd);
+        }
+    }
+
+}
+
+BOOST_AUTO_TEST_CASE(mode_switch){
+    // The state of each joint is kept when the control modes change, e.g., joint j1 switches from acceleration to velocity control
+    srand(1);
+    const double h = 0.01;
+    vector<string> names = {"j0", "j1", "j2", "j3"};
+    vector<bool> speed_mode = {true, false, false, true};
+    base::samples::Joints joint_state = randomJointState(names);
+
+    for(IntegrationMethod method : {RECTANGULAR, TRAPEZOIDAL}){
+        JointIntegrator integrator;
+        ReferenceIntegrator ref;
+        vector<bool> modes = speed_mode;
+        for(int i = 0; i < 60; i++){
+            if(i % 20 == 19)
+                modes = {!modes[0], !modes[1], modes[2], !modes[3]};
+            base::commands::Joints cmd = randomCommand(names, modes);
+            if(i == 0)
+                ref.init(joint_state, cmd);
+            else
+                ref.integrate(cmd, h, method);
+            integrator.integrate(joint_state, cmd, h, method);
+            ref.check(cmd);
+        }
+    }
+
+    // Position or invalid commands are rejected
+    JointIntegrator integrator;
+    base::commands::Joints cmd = randomCommand(names, speed_mode);
+    cmd[0].position = 0;
+    BOOST_CHECK_THROW(integrator.integrate(joint_state, cmd, h), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(reinit){
+    // After reinit(), the integrator starts again from the joint state, which may also contain a different set of joints
+    srand(2);
+    const double h = 0.01;
+    vector<string> names = {"j0", "j1", "j2"};
+    vector<bool> speed_mode = {false, true, false};
+    base::samples::Joints joint_state = randomJointState(names);
+
+    JointIntegrator integrator;
+    ReferenceIntegrator ref;
+    for(int i = 0; i < 10; i++){
+        base::commands::Joints cmd = randomCommand(names, speed_mode);
+        if(i == 0)
+            ref.init(joint_state, cmd);
+        else
+            ref.integrate(cmd, h, TRAPEZOIDAL);
+        integrator.integrate(joint_state, cmd, h, TRAPEZOIDAL);
+        ref.check(cmd);
+    }
+
+    // Without reinit(), a command with a different number of joints is rejected
+    vector<string> new_names = {"j0", "j1", "j2", "j3"};
+    vector<bool> new_speed_mode = {true, false, false, true};
+    base::samples::Joints new_joint_state = randomJointState(new_names);
+    base::commands::Joints cmd = randomCommand(new_names, new_speed_mode);
+    BOOST_CHECK_THROW(integrator.integrate(new_joint_state, cmd, h, TRAPEZOIDAL), std::runtime_error);
+
+    integrator.reinit();
+    ref = ReferenceIntegrator();
+    for(int i = 0; i < 10; i++){
+        cmd = randomCommand(new_names, new_speed_mode);
+        if(i == 0)
+            ref.init(new_joint_state, cmd);
+        else
+            ref.integrate(cmd, h, TRAPEZOIDAL);
+        integrator.integrate(new_joint_state, cmd, h, TRAPEZOIDAL);
+        ref.check(cmd);
+    }
+
+    // The joint state has to contain all joints of the command
+    integrator.reinit();
+    cmd = randomCommand(new_names, new_speed_mode);
+    BOOST_CHECK_THROW(integrator.integrate(joint_state, cmd, h, TRAPEZOIDAL), base::samples::Joints::InvalidName);
+}